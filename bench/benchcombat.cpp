@@ -0,0 +1,194 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "otpch.h"
+
+#include "benchworld.h"
+
+#include "combat.h"
+#include "game.h"
+#include "monster.h"
+#include "monsters.h"
+
+#include <benchmark/benchmark.h>
+
+extern Game g_game;
+
+namespace {
+
+static constexpr size_t CAST_COUNT = 1024;
+
+// a floor of its own for the crowd the batching benchmark hits
+static constexpr uint8_t CROWD_Z = 14;
+static constexpr int32_t CROWD_COLUMNS = 5;
+static constexpr int32_t CROWD_ROWS = 4;
+static constexpr size_t CROWD_VIEWER_COUNT = 30;
+static constexpr size_t CROWD_SPELL_COUNT = 5;
+
+struct Cast {
+	Position casterPos;
+	Position targetPos;
+};
+
+// the caster stands up to three tiles from the target, in every direction
+std::vector<Cast> createCasts()
+{
+	std::vector<Cast> casts;
+	casts.reserve(CAST_COUNT);
+	for (size_t i = 0; i < CAST_COUNT; ++i) {
+		Position targetPos = BenchWorld::getRandomPosition(BenchWorld::SURFACE_Z, 16);
+		Position casterPos = targetPos;
+		casterPos.x += static_cast<int32_t>(i % 7) - 3;
+		casterPos.y += static_cast<int32_t>((i / 7) % 7) - 3;
+		casts.push_back({casterPos, targetPos});
+	}
+	return casts;
+}
+
+// What Combat::doAreaCombat does before it hits anything: collect the tiles
+// of the area and the players that see the effects.
+void castArea(benchmark::State& state, const AreaCombat& area)
+{
+	const std::vector<Cast> casts = createCasts();
+
+	std::vector<Tile*> tiles;
+	size_t index = 0;
+	size_t found = 0;
+	for (auto _ : state) {
+		const Cast& cast = casts[index++ % CAST_COUNT];
+
+		tiles.clear();
+		Combat::getCombatArea(cast.casterPos, cast.targetPos, &area, tiles);
+
+		uint32_t maxX, maxY;
+		area.getExtents(cast.casterPos, cast.targetPos, maxX, maxY);
+
+		SpectatorVec spectators;
+		const int32_t rangeX = maxX + Map::maxViewportX;
+		const int32_t rangeY = maxY + Map::maxViewportY;
+		g_game.map.getSpectators(spectators, cast.targetPos, true, true, rangeX, rangeX, rangeY, rangeY);
+
+		found += tiles.size();
+		benchmark::DoNotOptimize(spectators);
+	}
+
+	state.counters["tiles"] = benchmark::Counter(static_cast<double>(found), benchmark::Counter::kAvgIterations);
+}
+
+// great fireball
+void BM_AreaCombatCircle(benchmark::State& state)
+{
+	AreaCombat area;
+	area.setupArea(3);
+	castArea(state, area);
+}
+BENCHMARK(BM_AreaCombatCircle);
+
+// a monster wave, rotated to the side the target is on
+void BM_AreaCombatWave(benchmark::State& state)
+{
+	AreaCombat area;
+	area.setupArea(8, 3);
+	castArea(state, area);
+}
+BENCHMARK(BM_AreaCombatWave);
+
+struct Crowd {
+	std::vector<Monster*> monsters;
+	size_t viewers = 0;
+};
+
+// CROWD_COLUMNS by CROWD_ROWS monsters and the players watching them fight
+Crowd createCrowd()
+{
+	BenchWorld::createFloor(CROWD_Z, false);
+
+	Crowd crowd;
+	const Position center(BenchWorld::ORIGIN_X + BenchWorld::SIZE / 2, BenchWorld::ORIGIN_Y + BenchWorld::SIZE / 2, CROWD_Z);
+
+	// nothing in the benchmark comes close to killing them
+	static MonsterType monsterType;
+	monsterType.name = "target";
+	monsterType.nameDescription = "a target";
+	monsterType.info.health = std::numeric_limits<int32_t>::max();
+	monsterType.info.healthMax = std::numeric_limits<int32_t>::max();
+	for (int32_t y = 0; y < CROWD_ROWS; ++y) {
+		for (int32_t x = 0; x < CROWD_COLUMNS; ++x) {
+			Monster* monster = new Monster(&monsterType);
+			monster->incrementReferenceCounter();
+			if (!g_game.map.placeCreature(Position(center.x + x - CROWD_COLUMNS / 2, center.y + y - CROWD_ROWS, CROWD_Z), monster, false, true)) {
+				monster->decrementReferenceCounter();
+				continue;
+			}
+
+			// batched health updates look the creatures up by id
+			g_game.addMonster(monster);
+			crowd.monsters.push_back(monster);
+		}
+	}
+
+	for (size_t i = 0; i < CROWD_VIEWER_COUNT; ++i) {
+		Position pos(center.x + static_cast<int32_t>(i % 10) - 5, center.y + 1 + static_cast<int32_t>(i / 10), CROWD_Z);
+		if (BenchWorld::createPlayer(pos)) {
+			++crowd.viewers;
+		}
+	}
+	return crowd;
+}
+
+// Arg: combatBatching. Every iteration is a creature check in which
+// CROWD_SPELL_COUNT area spells hit the whole crowd. The batched run also
+// counts the messages every viewer got, against what it would have gotten.
+void BM_CombatBatch(benchmark::State& state)
+{
+	static const Crowd crowd = createCrowd();
+	if (crowd.monsters.size() != CROWD_COLUMNS * CROWD_ROWS || crowd.viewers != CROWD_VIEWER_COUNT) {
+		state.SkipWithError("Could not place the crowd.");
+		return;
+	}
+
+	g_game.setCombatBatching(state.range(0) != 0);
+	const Game::CombatBatchStats start = g_game.getCombatBatchStats();
+
+	for (auto _ : state) {
+		g_game.startCombatBatch();
+		for (size_t i = 0; i < CROWD_SPELL_COUNT; ++i) {
+			for (Monster* monster : crowd.monsters) {
+				CombatDamage damage;
+				damage.primary.type = COMBAT_FIREDAMAGE;
+				damage.primary.value = -1;
+				g_game.combatChangeHealth(nullptr, monster, damage);
+			}
+		}
+		g_game.endCombatBatch();
+	}
+
+	g_game.setCombatBatching(false);
+
+	if (state.range(0) != 0) {
+		const Game::CombatBatchStats& stats = g_game.getCombatBatchStats();
+		double viewers = static_cast<double>(crowd.viewers);
+		state.counters["unbatched/viewer"] = benchmark::Counter((stats.queued - start.queued) / viewers, benchmark::Counter::kAvgIterations);
+		state.counters["batched/viewer"] = benchmark::Counter((stats.sent - start.sent) / viewers, benchmark::Counter::kAvgIterations);
+	}
+}
+BENCHMARK(BM_CombatBatch)->Arg(0)->Arg(1);
+
+}
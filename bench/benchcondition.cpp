@@ -0,0 +1,140 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "otpch.h"
+
+#include "benchworld.h"
+
+#include "condition.h"
+#include "game.h"
+#include "monster.h"
+#include "monsters.h"
+#include "player.h"
+
+#include <benchmark/benchmark.h>
+
+extern Game g_game;
+
+namespace {
+
+// a floor of its own, the other benchmarks never see the fight
+static constexpr uint8_t FIGHT_Z = 13;
+static constexpr size_t FIGHT_MONSTER_COUNT = 200;
+static constexpr size_t FIGHT_PLAYER_COUNT = 500;
+static constexpr uint32_t FIGHT_SPELL_COUNT = 8;
+// long enough that nothing runs out and no damage is dealt while measuring
+static constexpr int32_t FIGHT_TICKS = 60 * 60 * 1000;
+
+struct Fight {
+	std::vector<Monster*> monsters;
+	std::vector<Player*> players;
+};
+
+void addDamageCondition(Creature* creature, ConditionType_t type)
+{
+	ConditionDamage* condition = static_cast<ConditionDamage*>(Condition::createCondition(CONDITIONID_COMBAT, type, 0));
+	condition->setParam(CONDITION_PARAM_DELAYED, 1);
+	condition->addDamage(1, FIGHT_TICKS, -10);
+	creature->addCondition(condition);
+}
+
+// The boss and its summons burn, are poisoned and electrified, the players
+// fighting them only carry timed conditions: in fight, haste and cooldowns.
+Fight createFight()
+{
+	BenchWorld::createFloor(FIGHT_Z, false);
+
+	Fight fight;
+
+	static MonsterType monsterType;
+	monsterType.name = "boss";
+	monsterType.nameDescription = "a boss";
+	for (size_t tries = 0; fight.monsters.size() < FIGHT_MONSTER_COUNT && tries < FIGHT_MONSTER_COUNT * 2; ++tries) {
+		Monster* monster = new Monster(&monsterType);
+		monster->incrementReferenceCounter();
+		if (!g_game.map.placeCreature(BenchWorld::getRandomPosition(FIGHT_Z), monster, false, true)) {
+			monster->decrementReferenceCounter();
+			continue;
+		}
+
+		addDamageCondition(monster, CONDITION_FIRE);
+		addDamageCondition(monster, CONDITION_POISON);
+		addDamageCondition(monster, CONDITION_ENERGY);
+		fight.monsters.push_back(monster);
+	}
+
+	static Group group{"bench", 0, 0, 0, 1, false};
+	for (size_t tries = 0; fight.players.size() < FIGHT_PLAYER_COUNT && tries < FIGHT_PLAYER_COUNT * 2; ++tries) {
+		Player* player = BenchWorld::createPlayer(BenchWorld::getRandomPosition(FIGHT_Z));
+		if (!player) {
+			continue;
+		}
+
+		player->setGroup(&group);
+		player->addCondition(Condition::createCondition(CONDITIONID_DEFAULT, CONDITION_INFIGHT, FIGHT_TICKS));
+		player->addCondition(Condition::createCondition(CONDITIONID_DEFAULT, CONDITION_HASTE, FIGHT_TICKS, 100));
+		for (uint32_t spellId = 1; spellId <= FIGHT_SPELL_COUNT; ++spellId) {
+			player->addCondition(Condition::createCondition(CONDITIONID_DEFAULT, CONDITION_SPELLCOOLDOWN, FIGHT_TICKS, 0, false, spellId));
+		}
+		player->addCondition(Condition::createCondition(CONDITIONID_DEFAULT, CONDITION_SPELLGROUPCOOLDOWN, FIGHT_TICKS, 0, false, SPELLGROUP_ATTACK));
+		player->addCondition(Condition::createCondition(CONDITIONID_DEFAULT, CONDITION_SPELLGROUPCOOLDOWN, FIGHT_TICKS, 0, false, SPELLGROUP_HEALING));
+		fight.players.push_back(player);
+	}
+	return fight;
+}
+
+// Every iteration is one second of Game::checkCreatures for everybody in
+// the fight, with the condition checks that casting spells and taking hits do.
+void BM_CreatureConditions(benchmark::State& state)
+{
+	static const Fight fight = createFight();
+	if (fight.monsters.size() != FIGHT_MONSTER_COUNT || fight.players.size() != FIGHT_PLAYER_COUNT) {
+		state.SkipWithError("Could not place the fight.");
+		return;
+	}
+
+	size_t found = 0;
+	for (auto _ : state) {
+		for (Monster* monster : fight.monsters) {
+			monster->executeConditions(EVENT_CREATURE_THINK_INTERVAL);
+			found += monster->hasCondition(CONDITION_FIRE);
+			found += monster->hasCondition(CONDITION_PARALYZE);
+			found += monster->isInvisible();
+		}
+
+		for (Player* player : fight.players) {
+			player->executeConditions(EVENT_CREATURE_THINK_INTERVAL);
+			found += player->hasCondition(CONDITION_INFIGHT);
+			found += player->hasCondition(CONDITION_PARALYZE);
+			found += player->hasCondition(CONDITION_POISON);
+			found += player->isInvisible();
+			for (uint32_t spellId = 1; spellId <= FIGHT_SPELL_COUNT; ++spellId) {
+				found += player->hasCondition(CONDITION_SPELLCOOLDOWN, spellId);
+			}
+			found += player->hasCondition(CONDITION_SPELLGROUPCOOLDOWN, SPELLGROUP_ATTACK);
+		}
+	}
+
+	benchmark::DoNotOptimize(found);
+	state.counters["creatures"] = static_cast<double>(fight.monsters.size() + fight.players.size());
+}
+BENCHMARK(BM_CreatureConditions)->Unit(benchmark::kMicrosecond);
+
+}
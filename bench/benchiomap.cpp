@@ -0,0 +1,189 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "otpch.h"
+
+#include "benchworld.h"
+
+#include "iomap.h"
+
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+
+namespace {
+
+static constexpr uint16_t SYNTHETIC_SIZE = 1024;
+static constexpr uint16_t SYNTHETIC_AREA_SIZE = 256;
+static constexpr uint8_t SYNTHETIC_FLOORS = 2;
+// written to the working directory on first use, about 20 MB
+static const char* SYNTHETIC_FILE = "tfs_bench_synthetic.otbm";
+
+// Minimal OTBM writer, properties are escaped the way OTB::Loader expects
+class OTBMWriter
+{
+	public:
+		void startNode(uint8_t type) {
+			buffer.push_back(static_cast<char>(OTB::Node::START));
+			buffer.push_back(static_cast<char>(type));
+		}
+		void endNode() {
+			buffer.push_back(static_cast<char>(OTB::Node::END));
+		}
+
+		template <typename T>
+		void write(T value) {
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+			for (size_t i = 0; i < sizeof(T); ++i) {
+				if (bytes[i] >= OTB::Node::ESCAPE) {
+					buffer.push_back(static_cast<char>(OTB::Node::ESCAPE));
+				}
+				buffer.push_back(static_cast<char>(bytes[i]));
+			}
+		}
+
+		void writeString(const std::string& value) {
+			write<uint16_t>(value.size());
+			for (char c : value) {
+				write<char>(c);
+			}
+		}
+
+		bool save(const std::string& fileName) const {
+			std::ofstream file(fileName, std::ios::binary);
+			file.write("OTBM", 4);
+			file.write(buffer.data(), buffer.size());
+			return file.good();
+		}
+
+	private:
+		std::vector<char> buffer;
+};
+
+// SYNTHETIC_SIZE squared ground tiles on two floors, every eighth tile has
+// an item node with an action id so item attributes are unserialized too
+bool createSyntheticMap()
+{
+	OTBMWriter writer;
+	writer.startNode(OTBM_ROOTV1);
+	writer.write<uint32_t>(2);
+	writer.write<uint16_t>(BenchWorld::ORIGIN_X + SYNTHETIC_SIZE);
+	writer.write<uint16_t>(BenchWorld::ORIGIN_Y + SYNTHETIC_SIZE);
+	writer.write<uint32_t>(Item::items.majorVersion);
+	writer.write<uint32_t>(Item::items.minorVersion);
+
+	writer.startNode(OTBM_MAP_DATA);
+	writer.write<uint8_t>(OTBM_ATTR_DESCRIPTION);
+	writer.writeString("tfs_bench synthetic map");
+
+	for (uint8_t z = BenchWorld::SURFACE_Z; z < BenchWorld::SURFACE_Z + SYNTHETIC_FLOORS; ++z) {
+		for (uint16_t areaX = 0; areaX < SYNTHETIC_SIZE; areaX += SYNTHETIC_AREA_SIZE) {
+			for (uint16_t areaY = 0; areaY < SYNTHETIC_SIZE; areaY += SYNTHETIC_AREA_SIZE) {
+				writer.startNode(OTBM_TILE_AREA);
+				writer.write<uint16_t>(BenchWorld::ORIGIN_X + areaX);
+				writer.write<uint16_t>(BenchWorld::ORIGIN_Y + areaY);
+				writer.write<uint8_t>(z);
+
+				for (uint16_t x = 0; x < SYNTHETIC_AREA_SIZE; ++x) {
+					for (uint16_t y = 0; y < SYNTHETIC_AREA_SIZE; ++y) {
+						writer.startNode(OTBM_TILE);
+						writer.write<uint8_t>(x);
+						writer.write<uint8_t>(y);
+						writer.write<uint8_t>(OTBM_ATTR_ITEM);
+						writer.write<uint16_t>(BenchWorld::getGroundId());
+
+						if (((x + y) % 8) == 0) {
+							writer.startNode(OTBM_ITEM);
+							writer.write<uint16_t>(BenchWorld::getPlainItemId());
+							writer.write<uint8_t>(ATTR_ACTION_ID);
+							writer.write<uint16_t>(1000 + x);
+							writer.endNode();
+						}
+						writer.endNode();
+					}
+				}
+				writer.endNode();
+			}
+		}
+	}
+
+	writer.endNode();
+	writer.endNode();
+	return writer.save(SYNTHETIC_FILE);
+}
+
+// IOMap prints progress and every duplicate unique id of the repeated loads
+class MuteOutput
+{
+	public:
+		MuteOutput() : previous(std::cout.rdbuf(nullptr)) {}
+		~MuteOutput() {
+			std::cout.rdbuf(previous);
+		}
+
+	private:
+		std::streambuf* previous;
+};
+
+// Arg: loader threads, 1 is the serial loader
+void loadMap(benchmark::State& state, const std::string& fileName)
+{
+	for (auto _ : state) {
+		std::unique_ptr<Map> map(new Map);
+
+		IOMap loader;
+		loader.setLoaderThreads(static_cast<uint32_t>(state.range(0)));
+
+		bool loaded;
+		{
+			MuteOutput mute;
+			loaded = loader.loadMap(map.get(), fileName);
+		}
+
+		if (!loaded) {
+			state.SkipWithError(("Could not load " + fileName + ": " + loader.getLastErrorString()).c_str());
+			break;
+		}
+
+		// freeing the map is not part of loading it
+		state.PauseTiming();
+		map.reset();
+		state.ResumeTiming();
+	}
+}
+
+void BM_IOMapLoad(benchmark::State& state)
+{
+	loadMap(state, BenchWorld::getMapFile());
+}
+BENCHMARK(BM_IOMapLoad)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void BM_IOMapLoadSynthetic(benchmark::State& state)
+{
+	static bool created = createSyntheticMap();
+	if (!created) {
+		state.SkipWithError("Could not write the synthetic map.");
+		return;
+	}
+
+	loadMap(state, SYNTHETIC_FILE);
+}
+BENCHMARK(BM_IOMapLoadSynthetic)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}
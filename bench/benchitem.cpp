@@ -0,0 +1,266 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "otpch.h"
+
+#include "benchworld.h"
+
+#include "container.h"
+#include "fileloader.h"
+#include "game.h"
+#include "item.h"
+#include "player.h"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+namespace {
+
+// An item carrying the attributes a player-written, decaying item usually has
+Item* createAttributedItem()
+{
+	Item* item = Item::CreateItem(BenchWorld::getPlainItemId());
+	item->setActionId(2000);
+	item->setText("The quick brown fox jumps over the lazy dog.");
+	item->setWriter("Benchmark Writer");
+	item->setDate(1577836800);
+	item->setDuration(60000);
+	item->setSpecialDescription("It is a benchmark item.");
+
+	std::string key = "bench";
+	item->setCustomAttribute(key, static_cast<int64_t>(42));
+	return item;
+}
+
+void BM_ItemAttributesSetGet(benchmark::State& state)
+{
+	Item* item = createAttributedItem();
+
+	int64_t value = 0;
+	for (auto _ : state) {
+		item->setIntAttr(ITEM_ATTRIBUTE_ACTIONID, value & 0xFFFF);
+		item->setIntAttr(ITEM_ATTRIBUTE_CHARGES, value & 0xFF);
+		item->setIntAttr(ITEM_ATTRIBUTE_DURATION, value);
+		value += item->getIntAttr(ITEM_ATTRIBUTE_ACTIONID) + item->getIntAttr(ITEM_ATTRIBUTE_DATE) + 1;
+		benchmark::DoNotOptimize(value);
+	}
+
+	delete item;
+}
+BENCHMARK(BM_ItemAttributesSetGet);
+
+void BM_ItemAttributesClone(benchmark::State& state)
+{
+	Item* item = createAttributedItem();
+
+	for (auto _ : state) {
+		Item* clone = item->clone();
+		benchmark::DoNotOptimize(clone);
+		delete clone;
+	}
+
+	delete item;
+}
+BENCHMARK(BM_ItemAttributesClone);
+
+void BM_ItemSerializeAttr(benchmark::State& state)
+{
+	Item* item = createAttributedItem();
+
+	for (auto _ : state) {
+		PropWriteStream propWriteStream;
+		item->serializeAttr(propWriteStream);
+
+		size_t size;
+		benchmark::DoNotOptimize(propWriteStream.getStream(size));
+	}
+
+	delete item;
+}
+BENCHMARK(BM_ItemSerializeAttr);
+
+// PropStream reads through Item::readAttr, as done for every item when
+// loading the map and player inventories
+void BM_PropStreamUnserializeAttr(benchmark::State& state)
+{
+	Item* source = createAttributedItem();
+	PropWriteStream propWriteStream;
+	source->serializeAttr(propWriteStream);
+	delete source;
+
+	size_t size;
+	const char* buffer = propWriteStream.getStream(size);
+
+	Item* item = Item::CreateItem(BenchWorld::getPlainItemId());
+	for (auto _ : state) {
+		PropStream propStream;
+		propStream.init(buffer, size);
+		benchmark::DoNotOptimize(item->unserializeAttr(propStream));
+	}
+
+	delete item;
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * size);
+}
+BENCHMARK(BM_PropStreamUnserializeAttr);
+
+// The raw primitives of PropStream: fixed size reads and strings
+void BM_PropStreamRead(benchmark::State& state)
+{
+	PropWriteStream propWriteStream;
+	for (int i = 0; i < 256; ++i) {
+		propWriteStream.write<uint8_t>(static_cast<uint8_t>(i));
+		propWriteStream.write<uint16_t>(static_cast<uint16_t>(i * 3));
+		propWriteStream.write<uint32_t>(static_cast<uint32_t>(i * 7));
+		propWriteStream.writeString("a short string");
+	}
+
+	size_t size;
+	const char* buffer = propWriteStream.getStream(size);
+
+	for (auto _ : state) {
+		PropStream propStream;
+		propStream.init(buffer, size);
+
+		uint8_t u8;
+		uint16_t u16;
+		uint32_t u32;
+		std::string str;
+		uint64_t sum = 0;
+		while (propStream.read<uint8_t>(u8) && propStream.read<uint16_t>(u16) && propStream.read<uint32_t>(u32) && propStream.readString(str)) {
+			sum += u8 + u16 + u32 + str.size();
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * size);
+}
+BENCHMARK(BM_PropStreamRead);
+
+size_t getSlabCount()
+{
+	size_t slabs = 0;
+	for (const SlabAllocator::Stats& stats : SlabAllocator::getStats()) {
+		slabs += stats.slabs;
+	}
+	return slabs;
+}
+
+// A compressed week of uptime: a standing population of map and house items
+// with loot and corpses created and released around it. The slabs counted
+// after the first and the last day should stay the same.
+// Arg: items created or released per day
+void BM_ItemSlabChurn(benchmark::State& state)
+{
+	static constexpr size_t DAYS = 7;
+	static constexpr size_t POPULATION = 100000;
+
+	for (auto _ : state) {
+		std::mt19937 rng(7);
+		std::vector<Item*> live;
+		live.reserve(POPULATION * 2);
+
+		size_t firstDaySlabs = 0;
+		for (size_t day = 0; day < DAYS; ++day) {
+			for (int64_t i = 0; i < state.range(0); ++i) {
+				if (live.size() < POPULATION || rng() % 2 == 0) {
+					if (rng() % 4 == 0) {
+						live.push_back(new Container(BenchWorld::getPlainItemId(), 8));
+					} else {
+						live.push_back(Item::CreateItem(BenchWorld::getPlainItemId()));
+					}
+				} else {
+					size_t index = rng() % live.size();
+					delete live[index];
+					live[index] = live.back();
+					live.pop_back();
+				}
+			}
+
+			if (day == 0) {
+				firstDaySlabs = getSlabCount();
+			}
+		}
+
+		state.counters["slabs_day1"] = firstDaySlabs;
+		state.counters["slabs_day7"] = getSlabCount();
+
+		for (Item* item : live) {
+			delete item;
+		}
+	}
+}
+BENCHMARK(BM_ItemSlabChurn)->Arg(1000000)->Unit(benchmark::kMillisecond)->Iterations(1);
+
+Player* createCarrier()
+{
+	for (int attempt = 0; attempt < 100; ++attempt) {
+		if (Player* player = BenchWorld::createPlayer(BenchWorld::getRandomPosition(BenchWorld::SURFACE_Z, 1))) {
+			// equipped without notifications, as when the player is loaded
+			Container* backpack = new Container(BenchWorld::getPlainItemId(), 20);
+			Cylinder* inventory = player;
+			inventory->internalAddThing(CONST_SLOT_BACKPACK, backpack);
+			for (int i = 0; i < 10; ++i) {
+				backpack->internalAddThing(Item::CreateItem(BenchWorld::getPlainItemId()));
+			}
+			return player;
+		}
+	}
+	return nullptr;
+}
+
+// A stack in the backpack of a player is added, partly removed and then
+// removed, counting it through the item index after each step. The counts
+// are checked, a partly removed stack stays with the player.
+void BM_PlayerItemTypeCount(benchmark::State& state)
+{
+	static Player* player = createCarrier();
+	if (!player) {
+		state.SkipWithError("Could not place the player.");
+		return;
+	}
+
+	const uint16_t stackableId = BenchWorld::getStackableItemId();
+	Container* backpack = player->getInventoryItem(CONST_SLOT_BACKPACK)->getContainer();
+	const Cylinder* inventory = player;
+
+	for (auto _ : state) {
+		Item* stack = Item::CreateItem(stackableId, 100);
+		if (g_game.internalAddItem(backpack, stack, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
+			delete stack;
+			state.SkipWithError("Could not add the stack.");
+			break;
+		}
+
+		uint32_t added = inventory->getItemTypeCount(stackableId);
+		g_game.internalRemoveItem(stack, 40);
+		uint32_t partlyRemoved = inventory->getItemTypeCount(stackableId);
+		g_game.internalRemoveItem(stack);
+		uint32_t removed = inventory->getItemTypeCount(stackableId);
+		g_game.cleanup();
+
+		if (added != 100 || partlyRemoved != 60 || removed != 0) {
+			state.SkipWithError("The item index counted the stack wrong.");
+			break;
+		}
+	}
+}
+BENCHMARK(BM_PlayerItemTypeCount);
+
+}
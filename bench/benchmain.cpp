@@ -0,0 +1,73 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "otpch.h"
+
+#include "benchworld.h"
+
+#include "configmanager.h"
+#include "databasetasks.h"
+#include "game.h"
+#include "monsters.h"
+#include "rsa.h"
+#include "scheduler.h"
+#include "vocation.h"
+
+#include <benchmark/benchmark.h>
+
+// the server globals normally defined next to main() in otserv.cpp
+DatabaseTasks g_databaseTasks;
+Dispatcher g_dispatcher;
+Scheduler g_scheduler;
+
+Game g_game;
+ConfigManager g_config;
+Monsters g_monsters;
+Vocations g_vocations;
+RSA g_RSA;
+
+// Usage: tfs_bench [--items=data/items/items.otb] [--map=data/world/forgotten.otbm] [--benchmark_format=json] [--benchmark_out=<file>] ...
+int main(int argc, char* argv[])
+{
+	benchmark::Initialize(&argc, argv);
+
+	std::string itemsFile = "data/items/items.otb";
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg.compare(0, 8, "--items=") == 0) {
+			itemsFile = arg.substr(8);
+		} else if (arg.compare(0, 6, "--map=") == 0) {
+			BenchWorld::setMapFile(arg.substr(6));
+		} else {
+			std::cout << "> ERROR: Unrecognized argument " << arg << std::endl;
+			return 1;
+		}
+	}
+
+	if (!BenchWorld::load(itemsFile)) {
+		return 1;
+	}
+
+	benchmark::RunSpecifiedBenchmarks();
+
+	// started by the walk benchmark
+	g_scheduler.shutdown();
+	g_scheduler.join();
+	return 0;
+}
@@ -0,0 +1,190 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "otpch.h"
+
+#include "benchworld.h"
+
+#include "game.h"
+
+#include <benchmark/benchmark.h>
+
+extern Game g_game;
+
+namespace {
+
+static constexpr size_t POSITION_COUNT = 1024;
+
+std::vector<Position> createPositions(uint8_t z, uint16_t margin)
+{
+	std::vector<Position> positions;
+	positions.reserve(POSITION_COUNT);
+	for (size_t i = 0; i < POSITION_COUNT; ++i) {
+		positions.push_back(BenchWorld::getRandomPosition(z, margin));
+	}
+	return positions;
+}
+
+// Args: multifloor, onlyPlayers. The spectator cache is cleared before
+// every lookup so the quadtree walk is what gets measured.
+void BM_MapGetSpectators(benchmark::State& state)
+{
+	bool multifloor = state.range(0) != 0;
+	bool onlyPlayers = state.range(1) != 0;
+	const std::vector<Position> positions = createPositions(BenchWorld::SURFACE_Z, 0);
+
+	Map& map = g_game.map;
+	size_t index = 0;
+	size_t found = 0;
+	for (auto _ : state) {
+		if (multifloor) {
+			state.PauseTiming();
+			map.clearSpectatorCache();
+			map.clearPlayersSpectatorCache();
+			state.ResumeTiming();
+		}
+
+		SpectatorVec spectators;
+		map.getSpectators(spectators, positions[index++ % POSITION_COUNT], multifloor, onlyPlayers);
+		found += spectators.size();
+		benchmark::DoNotOptimize(spectators);
+	}
+
+	state.counters["spectators"] = benchmark::Counter(static_cast<double>(found), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_MapGetSpectators)->ArgsProduct({{0, 1}, {0, 1}});
+
+// Same lookup with the default viewport on every call, so consecutive
+// lookups at a hot position are served from the spectator cache.
+void BM_MapGetSpectatorsCached(benchmark::State& state)
+{
+	const std::vector<Position> positions = createPositions(BenchWorld::SURFACE_Z, 0);
+
+	Map& map = g_game.map;
+	map.clearSpectatorCache();
+
+	size_t index = 0;
+	for (auto _ : state) {
+		SpectatorVec spectators;
+		map.getSpectators(spectators, positions[index++ % 16], true);
+		benchmark::DoNotOptimize(spectators);
+	}
+}
+BENCHMARK(BM_MapGetSpectatorsCached);
+
+// A* (AStarNodes through Map::getPathMatching) from the walker to random
+// targets around it, the underground floor has walls to path around.
+// Arg: maximum distance of the target.
+void BM_MapPathfinding(benchmark::State& state)
+{
+	Player* walker = BenchWorld::getWalker();
+	const Position& walkerPos = walker->getPosition();
+	int32_t distance = static_cast<int32_t>(state.range(0));
+
+	std::mt19937 generator(0x2A5);
+	std::uniform_int_distribution<int32_t> offset(-distance, distance);
+
+	std::vector<Position> targets;
+	targets.reserve(POSITION_COUNT);
+	while (targets.size() < POSITION_COUNT) {
+		Position target(walkerPos.x + offset(generator), walkerPos.y + offset(generator), walkerPos.z);
+		if (g_game.map.getTile(target)) {
+			targets.push_back(target);
+		}
+	}
+
+	FindPathParams fpp;
+	fpp.minTargetDist = 0;
+	fpp.maxTargetDist = 1;
+	fpp.maxSearchDist = distance + 10;
+
+	size_t index = 0;
+	size_t pathsFound = 0;
+	for (auto _ : state) {
+		std::list<Direction> dirList;
+		if (walker->getPathTo(targets[index++ % POSITION_COUNT], dirList, fpp)) {
+			++pathsFound;
+		}
+		benchmark::DoNotOptimize(dirList);
+	}
+
+	state.counters["found"] = benchmark::Counter(static_cast<double>(pathsFound), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_MapPathfinding)->Arg(4)->Arg(8)->Arg(16);
+
+// Map::isSightClear between random pairs of tiles on the underground floor,
+// the walls block some of the lines. Arg: maximum distance between them.
+void BM_MapSightClear(benchmark::State& state)
+{
+	int32_t distance = static_cast<int32_t>(state.range(0));
+	const std::vector<Position> positions = createPositions(BenchWorld::UNDERGROUND_Z, distance);
+
+	std::mt19937 generator(0x51C);
+	std::uniform_int_distribution<int32_t> offset(-distance, distance);
+
+	std::vector<Position> targets;
+	targets.reserve(POSITION_COUNT);
+	for (const Position& position : positions) {
+		targets.emplace_back(position.x + offset(generator), position.y + offset(generator), position.z);
+	}
+
+	const Map& map = g_game.map;
+	size_t index = 0;
+	size_t clear = 0;
+	for (auto _ : state) {
+		size_t i = index++ % POSITION_COUNT;
+		if (map.isSightClear(positions[i], targets[i], true)) {
+			++clear;
+		}
+	}
+
+	state.counters["clear"] = benchmark::Counter(static_cast<double>(clear), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_MapSightClear)->Arg(4)->Arg(8)->Arg(16);
+
+// Tile::queryAdd of a plain item and of the walker on random tiles of the
+// underground floor, walls included. Arg: 0 item, 1 creature.
+void BM_TileQueryAdd(benchmark::State& state)
+{
+	const std::vector<Position> positions = createPositions(BenchWorld::UNDERGROUND_Z, 0);
+
+	std::vector<Tile*> tiles;
+	tiles.reserve(POSITION_COUNT);
+	for (const Position& position : positions) {
+		if (Tile* tile = g_game.map.getTile(position)) {
+			tiles.push_back(tile);
+		}
+	}
+
+	std::unique_ptr<Item> item(Item::CreateItem(BenchWorld::getPlainItemId()));
+	const Thing& thing = state.range(0) == 0 ? static_cast<const Thing&>(*item) : *BenchWorld::getWalker();
+
+	size_t index = 0;
+	size_t added = 0;
+	for (auto _ : state) {
+		if (tiles[index++ % tiles.size()]->queryAdd(0, thing, 1, 0) == RETURNVALUE_NOERROR) {
+			++added;
+		}
+	}
+
+	state.counters["possible"] = benchmark::Counter(static_cast<double>(added), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_TileQueryAdd)->Arg(0)->Arg(1);
+
+}
@@ -0,0 +1,194 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "otpch.h"
+
+#include "benchworld.h"
+
+#include "outputmessage.h"
+#include "player.h"
+#include "protocol.h"
+#include "xtea.h"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+const xtea::key benchKey = {{0x8A3F2C61, 0x1B7E5D94, 0xC4096F2E, 0x7D13A8B5}};
+
+// Looks like a stream of game packets: opcodes, positions, small counters
+// and item ids, so it compresses about as well as real traffic.
+std::vector<char> createPayload(size_t size)
+{
+	std::mt19937 generator(0x51A7);
+	std::uniform_int_distribution<uint16_t> smallValue(0, 15);
+	std::uniform_int_distribution<uint16_t> itemId(100, 30000);
+
+	std::vector<char> payload;
+	payload.reserve(size);
+	while (payload.size() < size) {
+		uint16_t id = itemId(generator);
+		const char record[] = {
+			static_cast<char>(0x6A), static_cast<char>(0xE8), 0x03, static_cast<char>(0xE8), 0x03, 0x07,
+			static_cast<char>(id & 0xFF), static_cast<char>(id >> 8), static_cast<char>(smallValue(generator))
+		};
+		payload.insert(payload.end(), record, record + std::min(sizeof(record), size - payload.size()));
+	}
+	return payload;
+}
+
+class BenchProtocol final : public Protocol
+{
+	public:
+		BenchProtocol(bool compression, bool encryption) : Protocol(nullptr) {
+			if (compression) {
+				enableCompression();
+			}
+
+			if (encryption) {
+				enableXTEAEncryption();
+				setXTEAKey(benchKey);
+			}
+		}
+
+		void onRecvFirstMessage(NetworkMessage&) override {}
+};
+
+void BM_XteaEncrypt(benchmark::State& state)
+{
+	size_t size = static_cast<size_t>(state.range(0));
+	std::vector<char> payload = createPayload(size);
+	std::vector<uint8_t> buffer(payload.begin(), payload.end());
+
+	for (auto _ : state) {
+		xtea::encrypt(buffer.data(), buffer.size(), benchKey);
+		benchmark::ClobberMemory();
+	}
+
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * size);
+}
+BENCHMARK(BM_XteaEncrypt)->RangeMultiplier(4)->Range(64, 16384);
+
+void BM_XteaDecrypt(benchmark::State& state)
+{
+	size_t size = static_cast<size_t>(state.range(0));
+	std::vector<char> payload = createPayload(size);
+	std::vector<uint8_t> buffer(payload.begin(), payload.end());
+
+	for (auto _ : state) {
+		xtea::decrypt(buffer.data(), buffer.size(), benchKey);
+		benchmark::ClobberMemory();
+	}
+
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * size);
+}
+BENCHMARK(BM_XteaDecrypt)->RangeMultiplier(4)->Range(64, 16384);
+
+// The whole outgoing path of a message: Protocol::compress, length header,
+// padding, XTEA and the crypto header. Args: payload size, compression.
+void BM_ProtocolSendMessage(benchmark::State& state)
+{
+	size_t size = static_cast<size_t>(state.range(0));
+	bool compression = state.range(1) != 0;
+	std::vector<char> payload = createPayload(size);
+
+	auto protocol = std::make_shared<BenchProtocol>(compression, true);
+	for (auto _ : state) {
+		OutputMessage_ptr msg = OutputMessagePool::getOutputMessage();
+		msg->addBytes(payload.data(), payload.size());
+		protocol->onSendMessage(msg);
+		benchmark::DoNotOptimize(msg->getOutputBuffer());
+	}
+
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * size);
+	state.SetLabel(compression ? "compressed" : "uncompressed");
+}
+BENCHMARK(BM_ProtocolSendMessage)->ArgsProduct({{128, 1024, 8192}, {0, 1}});
+
+// Advertising in data/chatchannels/chatchannels.xml
+static constexpr uint16_t TRADE_CHANNEL_ID = 5;
+
+enum BroadcastEvent {
+	BROADCAST_MAGIC_EFFECT,
+	BROADCAST_CREATURE_SAY,
+	BROADCAST_CHANNEL_TALK,
+};
+
+void addEvent(NetworkMessage& msg, int64_t event, const Creature* speaker)
+{
+	switch (event) {
+		case BROADCAST_MAGIC_EFFECT:
+			ProtocolGameBase::AddMagicEffect(msg, speaker->getPosition(), CONST_ME_MAGIC_BLUE);
+			break;
+		case BROADCAST_CREATURE_SAY:
+			ProtocolGameBase::AddCreatureSay(msg, speaker, TALKTYPE_SAY, "exura vita", speaker->getPosition());
+			break;
+		default:
+			ProtocolGameBase::AddToChannel(msg, speaker, TALKTYPE_CHANNEL_Y, "selling 100 spider silks, 2k each, pm me", TRADE_CHANNEL_ID);
+			break;
+	}
+}
+
+// One event delivered to the output buffers of a crowd of viewers, either
+// encoded by every viewer the way the send functions do or encoded once and
+// appended to every buffer the way the Game broadcasters and ChatChannel::talk
+// do. Args: viewers, BroadcastEvent, 0 per viewer or 1 shared.
+void BM_BroadcastEvent(benchmark::State& state)
+{
+	size_t viewers = static_cast<size_t>(state.range(0));
+	int64_t event = state.range(1);
+	bool shared = state.range(2) != 0;
+
+	const Creature* speaker = BenchWorld::getWalker();
+	std::vector<OutputMessage_ptr> outputs;
+	for (size_t i = 0; i < viewers; ++i) {
+		outputs.push_back(OutputMessagePool::getOutputMessage());
+	}
+
+	for (auto _ : state) {
+		if (shared) {
+			NetworkMessage msg;
+			addEvent(msg, event, speaker);
+			for (const OutputMessage_ptr& output : outputs) {
+				output->append(msg);
+			}
+		} else {
+			for (const OutputMessage_ptr& output : outputs) {
+				NetworkMessage msg;
+				addEvent(msg, event, speaker);
+				output->append(msg);
+			}
+		}
+
+		// a real buffer is flushed long before it fills up
+		if (outputs.front()->getLength() > NetworkMessage::MAX_PROTOCOL_BODY_LENGTH / 2) {
+			for (const OutputMessage_ptr& output : outputs) {
+				output->reset();
+			}
+		}
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * viewers);
+	state.SetLabel(shared ? "shared" : "per viewer");
+}
+BENCHMARK(BM_BroadcastEvent)->ArgsProduct({{16, 128}, {BROADCAST_MAGIC_EFFECT, BROADCAST_CREATURE_SAY}, {0, 1}});
+// a busy advertising channel
+BENCHMARK(BM_BroadcastEvent)->ArgsProduct({{500}, {BROADCAST_CHANNEL_TALK}, {0, 1}});
+
+}
@@ -0,0 +1,124 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "otpch.h"
+
+#include "benchworld.h"
+
+#include "game.h"
+#include "monster.h"
+#include "monsters.h"
+#include "movement.h"
+#include "scheduler.h"
+
+#include <benchmark/benchmark.h>
+
+#include <thread>
+
+extern Game g_game;
+extern MoveEvents* g_moveEvents;
+extern Scheduler g_scheduler;
+
+namespace {
+
+// a floor of its own, the other benchmarks never see the walkers
+static constexpr uint8_t WALK_Z = 12;
+static constexpr size_t WALK_MONSTER_COUNT = 10000;
+static constexpr size_t WALK_PLAYER_COUNT = 1000;
+// game time between two timed batches
+static constexpr int64_t WALK_INTERVAL = 50;
+
+std::vector<Monster*> createMonsters()
+{
+	// tiles notify the movement events of every step, there are none registered
+	if (!g_moveEvents) {
+		g_moveEvents = new MoveEvents;
+	}
+
+	// only arms the batch event, its task is dropped since no dispatcher runs
+	g_scheduler.start();
+
+	BenchWorld::createFloor(WALK_Z, false);
+
+	// monsters are idle without a player in sight
+	static Group group{"bench", 0, 0, 0, 1, false};
+	for (size_t i = 0; i < WALK_PLAYER_COUNT; ++i) {
+		if (Player* player = BenchWorld::createPlayer(BenchWorld::getRandomPosition(WALK_Z))) {
+			player->setGroup(&group);
+		}
+	}
+
+	// slower than a tile per second, so every walk event is a random step
+	// (Monster::getNextStep waits a second between them)
+	static MonsterType monsterType;
+	monsterType.name = "walker";
+	monsterType.nameDescription = "a walker";
+	monsterType.info.baseSpeed = std::max<uint32_t>(1, Item::items[BenchWorld::getGroundId()].speed * 2 / 3);
+
+	std::vector<Monster*> monsters;
+	monsters.reserve(WALK_MONSTER_COUNT);
+	for (size_t tries = 0; monsters.size() < WALK_MONSTER_COUNT && tries < WALK_MONSTER_COUNT * 2; ++tries) {
+		Monster* monster = new Monster(&monsterType);
+		if (!g_game.placeCreature(monster, BenchWorld::getRandomPosition(WALK_Z))) {
+			delete monster;
+			continue;
+		}
+		monsters.push_back(monster);
+	}
+	return monsters;
+}
+
+// Every iteration runs the walk steps that came due within WALK_INTERVAL,
+// about a thirtieth of the monsters, as one batch.
+void BM_CreatureWalks(benchmark::State& state)
+{
+	static const std::vector<Monster*> monsters = createMonsters();
+	if (monsters.size() != WALK_MONSTER_COUNT) {
+		state.SkipWithError("Could not place the monsters.");
+		return;
+	}
+
+	std::vector<Position> positions(monsters.size());
+	size_t steps = 0;
+	for (auto _ : state) {
+		state.PauseTiming();
+		for (size_t i = 0; i < monsters.size(); ++i) {
+			// what onThink does for monsters that are awake, blocked ones walk again
+			monsters[i]->addEventWalk();
+			positions[i] = monsters[i]->getPosition();
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(WALK_INTERVAL));
+		state.ResumeTiming();
+
+		g_game.checkCreatureSteps();
+
+		state.PauseTiming();
+		for (size_t i = 0; i < monsters.size(); ++i) {
+			if (monsters[i]->getPosition() != positions[i]) {
+				++steps;
+			}
+		}
+		state.ResumeTiming();
+	}
+
+	state.counters["steps"] = benchmark::Counter(static_cast<double>(steps), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_CreatureWalks)->Iterations(100)->Unit(benchmark::kMicrosecond);
+
+}
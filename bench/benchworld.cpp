@@ -0,0 +1,168 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "otpch.h"
+
+#include "benchworld.h"
+
+#include "fileloader.h"
+#include "game.h"
+
+extern Game g_game;
+
+namespace {
+
+uint16_t groundId = 0;
+uint16_t plainItemId = 0;
+uint16_t stackableItemId = 0;
+Player* walker = nullptr;
+std::string mapFile = "data/world/forgotten.otbm";
+
+std::mt19937& getBenchGenerator()
+{
+	// fixed seed, every run benchmarks the same world
+	static std::mt19937 generator(0x7F5);
+	return generator;
+}
+
+bool findItemIds()
+{
+	for (size_t id = 100, size = Item::items.size(); id < size; ++id) {
+		const ItemType& it = Item::items[id];
+		if (it.id == 0) {
+			continue;
+		}
+
+		if (groundId == 0 && it.isGroundTile() && it.speed != 0 && !it.blockSolid) {
+			groundId = it.id;
+		} else if (plainItemId == 0 && it.group == ITEM_GROUP_NONE && it.type == ITEM_TYPE_NONE && it.pickupable && !it.stackable) {
+			plainItemId = it.id;
+		} else if (stackableItemId == 0 && it.group == ITEM_GROUP_NONE && it.type == ITEM_TYPE_NONE && it.pickupable && it.stackable) {
+			stackableItemId = it.id;
+		}
+
+		if (groundId != 0 && plainItemId != 0 && stackableItemId != 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+}
+
+bool BenchWorld::load(const std::string& itemsFile)
+{
+	try {
+		if (!Item::items.loadFromOtb(itemsFile)) {
+			std::cout << "> ERROR: Unable to load " << itemsFile << '!' << std::endl;
+			return false;
+		}
+	} catch (const OTB::LoadError& err) {
+		std::cout << "> ERROR: Unable to load " << itemsFile << ": " << err.what() << std::endl;
+		return false;
+	}
+
+	if (!findItemIds()) {
+		std::cout << "> ERROR: " << itemsFile << " has no walkable ground or plain item." << std::endl;
+		return false;
+	}
+
+	createFloor(SURFACE_Z, false);
+	createFloor(UNDERGROUND_Z, true);
+
+	for (size_t i = 0; i < PLAYER_COUNT; ++i) {
+		createPlayer(getRandomPosition(SURFACE_Z));
+	}
+
+	walker = createPlayer(Position(ORIGIN_X + SIZE / 2, ORIGIN_Y + SIZE / 2, UNDERGROUND_Z));
+	return walker != nullptr;
+}
+
+void BenchWorld::createFloor(uint8_t z, bool walls)
+{
+	Map& map = g_game.map;
+	for (uint16_t x = BenchWorld::ORIGIN_X; x < BenchWorld::ORIGIN_X + BenchWorld::SIZE; ++x) {
+		for (uint16_t y = BenchWorld::ORIGIN_Y; y < BenchWorld::ORIGIN_Y + BenchWorld::SIZE; ++y) {
+			// wall segments with a gap every few tiles, missing tiles are not walkable
+			if (walls && (x % 7) == 3 && (y % 6) != 0) {
+				continue;
+			}
+
+			Tile* tile = new DynamicTile(x, y, z);
+			tile->internalAddThing(Item::CreateItem(groundId));
+			map.setTile(x, y, z, tile);
+		}
+	}
+}
+
+Player* BenchWorld::createPlayer(const Position& pos)
+{
+	static uint32_t playerCount = 0;
+
+	Player* player = new Player(nullptr);
+	player->setName("Bench Player " + std::to_string(++playerCount));
+	player->incrementReferenceCounter();
+	if (!g_game.map.placeCreature(pos, player, false, true)) {
+		player->decrementReferenceCounter();
+		return nullptr;
+	}
+
+	// gives the player its id
+	g_game.addPlayer(player);
+	return player;
+}
+
+uint16_t BenchWorld::getGroundId()
+{
+	return groundId;
+}
+
+uint16_t BenchWorld::getPlainItemId()
+{
+	return plainItemId;
+}
+
+uint16_t BenchWorld::getStackableItemId()
+{
+	return stackableItemId;
+}
+
+Player* BenchWorld::getWalker()
+{
+	return walker;
+}
+
+const std::string& BenchWorld::getMapFile()
+{
+	return mapFile;
+}
+
+void BenchWorld::setMapFile(const std::string& fileName)
+{
+	mapFile = fileName;
+}
+
+Position BenchWorld::getRandomPosition(uint8_t z, uint16_t margin /*= 0*/)
+{
+	std::uniform_int_distribution<uint16_t> distribution(margin, SIZE - margin - 1);
+	std::mt19937& generator = getBenchGenerator();
+	uint16_t x = ORIGIN_X + distribution(generator);
+	uint16_t y = ORIGIN_Y + distribution(generator);
+	return Position(x, y, z);
+}
@@ -0,0 +1,65 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef FS_BENCHWORLD_H_5C8E2A7F1D3B4E9A6F0C2B8D4E1A7C3F
+#define FS_BENCHWORLD_H_5C8E2A7F1D3B4E9A6F0C2B8D4E1A7C3F
+
+#include "position.h"
+
+class Player;
+
+// Synthetic world shared by all benchmarks: a square of ground tiles on
+// two floors, players spread randomly over the surface floor and a lone
+// walker underground whose floor has wall segments to path around.
+// Only items.otb is read from disk, nothing touches the database.
+namespace BenchWorld {
+
+static constexpr uint16_t ORIGIN_X = 1000;
+static constexpr uint16_t ORIGIN_Y = 1000;
+static constexpr uint16_t SIZE = 256;
+static constexpr uint8_t SURFACE_Z = 7;
+static constexpr uint8_t UNDERGROUND_Z = 8;
+static constexpr size_t PLAYER_COUNT = 2000;
+
+bool load(const std::string& itemsFile);
+
+// Walkable ground, a plain (non-container, non-stackable) item and a
+// stackable one
+uint16_t getGroundId();
+uint16_t getPlainItemId();
+uint16_t getStackableItemId();
+
+Player* getWalker();
+
+// Ground on the whole square of floor z, optionally with the wall segments
+// of the underground floor
+void createFloor(uint8_t z, bool walls);
+// Player without a connection, nullptr if pos is blocked
+Player* createPlayer(const Position& pos);
+
+// OTBM map read by the map loading benchmarks, --map=
+const std::string& getMapFile();
+void setMapFile(const std::string& fileName);
+
+// Deterministic random position on the given floor, inside the world
+Position getRandomPosition(uint8_t z, uint16_t margin = 0);
+
+}
+
+#endif
@@ -10,5 +10,6 @@ function Creature:onTargetCombat(target)
 	return RETURNVALUE_NOERROR
 end
 
+-- only called for hear listeners, see creature:setHearListener(true)
 function Creature:onHear(speaker, words, type)
 end
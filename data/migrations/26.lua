@@ -1,3 +1,5 @@
 function onUpdateDatabase()
-	return false
+	print("> Updating database to version 27 (offline player deliveries)")
+	db.query("CREATE TABLE IF NOT EXISTS `player_deliveries` (`id` INT UNSIGNED NOT NULL AUTO_INCREMENT, `player_id` INT NOT NULL, `type` TINYINT UNSIGNED NOT NULL, `depot_id` SMALLINT UNSIGNED NOT NULL DEFAULT 0, `itemtype` SMALLINT UNSIGNED NOT NULL DEFAULT 0, `amount` BIGINT NOT NULL DEFAULT 0, `item` BLOB NOT NULL, PRIMARY KEY (`id`), KEY(`player_id`), FOREIGN KEY (`player_id`) REFERENCES `players`(`id`) ON DELETE CASCADE) ENGINE = InnoDB")
+	return true
 end
@@ -0,0 +1,35 @@
+function onSay(player, words, param)
+	if not player:getGroup():getAccess() then
+		return true
+	end
+
+	if player:getAccountType() < ACCOUNT_TYPE_GOD then
+		return false
+	end
+
+	logCommand(player, words, param)
+
+	local split = param:split(" ")
+	local action = split[1] and split[1]:lower() or ""
+	if action == "start" then
+		local sampleInterval = tonumber(split[2]) or 0
+		Game.startLuaProfiler(sampleInterval)
+		player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, string.format("Lua profiler started%s.", sampleInterval > 0 and string.format(" (sampling every %d instructions)", sampleInterval) or ""))
+	elseif action == "stop" then
+		Game.stopLuaProfiler()
+		player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Lua profiler stopped.")
+	elseif action == "reset" then
+		Game.resetLuaProfiler()
+		player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Lua profiler reset.")
+	elseif action == "dump" then
+		local prefix = "data/logs/luaprofile-" .. os.date("%Y%m%d-%H%M%S")
+		if Game.dumpLuaProfiler(prefix) then
+			player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Lua profile written to " .. prefix .. ".folded")
+		else
+			player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Could not write the Lua profile.")
+		end
+	else
+		player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Usage: /profiler start [sample interval], stop, reset or dump.")
+	end
+	return false
+end
@@ -0,0 +1,35 @@
+function onSay(player, words, param)
+	if not player:getGroup():getAccess() then
+		return true
+	end
+
+	if player:getAccountType() < ACCOUNT_TYPE_GOD then
+		return false
+	end
+
+	logCommand(player, words, param)
+
+	local split = param:split(" ")
+	local action = split[1] and split[1]:lower() or ""
+	if action == "start" then
+		local longTaskThreshold = tonumber(split[2]) or 50
+		local dumpInterval = tonumber(split[3]) or 0
+		Game.startDispatcherTrace(longTaskThreshold, dumpInterval)
+		player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, string.format("Dispatcher trace started, long task threshold %d ms.", longTaskThreshold))
+	elseif action == "stop" then
+		Game.stopDispatcherTrace()
+		player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Dispatcher trace stopped.")
+	elseif action == "reset" then
+		Game.resetDispatcherTrace()
+		player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Dispatcher trace reset.")
+	elseif action == "dump" then
+		if Game.dumpDispatcherTrace() then
+			player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Dispatcher trace appended to data/logs/dispatcher.log")
+		else
+			player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Could not write the dispatcher trace.")
+		end
+	else
+		player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Usage: /tasktrace start [long task ms] [dump interval minutes], stop, reset or dump.")
+	end
+	return false
+end
@@ -0,0 +1,608 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "otpch.h"
+
+#include "botclient.h"
+
+#include "const.h"
+#include "rsa.h"
+
+namespace {
+
+static constexpr uint32_t LOGIN_PROBE_INTERVAL = 250;
+static constexpr uint32_t LOGIN_TIMEOUT = 30 * 1000;
+static constexpr size_t MAX_PENDING_PINGS = 64;
+
+// Protocol::compress only deflates messages longer than this
+static constexpr size_t COMPRESSION_THRESHOLD = 64;
+
+uint64_t elapsedMicroseconds(std::chrono::steady_clock::time_point since)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - since).count();
+}
+
+}
+
+std::string getBotName(const std::string& namePattern, uint32_t index)
+{
+	std::string name = namePattern;
+	std::string::size_type placeholder = name.find("%u");
+	if (placeholder != std::string::npos) {
+		name.replace(placeholder, 2, std::to_string(index));
+	}
+	return name;
+}
+
+BotClient::BotClient(boost::asio::io_service& io_service, const LoadTestConfig& config, uint32_t index) :
+	config(config), index(index), socket(io_service), strand(io_service), actionTimer(io_service), generator(std::random_device()() ^ index) {}
+
+BotClient::~BotClient()
+{
+	if (zstream) {
+		inflateEnd(zstream.get());
+	}
+}
+
+void BotClient::start()
+{
+	std::uniform_int_distribution<uint32_t> keyPart;
+	for (uint32_t& part : key) {
+		part = keyPart(generator);
+	}
+
+	if (config.loginPort != 0) {
+		state = BOTSTATE_LOGINSERVER;
+		connect(config.loginPort);
+	} else {
+		characterName = getBotName(config.namePattern, index);
+
+		state = BOTSTATE_CHALLENGE;
+		connect(config.gamePort);
+	}
+}
+
+void BotClient::stop()
+{
+	auto self = shared_from_this();
+	strand.post([self]() {
+		if (self->state == BOTSTATE_ONLINE) {
+			g_loadStats.onBotOffline();
+		}
+		self->state = BOTSTATE_CLOSED;
+		self->actionTimer.cancel();
+		self->closeSocket();
+	});
+}
+
+void BotClient::connect(uint16_t port)
+{
+	boost::system::error_code error;
+	boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address::from_string(config.host, error), port);
+	if (error) {
+		fail("invalid host " + config.host);
+		return;
+	}
+
+	socket.async_connect(endpoint, strand.wrap(std::bind(&BotClient::onConnect, shared_from_this(), std::placeholders::_1)));
+}
+
+void BotClient::onConnect(const boost::system::error_code& error)
+{
+	if (state == BOTSTATE_CLOSED) {
+		return;
+	} else if (error) {
+		fail("connect: " + error.message());
+		return;
+	}
+
+	boost::system::error_code ec;
+	socket.set_option(boost::asio::ip::tcp::no_delay(true), ec);
+
+	if (state == BOTSTATE_LOGINSERVER) {
+		sendLoginServerLogin();
+	}
+	readHeader();
+}
+
+void BotClient::readHeader()
+{
+	boost::asio::async_read(socket, boost::asio::buffer(headerBuffer, sizeof(headerBuffer)),
+	                        strand.wrap(std::bind(&BotClient::onReadHeader, shared_from_this(), std::placeholders::_1)));
+}
+
+void BotClient::onReadHeader(const boost::system::error_code& error)
+{
+	if (state == BOTSTATE_CLOSED) {
+		return;
+	} else if (error) {
+		fail(state == BOTSTATE_ONLINE ? "disconnected" : "disconnected during login");
+		return;
+	}
+
+	uint16_t size = headerBuffer[0] | (headerBuffer[1] << 8);
+	if (size == 0) {
+		fail("empty message");
+		return;
+	}
+
+	readBuffer.resize(size);
+	boost::asio::async_read(socket, boost::asio::buffer(readBuffer),
+	                        strand.wrap(std::bind(&BotClient::onReadBody, shared_from_this(), std::placeholders::_1)));
+}
+
+void BotClient::onReadBody(const boost::system::error_code& error)
+{
+	if (state == BOTSTATE_CLOSED) {
+		return;
+	} else if (error) {
+		fail(state == BOTSTATE_ONLINE ? "disconnected" : "disconnected during login");
+		return;
+	}
+
+	g_loadStats.addBytesReceived(readBuffer.size() + sizeof(headerBuffer));
+	if (parseMessage(readBuffer) && state != BOTSTATE_CLOSED) {
+		readHeader();
+	}
+}
+
+void BotClient::fail(const std::string& reason)
+{
+	if (state == BOTSTATE_CLOSED) {
+		return;
+	}
+
+	if (state == BOTSTATE_ONLINE) {
+		g_loadStats.onBotOffline();
+	}
+	g_loadStats.onBotFailed(reason);
+
+	state = BOTSTATE_CLOSED;
+	actionTimer.cancel();
+	closeSocket();
+}
+
+void BotClient::closeSocket()
+{
+	writeQueue.clear();
+
+	boost::system::error_code error;
+	socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, error);
+	socket.close(error);
+}
+
+bool BotClient::parseMessage(std::vector<uint8_t>& data)
+{
+	if (state == BOTSTATE_CHALLENGE) {
+		// the unencrypted challenge of ProtocolGameBase::onConnect, the 7.72
+		// login does not echo it back, it only tells us the server is ready
+		sendGameLogin();
+		return true;
+	}
+
+	if (!decryptMessage(data)) {
+		fail("invalid message");
+		return false;
+	}
+
+	if (state == BOTSTATE_LOGINSERVER) {
+		BotMessage msg(data.data(), data.size());
+		parseLoginServerMessage(msg);
+		return false;
+	}
+
+	if (zstream && !inflateMessage(data)) {
+		fail("invalid compressed message");
+		return false;
+	}
+
+	if (!data.empty() && data[0] == 0x14) {
+		BotMessage msg(data.data(), data.size());
+		std::string message;
+		msg.skipBytes(1);
+		msg.getString(message);
+		fail((state == BOTSTATE_ONLINE ? "kicked: " : "login: ") + message);
+		return false;
+	}
+
+	checkPings(data);
+	return true;
+}
+
+void BotClient::parseLoginServerMessage(BotMessage& msg)
+{
+	uint8_t opcode;
+	while (msg.getByte(opcode)) {
+		switch (opcode) {
+			case 0x0A: {
+				std::string message;
+				msg.getString(message);
+				fail("login server: " + message);
+				return;
+			}
+
+			case 0x14: {
+				std::string motd;
+				if (!msg.getString(motd)) {
+					fail("invalid character list");
+					return;
+				}
+				break;
+			}
+
+			case 0x64: {
+				uint8_t count;
+				if (!msg.getByte(count) || count == 0) {
+					fail("account has no characters");
+					return;
+				}
+
+				std::string world;
+				if (!msg.getString(characterName) || !msg.getString(world)) {
+					fail("invalid character list");
+					return;
+				}
+
+				closeSocket();
+				state = BOTSTATE_CHALLENGE;
+				connect(config.gamePort);
+				return;
+			}
+
+			default:
+				fail("unexpected login server message");
+				return;
+		}
+	}
+
+	fail("invalid character list");
+}
+
+void BotClient::checkPings(const std::vector<uint8_t>& body)
+{
+	for (auto it = pendingPings.begin(); it != pendingPings.end(); ++it) {
+		uint8_t signature[5];
+		signature[0] = 0x40;
+		memcpy(signature + 1, &it->id, sizeof(it->id));
+
+		if (std::search(body.begin(), body.end(), signature, signature + sizeof(signature)) == body.end()) {
+			continue;
+		}
+
+		if (it->op == BOT_OP_LOGIN) {
+			if (state == BOTSTATE_LOGGINGIN) {
+				g_loadStats.addLatency(BOT_OP_LOGIN, elapsedMicroseconds(loginTime));
+				g_loadStats.onBotOnline();
+				state = BOTSTATE_ONLINE;
+
+				// spread the bots over the action interval
+				pendingPings.clear();
+				scheduleAction(std::uniform_int_distribution<uint32_t>(0, config.actionInterval)(generator));
+				return;
+			}
+		} else {
+			g_loadStats.addLatency(it->op, elapsedMicroseconds(it->sentTime));
+		}
+
+		pendingPings.erase(it);
+		return;
+	}
+}
+
+bool BotClient::decryptMessage(std::vector<uint8_t>& data)
+{
+	if (data.size() < 8 || (data.size() % 8) != 0) {
+		return false;
+	}
+
+	xtea::decrypt(data.data(), data.size(), key);
+
+	size_t innerLength = data[0] | (data[1] << 8);
+	if (innerLength > data.size() - 2) {
+		return false;
+	}
+
+	data.erase(data.begin() + 2 + innerLength, data.end());
+	data.erase(data.begin(), data.begin() + 2);
+	return true;
+}
+
+bool BotClient::inflateMessage(std::vector<uint8_t>& data)
+{
+	// Nothing marks a message as compressed. Anything longer than the
+	// threshold must be compressed, shorter messages may be either, those
+	// are inflated on a copy of the stream which is only kept if the result
+	// is longer than the threshold (a raw message can never be).
+	bool ambiguous = data.size() <= COMPRESSION_THRESHOLD;
+
+	std::unique_ptr<z_stream> trial;
+	z_stream* stream = zstream.get();
+	if (ambiguous) {
+		trial.reset(new z_stream());
+		if (inflateCopy(trial.get(), zstream.get()) != Z_OK) {
+			return false;
+		}
+		stream = trial.get();
+	}
+
+	// Protocol::compress strips the trailing sync flush marker
+	static const uint8_t syncFlush[] = {0x00, 0x00, 0xFF, 0xFF};
+	data.insert(data.end(), syncFlush, syncFlush + sizeof(syncFlush));
+
+	static thread_local std::vector<uint8_t> buffer(NETWORKMESSAGE_MAXSIZE);
+	stream->next_in = data.data();
+	stream->avail_in = data.size();
+	stream->next_out = buffer.data();
+	stream->avail_out = buffer.size();
+
+	int ret = inflate(stream, Z_SYNC_FLUSH);
+	size_t size = buffer.size() - stream->avail_out;
+	bool inflated = (ret == Z_OK || ret == Z_BUF_ERROR) && stream->avail_in == 0;
+
+	if (!ambiguous) {
+		if (!inflated) {
+			return false;
+		}
+	} else {
+		inflated = inflated && size > COMPRESSION_THRESHOLD;
+		if (inflated) {
+			inflateEnd(zstream.get());
+			zstream = std::move(trial);
+		} else {
+			inflateEnd(trial.get());
+			data.resize(data.size() - sizeof(syncFlush));
+			return true;
+		}
+	}
+
+	data.assign(buffer.begin(), buffer.begin() + size);
+	return true;
+}
+
+void BotClient::addRSABlock(BotMessage& msg, BotMessage& block)
+{
+	std::vector<uint8_t>& buffer = block.getBuffer();
+	std::uniform_int_distribution<uint16_t> randomByte(0, 0xFF);
+	while (buffer.size() < 128) {
+		buffer.push_back(static_cast<uint8_t>(randomByte(generator)));
+	}
+
+	config.rsa->encrypt(reinterpret_cast<char*>(buffer.data()));
+	msg.getBuffer().insert(msg.getBuffer().end(), buffer.begin(), buffer.begin() + 128);
+}
+
+void BotClient::sendLoginServerLogin()
+{
+	BotMessage block;
+	block.addByte(0x00);
+	for (uint32_t part : key) {
+		block.add<uint32_t>(part);
+	}
+	block.add<uint32_t>(config.accountBase + index);
+	block.addString(config.password);
+	block.addString("OTCv8");
+	block.add<uint16_t>(config.otcv8Version);
+
+	BotMessage msg;
+	msg.addByte(0x01); // protocol id
+	msg.add<uint16_t>(config.clientOS);
+	msg.add<uint16_t>(config.clientVersion);
+	msg.addPadding(12, 0x00); // dat, spr, pic signatures
+	addRSABlock(msg, block);
+
+	loginTime = std::chrono::steady_clock::now();
+
+	std::vector<uint8_t> data;
+	data.push_back(static_cast<uint8_t>(msg.getLength()));
+	data.push_back(static_cast<uint8_t>(msg.getLength() >> 8));
+	data.insert(data.end(), msg.getBuffer().begin(), msg.getBuffer().end());
+	sendRaw(std::move(data));
+}
+
+void BotClient::sendGameLogin()
+{
+	BotMessage block;
+	block.addByte(0x00);
+	for (uint32_t part : key) {
+		block.add<uint32_t>(part);
+	}
+	block.addByte(0x00); // gamemaster flag
+	block.add<uint32_t>(config.accountBase + index);
+	block.addString(characterName);
+	block.addString(config.password);
+	block.addString("OTCv8");
+	block.add<uint16_t>(config.otcv8Version);
+
+	BotMessage msg;
+	msg.addByte(0x0A); // protocol id
+	msg.add<uint16_t>(config.clientOS);
+	msg.add<uint16_t>(config.clientVersion);
+	addRSABlock(msg, block);
+
+	if (config.compression) {
+		zstream.reset(new z_stream());
+		if (inflateInit2(zstream.get(), -15) != Z_OK) {
+			zstream.reset();
+			fail("zlib initialization");
+			return;
+		}
+	}
+
+	// through the login server the login time includes the character list
+	if (config.loginPort == 0) {
+		loginTime = std::chrono::steady_clock::now();
+	}
+	state = BOTSTATE_LOGGINGIN;
+
+	std::vector<uint8_t> data;
+	data.push_back(static_cast<uint8_t>(msg.getLength()));
+	data.push_back(static_cast<uint8_t>(msg.getLength() >> 8));
+	data.insert(data.end(), msg.getBuffer().begin(), msg.getBuffer().end());
+	sendRaw(std::move(data));
+
+	// pings are dropped until the player is in the game, the first answered
+	// one completes the login
+	scheduleAction(LOGIN_PROBE_INTERVAL);
+}
+
+void BotClient::sendPacket(const BotMessage& msg)
+{
+	const std::vector<uint8_t>& body = msg.getBuffer();
+
+	std::vector<uint8_t> data(2);
+	data.reserve(body.size() + 12);
+	data.push_back(static_cast<uint8_t>(body.size()));
+	data.push_back(static_cast<uint8_t>(body.size() >> 8));
+	data.insert(data.end(), body.begin(), body.end());
+
+	size_t length = data.size() - 2;
+	if ((length % 8) != 0) {
+		data.insert(data.end(), 8 - (length % 8), 0x33);
+		length = data.size() - 2;
+	}
+
+	xtea::encrypt(data.data() + 2, length, key);
+	data[0] = static_cast<uint8_t>(length);
+	data[1] = static_cast<uint8_t>(length >> 8);
+	sendRaw(std::move(data));
+}
+
+void BotClient::sendRaw(std::vector<uint8_t> data)
+{
+	g_loadStats.addBytesSent(data.size());
+
+	bool noPendingWrite = writeQueue.empty();
+	writeQueue.emplace_back(std::move(data));
+	if (noPendingWrite) {
+		doWrite();
+	}
+}
+
+void BotClient::doWrite()
+{
+	boost::asio::async_write(socket, boost::asio::buffer(writeQueue.front()),
+	                         strand.wrap(std::bind(&BotClient::onWrite, shared_from_this(), std::placeholders::_1)));
+}
+
+void BotClient::onWrite(const boost::system::error_code& error)
+{
+	if (state == BOTSTATE_CLOSED) {
+		return;
+	} else if (error) {
+		fail("write: " + error.message());
+		return;
+	}
+
+	writeQueue.pop_front();
+	if (!writeQueue.empty()) {
+		doWrite();
+	}
+}
+
+void BotClient::sendPing(BotOp_t op)
+{
+	uint32_t id = std::uniform_int_distribution<uint32_t>()(generator);
+
+	if (pendingPings.size() >= MAX_PENDING_PINGS) {
+		pendingPings.erase(pendingPings.begin());
+	}
+	pendingPings.emplace_back(id, op, std::chrono::steady_clock::now());
+
+	BotMessage msg;
+	msg.addByte(0x40);
+	msg.add<uint32_t>(id);
+	msg.add<uint16_t>(0); // local ping
+	msg.add<uint16_t>(60); // fps
+	sendPacket(msg);
+}
+
+void BotClient::scheduleAction(uint32_t delay)
+{
+	actionTimer.expires_from_now(boost::posix_time::milliseconds(delay));
+	actionTimer.async_wait(strand.wrap(std::bind(&BotClient::onActionTimer, shared_from_this(), std::placeholders::_1)));
+}
+
+void BotClient::onActionTimer(const boost::system::error_code& error)
+{
+	if (error || state == BOTSTATE_CLOSED) {
+		return;
+	}
+
+	if (state == BOTSTATE_LOGGINGIN) {
+		if (elapsedMicroseconds(loginTime) > LOGIN_TIMEOUT * 1000) {
+			fail("login timeout");
+			return;
+		}
+
+		sendPing(BOT_OP_LOGIN);
+		scheduleAction(LOGIN_PROBE_INTERVAL);
+		return;
+	}
+
+	performAction();
+	scheduleAction(config.actionInterval);
+}
+
+void BotClient::performAction()
+{
+	uint32_t totalWeight = config.pingWeight + config.walkWeight + config.talkWeight + config.castWeight + config.moveWeight;
+	if (totalWeight == 0) {
+		sendPing(BOT_OP_PING);
+		return;
+	}
+
+	uint32_t roll = std::uniform_int_distribution<uint32_t>(0, totalWeight - 1)(generator);
+
+	BotMessage msg;
+	BotOp_t op;
+	if (roll < config.pingWeight) {
+		sendPing(BOT_OP_PING);
+		return;
+	} else if ((roll -= config.pingWeight) < config.walkWeight) {
+		op = BOT_OP_WALK;
+		msg.addByte(0x65 + std::uniform_int_distribution<uint16_t>(0, 3)(generator)); // north, east, south, west
+	} else if ((roll -= config.walkWeight) < config.talkWeight) {
+		op = BOT_OP_TALK;
+		msg.addByte(0x96);
+		msg.addByte(0x01); // TALKTYPE_SAY
+		msg.addString("load test message " + std::to_string(index));
+	} else if ((roll -= config.talkWeight) < config.castWeight) {
+		op = BOT_OP_CAST;
+		msg.addByte(0x96);
+		msg.addByte(0x01); // TALKTYPE_SAY
+		msg.addString(config.spellWords);
+	} else {
+		// back and forth between two inventory slots, an empty slot is
+		// answered with a cancel message which is still a full round trip
+		op = BOT_OP_MOVE;
+		uint8_t fromSlot = moveBack ? config.moveToSlot : config.moveFromSlot;
+		uint8_t toSlot = moveBack ? config.moveFromSlot : config.moveToSlot;
+		moveBack = !moveBack;
+
+		msg.addByte(0x78);
+		msg.addPosition(0xFFFF, fromSlot, 0);
+		msg.add<uint16_t>(0); // sprite id, not checked by the server
+		msg.addByte(0x00); // stackpos
+		msg.addPosition(0xFFFF, toSlot, 0);
+		msg.addByte(0x01); // count
+	}
+
+	sendPacket(msg);
+	sendPing(op);
+}
@@ -0,0 +1,155 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef FS_BOTCLIENT_H_6E1B8D3F9A2C4F7E8B0D5A3C1E9F7B2D
+#define FS_BOTCLIENT_H_6E1B8D3F9A2C4F7E8B0D5A3C1E9F7B2D
+
+#include "botmessage.h"
+#include "loadstats.h"
+#include "xtea.h"
+
+#include <boost/asio.hpp>
+#include <zlib.h>
+
+#include <deque>
+#include <random>
+
+class RSA;
+
+struct LoadTestConfig {
+	std::string host = "127.0.0.1";
+	uint16_t loginPort = 0; // 0 skips the login server and goes straight to the game port
+	uint16_t gamePort = 7172;
+
+	uint32_t accountBase = 100000;
+	std::string password = "bot";
+	std::string namePattern = "Bot %u"; // %u is replaced by the bot index
+
+	uint16_t clientOS = 20; // CLIENTOS_OTCLIENTV8_LINUX
+	uint16_t clientVersion = 772;
+	uint16_t otcv8Version = 260;
+	bool compression = true; // matches packetCompression in config.lua
+
+	uint32_t actionInterval = 1000; // milliseconds
+	uint32_t pingWeight = 10;
+	uint32_t walkWeight = 50;
+	uint32_t talkWeight = 20;
+	uint32_t castWeight = 10;
+	uint32_t moveWeight = 20;
+	std::string spellWords = "utevo lux";
+	uint8_t moveFromSlot = 10; // CONST_SLOT_AMMO
+	uint8_t moveToSlot = 6; // CONST_SLOT_LEFT
+
+	const RSA* rsa = nullptr;
+};
+
+// the character name of bot index, namePattern with %u replaced
+std::string getBotName(const std::string& namePattern, uint32_t index);
+
+// One simulated client. Logs in (optionally through the login server),
+// then performs a weighted random action every actionInterval. Each action
+// is followed by an OTCv8 ping (0x40) with a random id, the ping reply is
+// only queued after the action has been processed by the dispatcher so the
+// time until it arrives is the round trip latency of that action.
+// All handlers of a bot run on its strand.
+class BotClient : public std::enable_shared_from_this<BotClient>
+{
+	public:
+		BotClient(boost::asio::io_service& io_service, const LoadTestConfig& config, uint32_t index);
+		~BotClient();
+
+		// non-copyable
+		BotClient(const BotClient&) = delete;
+		BotClient& operator=(const BotClient&) = delete;
+
+		void start();
+		void stop();
+
+	private:
+		enum BotState_t {
+			BOTSTATE_LOGINSERVER,
+			BOTSTATE_CHALLENGE,
+			BOTSTATE_LOGGINGIN,
+			BOTSTATE_ONLINE,
+			BOTSTATE_CLOSED,
+		};
+
+		struct PendingPing {
+			PendingPing(uint32_t id, BotOp_t op, std::chrono::steady_clock::time_point sentTime) : id(id), op(op), sentTime(sentTime) {}
+
+			uint32_t id;
+			BotOp_t op;
+			std::chrono::steady_clock::time_point sentTime;
+		};
+
+		void connect(uint16_t port);
+		void onConnect(const boost::system::error_code& error);
+		void readHeader();
+		void onReadHeader(const boost::system::error_code& error);
+		void onReadBody(const boost::system::error_code& error);
+		void fail(const std::string& reason);
+		void closeSocket();
+
+		bool parseMessage(std::vector<uint8_t>& data);
+		void parseLoginServerMessage(BotMessage& msg);
+		void checkPings(const std::vector<uint8_t>& body);
+
+		bool decryptMessage(std::vector<uint8_t>& data);
+		bool inflateMessage(std::vector<uint8_t>& data);
+
+		void sendLoginServerLogin();
+		void sendGameLogin();
+		void sendPacket(const BotMessage& msg);
+		void sendRaw(std::vector<uint8_t> data);
+		void doWrite();
+		void onWrite(const boost::system::error_code& error);
+
+		void sendPing(BotOp_t op);
+		void scheduleAction(uint32_t delay);
+		void onActionTimer(const boost::system::error_code& error);
+		void performAction();
+
+		void addRSABlock(BotMessage& msg, BotMessage& block);
+
+		const LoadTestConfig& config;
+		const uint32_t index;
+
+		boost::asio::ip::tcp::socket socket;
+		boost::asio::io_service::strand strand;
+		boost::asio::deadline_timer actionTimer;
+
+		std::mt19937 generator;
+		xtea::key key;
+		std::string characterName;
+
+		uint8_t headerBuffer[2];
+		std::vector<uint8_t> readBuffer;
+		std::deque<std::vector<uint8_t>> writeQueue;
+
+		std::vector<PendingPing> pendingPings;
+		std::chrono::steady_clock::time_point loginTime;
+
+		// server side packetCompression, a raw deflate stream over the whole connection
+		std::unique_ptr<z_stream> zstream;
+		bool moveBack = false;
+
+		BotState_t state = BOTSTATE_CLOSED;
+};
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef FS_BOTMESSAGE_H_9D2F6B1A4C7E4A3B8E5F0A2C6D9B1E7F
+#define FS_BOTMESSAGE_H_9D2F6B1A4C7E4A3B8E5F0A2C6D9B1E7F
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Client side counterpart of NetworkMessage: a growing buffer for the
+// packets a bot sends and a bounds checked reader for what it receives.
+// Multi-byte values are little endian, like the server expects.
+class BotMessage
+{
+	public:
+		BotMessage() = default;
+		BotMessage(const uint8_t* data, size_t size) : buffer(data, data + size) {}
+
+		void addByte(uint8_t value) {
+			buffer.push_back(value);
+		}
+
+		template<typename T>
+		void add(T value) {
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+			buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+		}
+
+		void addString(const std::string& value) {
+			add<uint16_t>(static_cast<uint16_t>(value.size()));
+			buffer.insert(buffer.end(), value.begin(), value.end());
+		}
+
+		void addPosition(uint16_t x, uint16_t y, uint8_t z) {
+			add<uint16_t>(x);
+			add<uint16_t>(y);
+			addByte(z);
+		}
+
+		void addPadding(size_t count, uint8_t value = 0x33) {
+			buffer.insert(buffer.end(), count, value);
+		}
+
+		bool getByte(uint8_t& value) {
+			return get<uint8_t>(value);
+		}
+
+		template<typename T>
+		bool get(T& value) {
+			if (position + sizeof(T) > buffer.size()) {
+				return false;
+			}
+
+			memcpy(&value, buffer.data() + position, sizeof(T));
+			position += sizeof(T);
+			return true;
+		}
+
+		bool getString(std::string& value) {
+			uint16_t length;
+			if (!get<uint16_t>(length) || position + length > buffer.size()) {
+				return false;
+			}
+
+			value.assign(reinterpret_cast<const char*>(buffer.data() + position), length);
+			position += length;
+			return true;
+		}
+
+		bool skipBytes(size_t count) {
+			if (position + count > buffer.size()) {
+				return false;
+			}
+			position += count;
+			return true;
+		}
+
+		std::vector<uint8_t>& getBuffer() {
+			return buffer;
+		}
+		const std::vector<uint8_t>& getBuffer() const {
+			return buffer;
+		}
+
+		size_t getLength() const {
+			return buffer.size();
+		}
+
+	private:
+		std::vector<uint8_t> buffer;
+		size_t position = 0;
+};
+
+#endif
@@ -0,0 +1,168 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "otpch.h"
+
+#include "loadstats.h"
+
+LoadStats g_loadStats;
+
+namespace {
+
+std::string jsonEscape(const std::string& value)
+{
+	std::ostringstream ss;
+	for (char c : value) {
+		switch (c) {
+			case '"': ss << "\\\""; break;
+			case '\\': ss << "\\\\"; break;
+			case '\n': ss << "\\n"; break;
+			default:
+				if (static_cast<uint8_t>(c) < 0x20) {
+					ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+				} else {
+					ss << c;
+				}
+				break;
+		}
+	}
+	return ss.str();
+}
+
+}
+
+const char* getBotOpName(BotOp_t op)
+{
+	switch (op) {
+		case BOT_OP_LOGIN: return "login";
+		case BOT_OP_PING: return "ping";
+		case BOT_OP_WALK: return "walk";
+		case BOT_OP_TALK: return "talk";
+		case BOT_OP_CAST: return "cast";
+		case BOT_OP_MOVE: return "move";
+		default: return "unknown";
+	}
+}
+
+void LoadStats::addLatency(BotOp_t op, uint64_t latency)
+{
+	std::lock_guard<std::mutex> lockGuard(statsLock);
+	latencies[op].push_back(static_cast<uint32_t>(std::min<uint64_t>(latency, std::numeric_limits<uint32_t>::max())));
+}
+
+void LoadStats::onBotFailed(const std::string& reason)
+{
+	std::lock_guard<std::mutex> lockGuard(statsLock);
+	++failed;
+	++failures[reason];
+}
+
+LoadStats::Summary LoadStats::summarize(std::vector<uint32_t> samples)
+{
+	Summary summary;
+	if (samples.empty()) {
+		return summary;
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	uint64_t total = 0;
+	for (uint32_t sample : samples) {
+		total += sample;
+	}
+
+	auto percentile = [&samples](double fraction) {
+		size_t index = static_cast<size_t>(std::ceil(samples.size() * fraction));
+		return static_cast<uint64_t>(samples[std::min(samples.size(), std::max<size_t>(index, 1)) - 1]);
+	};
+
+	summary.count = samples.size();
+	summary.avg = total / samples.size();
+	summary.p50 = percentile(0.5);
+	summary.p95 = percentile(0.95);
+	summary.p99 = percentile(0.99);
+	summary.max = samples.back();
+	return summary;
+}
+
+std::string LoadStats::getProgressLine(uint32_t elapsed)
+{
+	std::lock_guard<std::mutex> lockGuard(statsLock);
+
+	uint32_t seconds = std::max<uint32_t>(1, elapsed - lastElapsed);
+	uint64_t sent = bytesSent.load(std::memory_order_relaxed);
+	uint64_t received = bytesReceived.load(std::memory_order_relaxed);
+
+	std::ostringstream ss;
+	ss << '[' << elapsed << "s] " << online << " online, " << failed << " failed, in "
+	   << ((received - lastBytesReceived) / seconds / 1024) << " kB/s, out " << ((sent - lastBytesSent) / seconds / 1024) << " kB/s";
+
+	for (size_t op = BOT_OP_PING; op < BOT_OP_LAST; ++op) {
+		const std::vector<uint32_t>& samples = latencies[op];
+		if (samples.size() == lastReported[op]) {
+			continue;
+		}
+
+		Summary summary = summarize(std::vector<uint32_t>(samples.begin() + lastReported[op], samples.end()));
+		ss << ", " << getBotOpName(static_cast<BotOp_t>(op)) << " p50 " << (summary.p50 / 1000.) << " p99 " << (summary.p99 / 1000.) << " ms";
+		lastReported[op] = samples.size();
+	}
+
+	lastBytesSent = sent;
+	lastBytesReceived = received;
+	lastElapsed = elapsed;
+	return ss.str();
+}
+
+void LoadStats::writeReport(std::ostream& os, uint32_t bots, uint32_t elapsed) const
+{
+	std::lock_guard<std::mutex> lockGuard(statsLock);
+
+	uint32_t seconds = std::max<uint32_t>(1, elapsed);
+	uint64_t sent = bytesSent.load(std::memory_order_relaxed);
+	uint64_t received = bytesReceived.load(std::memory_order_relaxed);
+
+	os << "{\n";
+	os << "  \"bots\": " << bots << ",\n";
+	os << "  \"online\": " << online << ",\n";
+	os << "  \"failed\": " << failed << ",\n";
+	os << "  \"duration\": " << elapsed << ",\n";
+	os << "  \"bytesSent\": " << sent << ",\n";
+	os << "  \"bytesReceived\": " << received << ",\n";
+	os << "  \"bytesSentPerSecond\": " << (sent / seconds) << ",\n";
+	os << "  \"bytesReceivedPerSecond\": " << (received / seconds) << ",\n";
+
+	os << "  \"failures\": {";
+	for (auto it = failures.begin(); it != failures.end(); ++it) {
+		os << (it == failures.begin() ? "\n" : ",\n") << "    \"" << jsonEscape(it->first) << "\": " << it->second;
+	}
+	os << (failures.empty() ? "},\n" : "\n  },\n");
+
+	// latencies in microseconds, ping is the round trip through the dispatcher
+	// queue with no work attached and stands in for the server tick time
+	os << "  \"latency\": {";
+	for (size_t op = 0; op < BOT_OP_LAST; ++op) {
+		Summary summary = summarize(latencies[op]);
+		os << (op == 0 ? "\n" : ",\n") << "    \"" << getBotOpName(static_cast<BotOp_t>(op)) << "\": {\"count\": " << summary.count
+		   << ", \"avg\": " << summary.avg << ", \"p50\": " << summary.p50 << ", \"p95\": " << summary.p95
+		   << ", \"p99\": " << summary.p99 << ", \"max\": " << summary.max << '}';
+	}
+	os << "\n  }\n";
+	os << "}\n";
+}
@@ -0,0 +1,111 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef FS_LOADSTATS_H_3A7C9E1F5B2D4C8A9F6E0B3D7A1C5E9F
+#define FS_LOADSTATS_H_3A7C9E1F5B2D4C8A9F6E0B3D7A1C5E9F
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum BotOp_t : uint8_t {
+	BOT_OP_LOGIN,
+	BOT_OP_PING,
+	BOT_OP_WALK,
+	BOT_OP_TALK,
+	BOT_OP_CAST,
+	BOT_OP_MOVE,
+
+	BOT_OP_LAST
+};
+
+const char* getBotOpName(BotOp_t op);
+
+// Latencies and traffic of all bots. Latencies are kept as raw samples
+// (microseconds) so the report has exact percentiles; at one action per
+// bot and second that is a few MB per thousand bots and hour.
+class LoadStats
+{
+	public:
+		LoadStats() = default;
+
+		// non-copyable
+		LoadStats(const LoadStats&) = delete;
+		LoadStats& operator=(const LoadStats&) = delete;
+
+		void addLatency(BotOp_t op, uint64_t latency);
+
+		void addBytesSent(size_t bytes) {
+			bytesSent.fetch_add(bytes, std::memory_order_relaxed);
+		}
+		void addBytesReceived(size_t bytes) {
+			bytesReceived.fetch_add(bytes, std::memory_order_relaxed);
+		}
+
+		void onBotOnline() {
+			++online;
+		}
+		void onBotOffline() {
+			--online;
+		}
+		void onBotFailed(const std::string& reason);
+
+		uint32_t getOnline() const {
+			return online;
+		}
+
+		// one line covering the time since the previous call
+		std::string getProgressLine(uint32_t elapsed);
+
+		void writeReport(std::ostream& os, uint32_t bots, uint32_t elapsed) const;
+
+	private:
+		struct Summary {
+			size_t count = 0;
+			uint64_t avg = 0;
+			uint64_t p50 = 0;
+			uint64_t p95 = 0;
+			uint64_t p99 = 0;
+			uint64_t max = 0;
+		};
+
+		static Summary summarize(std::vector<uint32_t> samples);
+
+		mutable std::mutex statsLock;
+		std::array<std::vector<uint32_t>, BOT_OP_LAST> latencies;
+		std::array<size_t, BOT_OP_LAST> lastReported = {};
+		std::map<std::string, uint32_t> failures;
+
+		std::atomic<uint64_t> bytesSent {0};
+		std::atomic<uint64_t> bytesReceived {0};
+		uint64_t lastBytesSent = 0;
+		uint64_t lastBytesReceived = 0;
+		uint32_t lastElapsed = 0;
+
+		std::atomic<uint32_t> online {0};
+		uint32_t failed = 0;
+};
+
+extern LoadStats g_loadStats;
+
+#endif
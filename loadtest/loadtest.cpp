@@ -0,0 +1,274 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "otpch.h"
+
+#include "botclient.h"
+#include "rsa.h"
+
+#include <csignal>
+#include <fstream>
+#include <thread>
+
+namespace {
+
+struct LoadTestOptions {
+	LoadTestConfig config;
+
+	uint32_t bots = 100;
+	uint32_t rampRate = 50; // bots started per second
+	uint32_t duration = 60; // seconds, counted from the first bot
+	uint32_t reportInterval = 10; // seconds
+	uint32_t threads = 0;
+	std::string keyFile = "key.pem";
+	std::string output;
+	bool printSql = false;
+};
+
+std::atomic<bool> interrupted {false};
+
+void printUsage()
+{
+	std::cout << "Usage: tfs_loadtest [options]" << std::endl;
+	std::cout << "  --host=127.0.0.1          server address" << std::endl;
+	std::cout << "  --game-port=7172          gameProtocolPort" << std::endl;
+	std::cout << "  --login-port=0            loginProtocolPort, 0 logs in to the game port directly" << std::endl;
+	std::cout << "  --bots=100                number of bots" << std::endl;
+	std::cout << "  --ramp=50                 bots started per second" << std::endl;
+	std::cout << "  --duration=60             seconds to run" << std::endl;
+	std::cout << "  --interval=1000           milliseconds between bot actions" << std::endl;
+	std::cout << "  --weights=10,50,20,10,20  ping, walk, talk, cast, move weights" << std::endl;
+	std::cout << "  --spell=\"utevo lux\"       words said by the cast action" << std::endl;
+	std::cout << "  --account-base=100000     bot n uses account number base + n" << std::endl;
+	std::cout << "  --password=bot            password of all bot accounts" << std::endl;
+	std::cout << "  --name=\"Bot %u\"           character name pattern without --login-port" << std::endl;
+	std::cout << "  --version=772             client version" << std::endl;
+	std::cout << "  --compression=1           0 if packetCompression is disabled on the server" << std::endl;
+	std::cout << "  --key=key.pem             the server's RSA key" << std::endl;
+	std::cout << "  --threads=0               network threads, 0 for one per core" << std::endl;
+	std::cout << "  --report-interval=10      seconds between progress lines" << std::endl;
+	std::cout << "  --output=<file>           write the JSON report to a file instead of stdout" << std::endl;
+	std::cout << "  --print-sql               print the SQL creating the bot accounts and exit" << std::endl;
+}
+
+bool parseWeights(const std::string& value, LoadTestConfig& config)
+{
+	std::vector<uint32_t> weights;
+	std::istringstream ss(value);
+	for (std::string token; std::getline(ss, token, ',');) {
+		if (token.empty() || token.find_first_not_of("0123456789") != std::string::npos) {
+			return false;
+		}
+		weights.push_back(static_cast<uint32_t>(std::stoul(token)));
+	}
+
+	if (weights.size() != 5) {
+		return false;
+	}
+
+	config.pingWeight = weights[0];
+	config.walkWeight = weights[1];
+	config.talkWeight = weights[2];
+	config.castWeight = weights[3];
+	config.moveWeight = weights[4];
+	return true;
+}
+
+bool parseOptions(int argc, char* argv[], LoadTestOptions& options)
+{
+	LoadTestConfig& config = options.config;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--print-sql") {
+			options.printSql = true;
+			continue;
+		}
+
+		std::string::size_type separator = arg.find('=');
+		if (arg.compare(0, 2, "--") != 0 || separator == std::string::npos) {
+			std::cout << "> ERROR: Unrecognized argument " << arg << std::endl;
+			return false;
+		}
+
+		std::string key = arg.substr(2, separator - 2);
+		std::string value = arg.substr(separator + 1);
+		uint32_t number = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+
+		if (key == "host") {
+			config.host = value;
+		} else if (key == "game-port") {
+			config.gamePort = static_cast<uint16_t>(number);
+		} else if (key == "login-port") {
+			config.loginPort = static_cast<uint16_t>(number);
+		} else if (key == "bots") {
+			options.bots = number;
+		} else if (key == "ramp") {
+			options.rampRate = std::max<uint32_t>(1, number);
+		} else if (key == "duration") {
+			options.duration = number;
+		} else if (key == "interval") {
+			config.actionInterval = std::max<uint32_t>(50, number);
+		} else if (key == "weights") {
+			if (!parseWeights(value, config)) {
+				std::cout << "> ERROR: --weights takes five non-negative numbers." << std::endl;
+				return false;
+			}
+		} else if (key == "spell") {
+			config.spellWords = value;
+		} else if (key == "account-base") {
+			config.accountBase = number;
+		} else if (key == "password") {
+			config.password = value;
+		} else if (key == "name") {
+			// %u is replaced, the pattern is not a format string
+			std::string::size_type placeholder = value.find('%');
+			if (placeholder == std::string::npos || value.compare(placeholder, 2, "%u") != 0 || value.find('%', placeholder + 1) != std::string::npos) {
+				std::cout << "> ERROR: --name takes a pattern with exactly one %u and no other %." << std::endl;
+				return false;
+			}
+			config.namePattern = value;
+		} else if (key == "version") {
+			config.clientVersion = static_cast<uint16_t>(number);
+		} else if (key == "compression") {
+			config.compression = number != 0;
+		} else if (key == "key") {
+			options.keyFile = value;
+		} else if (key == "threads") {
+			options.threads = number;
+		} else if (key == "report-interval") {
+			options.reportInterval = std::max<uint32_t>(1, number);
+		} else if (key == "output") {
+			options.output = value;
+		} else {
+			std::cout << "> ERROR: Unrecognized argument " << arg << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+// Accounts and characters for the bots, players are created with the
+// schema defaults and log in at the temple of town 1
+void printSql(const LoadTestOptions& options)
+{
+	const LoadTestConfig& config = options.config;
+	for (uint32_t i = 0; i < options.bots; ++i) {
+		std::string name = getBotName(config.namePattern, i);
+
+		uint32_t accountNumber = config.accountBase + i;
+		std::cout << "INSERT INTO `accounts` (`name`, `password`) VALUES ('" << accountNumber << "', SHA1('" << config.password << "'));" << std::endl;
+		std::cout << "INSERT INTO `players` (`name`, `account_id`, `conditions`) SELECT '" << name << "', `id`, '' FROM `accounts` WHERE `name` = '" << accountNumber << "';" << std::endl;
+	}
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+	LoadTestOptions options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage();
+		return 1;
+	}
+
+	if (options.printSql) {
+		printSql(options);
+		return 0;
+	}
+
+	RSA rsa;
+	try {
+		rsa.loadPEM(options.keyFile);
+	} catch (const std::exception& e) {
+		std::cout << "> ERROR: " << e.what() << std::endl;
+		return 1;
+	}
+	options.config.rsa = &rsa;
+
+	std::signal(SIGINT, [](int) { interrupted = true; });
+
+	boost::asio::io_service io_service;
+	std::unique_ptr<boost::asio::io_service::work> work(new boost::asio::io_service::work(io_service));
+
+	uint32_t threadCount = options.threads != 0 ? options.threads : std::max<uint32_t>(1, std::thread::hardware_concurrency());
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < threadCount; ++i) {
+		threads.emplace_back([&io_service]() { io_service.run(); });
+	}
+
+	std::cout << ">> Starting " << options.bots << " bots against " << options.config.host << ':'
+	          << (options.config.loginPort != 0 ? options.config.loginPort : options.config.gamePort) << " on " << threadCount << " threads" << std::endl;
+
+	std::vector<std::shared_ptr<BotClient>> bots;
+	bots.reserve(options.bots);
+
+	auto startTime = std::chrono::steady_clock::now();
+	auto nextReport = startTime + std::chrono::seconds(options.reportInterval);
+	auto endTime = startTime + std::chrono::seconds(options.duration);
+
+	while (!interrupted) {
+		auto now = std::chrono::steady_clock::now();
+		if (now >= endTime) {
+			break;
+		}
+
+		// ramp up, rampRate bots per second
+		uint64_t due = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime).count()) * options.rampRate / 1000 + 1;
+		while (bots.size() < options.bots && bots.size() < due) {
+			bots.emplace_back(std::make_shared<BotClient>(io_service, options.config, static_cast<uint32_t>(bots.size())));
+			bots.back()->start();
+		}
+
+		if (now >= nextReport) {
+			uint32_t elapsed = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(now - startTime).count());
+			std::cout << g_loadStats.getProgressLine(elapsed) << std::endl;
+			nextReport += std::chrono::seconds(options.reportInterval);
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+
+	uint32_t elapsed = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - startTime).count());
+
+	// the report is taken before the bots disconnect so "online" is meaningful
+	std::ostringstream report;
+	g_loadStats.writeReport(report, options.bots, elapsed);
+
+	for (const auto& bot : bots) {
+		bot->stop();
+	}
+
+	work.reset();
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	if (!options.output.empty()) {
+		std::ofstream file(options.output);
+		if (!file.is_open()) {
+			std::cout << "> ERROR: Can not write to " << options.output << std::endl;
+			return 1;
+		}
+		file << report.str();
+		std::cout << ">> Report written to " << options.output << std::endl;
+	} else {
+		std::cout << report.str();
+	}
+	return 0;
+}
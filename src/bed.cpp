@@ -41,11 +41,10 @@ Attr_ReadValue BedItem::readAttr(AttrTypes_t attr, PropStream& propStream)
 			}
 
 			if (guid != 0) {
-				std::string name = IOLoginData::getNameByGuid(guid);
-				if (!name.empty()) {
-					setSpecialDescription(name + " is sleeping there.");
-					g_game.setBedSleeper(this, guid);
+				if (isRegistrationDeferred()) {
 					sleeperGUID = guid;
+				} else {
+					loadSleeper(guid);
 				}
 			}
 			return ATTR_READ_CONTINUE;
@@ -67,6 +66,27 @@ Attr_ReadValue BedItem::readAttr(AttrTypes_t attr, PropStream& propStream)
 	return Item::readAttr(attr, propStream);
 }
 
+void BedItem::registerDeferred()
+{
+	Item::registerDeferred();
+
+	uint32_t guid = sleeperGUID;
+	if (guid != 0) {
+		sleeperGUID = 0;
+		loadSleeper(guid);
+	}
+}
+
+void BedItem::loadSleeper(uint32_t guid)
+{
+	std::string name = IOLoginData::getNameByGuid(guid);
+	if (!name.empty()) {
+		setSpecialDescription(name + " is sleeping there.");
+		g_game.setBedSleeper(this, guid);
+		sleeperGUID = guid;
+	}
+}
+
 void BedItem::serializeAttr(PropWriteStream& propWriteStream) const
 {
 	if (sleeperGUID != 0) {
@@ -161,7 +181,7 @@ bool BedItem::sleep(Player* player)
 
 	// kick player after he sees himself walk onto the bed and it change id
 	uint32_t playerId = player->getID();
-	g_scheduler.addEvent(createSchedulerTask(SCHEDULER_MINTICKS, std::bind(&Game::kickPlayer, &g_game, playerId, false)));
+	g_scheduler.addEvent(createSchedulerTask(SCHEDULER_MINTICKS, std::bind(&Game::kickPlayer, &g_game, playerId, false), "Game::kickPlayer"));
 
 	// change self and partner's appearance
 	updateAppearance(player);
@@ -39,6 +39,7 @@ class BedItem final : public Item
 
 		Attr_ReadValue readAttr(AttrTypes_t attr, PropStream& propStream) override;
 		void serializeAttr(PropWriteStream& propWriteStream) const override;
+		void registerDeferred() override;
 
 		bool canRemove() const override {
 			return house == nullptr;
@@ -61,6 +62,7 @@ class BedItem final : public Item
 		BedItem* getNextBedItem() const;
 
 	private:
+		void loadSleeper(uint32_t guid);
 		void updateAppearance(const Player* player);
 		void regeneratePlayer(Player* player) const;
 		void internalSetSleeper(const Player* player);
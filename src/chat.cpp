@@ -55,8 +55,8 @@ void PrivateChatChannel::invitePlayer(const Player& player, Player& invitePlayer
 	ss << invitePlayer.getName() << " has been invited.";
 	player.sendTextMessage(MESSAGE_INFO_DESCR, ss.str());
 
-	for (const auto& it : users) {
-		it.second->sendChannelEvent(id, invitePlayer.getName(), CHANNELEVENT_INVITE);
+	for (Player* user : users) {
+		user->sendChannelEvent(id, invitePlayer.getName(), CHANNELEVENT_INVITE);
 	}
 }
 
@@ -74,21 +74,21 @@ void PrivateChatChannel::excludePlayer(const Player& player, Player& excludePlay
 
 	excludePlayer.sendClosePrivate(id);
 
-	for (const auto& it : users) {
-		it.second->sendChannelEvent(id, excludePlayer.getName(), CHANNELEVENT_EXCLUDE);
+	for (Player* user : users) {
+		user->sendChannelEvent(id, excludePlayer.getName(), CHANNELEVENT_EXCLUDE);
 	}
 }
 
 void PrivateChatChannel::closeChannel() const
 {
-	for (const auto& it : users) {
-		it.second->sendClosePrivate(id);
+	for (Player* user : users) {
+		user->sendClosePrivate(id);
 	}
 }
 
 bool ChatChannel::addUser(Player& player)
 {
-	if (users.find(player.getID()) != users.end()) {
+	if (hasUser(player)) {
 		return false;
 	}
 
@@ -100,32 +100,34 @@ bool ChatChannel::addUser(Player& player)
 	if (id == CHANNEL_GUILD) {
 		Guild* guild = player.getGuild();
 		if (guild && !guild->getMotd().empty()) {
-			g_scheduler.addEvent(createSchedulerTask(150, std::bind(&Game::sendGuildMotd, &g_game, player.getID())));
+			g_scheduler.addEvent(createSchedulerTask(150, std::bind(&Game::sendGuildMotd, &g_game, player.getID()), "Game::sendGuildMotd"));
 		}
 	}
 
 	if (!publicChannel) {
-		for (const auto& it : users) {
-			it.second->sendChannelEvent(id, player.getName(), CHANNELEVENT_JOIN);
+		for (Player* user : users) {
+			user->sendChannelEvent(id, player.getName(), CHANNELEVENT_JOIN);
 		}
 	}
 
-	users[player.getID()] = &player;
+	users.push_back(&player);
+	g_chat->indexUser(player, this);
 	return true;
 }
 
 bool ChatChannel::removeUser(const Player& player)
 {
-	auto iter = users.find(player.getID());
+	auto iter = std::find(users.begin(), users.end(), &player);
 	if (iter == users.end()) {
 		return false;
 	}
 
 	users.erase(iter);
+	g_chat->unindexUser(player, this);
 
 	if (!publicChannel) {
-		for (const auto& it : users) {
-			it.second->sendChannelEvent(id, player.getName(), CHANNELEVENT_LEAVE);
+		for (Player* user : users) {
+			user->sendChannelEvent(id, player.getName(), CHANNELEVENT_LEAVE);
 		}
 	}
 
@@ -133,25 +135,31 @@ bool ChatChannel::removeUser(const Player& player)
 	return true;
 }
 
-bool ChatChannel::hasUser(const Player& player) {
-	return users.find(player.getID()) != users.end();
+bool ChatChannel::hasUser(const Player& player) const
+{
+	return std::find(users.begin(), users.end(), &player) != users.end();
 }
 
 void ChatChannel::sendToAll(const std::string& message, SpeakClasses type) const
 {
-	for (const auto& it : users) {
-		it.second->sendChannelMessage("", message, type, id);
+	NetworkMessage msg;
+	ProtocolGameBase::AddChannelMessage(msg, "", message, type, id);
+	for (Player* user : users) {
+		user->sendBroadcast(msg);
 	}
 }
 
 bool ChatChannel::talk(const Player& fromPlayer, SpeakClasses type, const std::string& text)
 {
-	if (users.find(fromPlayer.getID()) == users.end()) {
+	if (!hasUser(fromPlayer)) {
 		return false;
 	}
 
-	for (const auto& it : users) {
-		it.second->sendToChannel(&fromPlayer, type, text, id);
+	// encoded once, every listener gets the same bytes
+	NetworkMessage msg;
+	ProtocolGameBase::AddToChannel(msg, &fromPlayer, type, text, id);
+	for (Player* user : users) {
+		user->sendBroadcast(msg);
 	}
 	return true;
 }
@@ -317,9 +325,11 @@ bool Chat::load()
 				}
 			}
 
-			UsersMap tempUserMap = std::move(channel.users);
-			for (const auto& pair : tempUserMap) {
-				channel.addUser(*pair.second);
+			unindexChannel(&channel);
+			UsersVector tempUsers = std::move(channel.users);
+			channel.users.clear();
+			for (Player* user : tempUsers) {
+				channel.addUser(*user);
 			}
 			continue;
 		}
@@ -406,6 +416,7 @@ bool Chat::deleteChannel(const Player& player, uint16_t channelId)
 				return false;
 			}
 
+			unindexChannel(&it->second);
 			guildChannels.erase(it);
 			break;
 		}
@@ -421,6 +432,7 @@ bool Chat::deleteChannel(const Player& player, uint16_t channelId)
 				return false;
 			}
 
+			unindexChannel(&it->second);
 			partyChannels.erase(it);
 			break;
 		}
@@ -433,6 +445,7 @@ bool Chat::deleteChannel(const Player& player, uint16_t channelId)
 
 			it->second.closeChannel();
 
+			unindexChannel(&it->second);
 			privateChannels.erase(it);
 			break;
 		}
@@ -464,25 +477,23 @@ bool Chat::removeUserFromChannel(const Player& player, uint16_t channelId)
 
 void Chat::removeUserFromAllChannels(const Player& player)
 {
-	for (auto& it : normalChannels) {
-		it.second.removeUser(player);
-	}
-
-	for (auto& it : partyChannels) {
-		it.second.removeUser(player);
-	}
-
-	for (auto& it : guildChannels) {
-		it.second.removeUser(player);
+	auto userIt = userChannels.find(player.getID());
+	if (userIt != userChannels.end()) {
+		// removeUser takes the channel out of the list
+		const std::vector<ChatChannel*> channels = userIt->second;
+		for (ChatChannel* channel : channels) {
+			channel->removeUser(player);
+		}
 	}
 
+	// invites are kept by guid and do not need the player to have joined
 	auto it = privateChannels.begin();
 	while (it != privateChannels.end()) {
 		PrivateChatChannel* channel = &it->second;
 		channel->removeInvite(player.getGUID());
-		channel->removeUser(player);
 		if (channel->getOwner() == player.getGUID()) {
 			channel->closeChannel();
+			unindexChannel(channel);
 			it = privateChannels.erase(it);
 		} else {
 			++it;
@@ -490,6 +501,32 @@ void Chat::removeUserFromAllChannels(const Player& player)
 	}
 }
 
+void Chat::indexUser(const Player& player, ChatChannel* channel)
+{
+	userChannels[player.getID()].push_back(channel);
+}
+
+void Chat::unindexUser(const Player& player, ChatChannel* channel)
+{
+	auto it = userChannels.find(player.getID());
+	if (it == userChannels.end()) {
+		return;
+	}
+
+	std::vector<ChatChannel*>& channels = it->second;
+	channels.erase(std::remove(channels.begin(), channels.end(), channel), channels.end());
+	if (channels.empty()) {
+		userChannels.erase(it);
+	}
+}
+
+void Chat::unindexChannel(ChatChannel* channel)
+{
+	for (Player* user : channel->users) {
+		unindexUser(*user, channel);
+	}
+}
+
 bool Chat::talkToChannel(const Player& player, SpeakClasses type, const std::string& text, uint16_t channelId)
 {
 	ChatChannel* channel = getChannel(player, channelId);
@@ -26,7 +26,7 @@
 class Party;
 class Player;
 
-using UsersMap = std::map<uint32_t, Player*>;
+using UsersVector = std::vector<Player*>;
 using InvitedMap = std::map<uint32_t, const Player*>;
 
 class ChatChannel
@@ -40,7 +40,7 @@ class ChatChannel
 
 		bool addUser(Player& player);
 		bool removeUser(const Player& player);
-		bool hasUser(const Player& player);
+		bool hasUser(const Player& player) const;
 
 		bool talk(const Player& fromPlayer, SpeakClasses type, const std::string& text);
 		void sendToAll(const std::string& message, SpeakClasses type) const;
@@ -51,7 +51,7 @@ class ChatChannel
 		uint16_t getId() const {
 			return id;
 		}
-		const UsersMap& getUsers() const {
+		const UsersVector& getUsers() const {
 			return users;
 		}
 		virtual const InvitedMap* getInvitedUsers() const {
@@ -70,7 +70,9 @@ class ChatChannel
 		bool executeOnSpeakEvent(const Player& player, SpeakClasses& type, const std::string& message);
 
 	protected:
-		UsersMap users;
+		// in join order, a message goes to all of them so lookups by id are
+		// rare enough for a linear search
+		UsersVector users;
 
 		uint16_t id;
 
@@ -159,6 +161,16 @@ class Chat
 		LuaScriptInterface scriptInterface;
 
 		PrivateChatChannel dummyPrivate;
+
+		// the channels every player has joined, keyed by player id, so a
+		// logout does not have to look through all of them
+		std::unordered_map<uint32_t, std::vector<ChatChannel*>> userChannels;
+
+		void indexUser(const Player& player, ChatChannel* channel);
+		void unindexUser(const Player& player, ChatChannel* channel);
+		void unindexChannel(ChatChannel* channel);
+
+		friend class ChatChannel;
 };
 
 #endif
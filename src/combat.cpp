@@ -31,6 +31,35 @@ extern Weapons* g_weapons;
 extern ConfigManager g_config;
 extern Events* g_events;
 
+namespace {
+
+// Tile lists of the area combats in progress, their buffers are reused by
+// later casts. A cast can start another one from the scripts it runs.
+std::vector<std::vector<Tile*>> tileListPool;
+
+class PooledTileList
+{
+	public:
+		PooledTileList() {
+			if (!tileListPool.empty()) {
+				tiles = std::move(tileListPool.back());
+				tileListPool.pop_back();
+			}
+		}
+		~PooledTileList() {
+			tiles.clear();
+			tileListPool.push_back(std::move(tiles));
+		}
+
+		// non-copyable
+		PooledTileList(const PooledTileList&) = delete;
+		PooledTileList& operator=(const PooledTileList&) = delete;
+
+		std::vector<Tile*> tiles;
+};
+
+}
+
 CombatDamage Combat::getCombatDamage(Creature* creature, Creature* target) const
 {
 	CombatDamage damage;
@@ -77,7 +106,7 @@ CombatDamage Combat::getCombatDamage(Creature* creature, Creature* target) const
 	return damage;
 }
 
-void Combat::getCombatArea(const Position& centerPos, const Position& targetPos, const AreaCombat* area, std::forward_list<Tile*>& list)
+void Combat::getCombatArea(const Position& centerPos, const Position& targetPos, const AreaCombat* area, std::vector<Tile*>& list)
 {
 	if (targetPos.z >= MAP_MAX_LAYERS) {
 		return;
@@ -91,7 +120,7 @@ void Combat::getCombatArea(const Position& centerPos, const Position& targetPos,
 			tile = new StaticTile(targetPos.x, targetPos.y, targetPos.z);
 			g_game.map.setTile(targetPos, tile);
 		}
-		list.push_front(tile);
+		list.push_back(tile);
 	}
 }
 
@@ -613,40 +642,26 @@ void Combat::doCombat(Creature* caster, const Position& position) const
 		CombatDamage damage = getCombatDamage(caster, nullptr);
 		doAreaCombat(caster, position, area.get(), damage, params);
 	} else {
-		std::forward_list<Tile*> tileList;
+		const Position& centerPos = caster ? caster->getPosition() : position;
 
-		if (caster) {
-			getCombatArea(caster->getPosition(), position, area.get(), tileList);
-		} else {
-			getCombatArea(position, position, area.get(), tileList);
-		}
+		PooledTileList tileList;
+		getCombatArea(centerPos, position, area.get(), tileList.tiles);
 
-		SpectatorVec spectators;
+		//the max viewable range
 		uint32_t maxX = 0;
 		uint32_t maxY = 0;
-
-		//calculate the max viewable range
-		for (Tile* tile : tileList) {
-			const Position& tilePos = tile->getPosition();
-
-			uint32_t diff = Position::getDistanceX(tilePos, position);
-			if (diff > maxX) {
-				maxX = diff;
-			}
-
-			diff = Position::getDistanceY(tilePos, position);
-			if (diff > maxY) {
-				maxY = diff;
-			}
+		if (area) {
+			area->getExtents(centerPos, position, maxX, maxY);
 		}
 
+		SpectatorVec spectators;
 		const int32_t rangeX = maxX + Map::maxViewportX;
 		const int32_t rangeY = maxY + Map::maxViewportY;
 		g_game.map.getSpectators(spectators, position, true, true, rangeX, rangeX, rangeY, rangeY);
 
 		postCombatEffects(caster, position, params);
 
-		for (Tile* tile : tileList) {
+		for (Tile* tile : tileList.tiles) {
 			if (canDoCombat(caster, tile, params.aggressive) != RETURNVALUE_NOERROR) {
 				continue;
 			}
@@ -760,30 +775,16 @@ void Combat::doTargetCombat(Creature* caster, Creature* target, CombatDamage& da
 
 void Combat::doAreaCombat(Creature* caster, const Position& position, const AreaCombat* area, CombatDamage& damage, const CombatParams& params)
 {
-	std::forward_list<Tile*> tileList;
+	const Position& centerPos = caster ? caster->getPosition() : position;
 
-	if (caster) {
-		getCombatArea(caster->getPosition(), position, area, tileList);
-	} else {
-		getCombatArea(position, position, area, tileList);
-	}
+	PooledTileList tileList;
+	getCombatArea(centerPos, position, area, tileList.tiles);
 
+	//the max viewable range
 	uint32_t maxX = 0;
 	uint32_t maxY = 0;
-
-	//calculate the max viewable range
-	for (Tile* tile : tileList) {
-		const Position& tilePos = tile->getPosition();
-
-		uint32_t diff = Position::getDistanceX(tilePos, position);
-		if (diff > maxX) {
-			maxX = diff;
-		}
-
-		diff = Position::getDistanceY(tilePos, position);
-		if (diff > maxY) {
-			maxY = diff;
-		}
+	if (area) {
+		area->getExtents(centerPos, position, maxX, maxY);
 	}
 
 	const int32_t rangeX = maxX + Map::maxViewportX;
@@ -794,7 +795,9 @@ void Combat::doAreaCombat(Creature* caster, const Position& position, const Area
 
 	postCombatEffects(caster, position, params);
 
-	for (Tile* tile : tileList) {
+	g_game.startCombatBatch();
+
+	for (Tile* tile : tileList.tiles) {
 		if (canDoCombat(caster, tile, params.aggressive) != RETURNVALUE_NOERROR) {
 			continue;
 		}
@@ -867,6 +870,8 @@ void Combat::doAreaCombat(Creature* caster, const Position& position, const Area
 			}
 		}
 	}
+
+	g_game.endCombatBatch();
 }
 
 //**********************************************************//
@@ -1034,48 +1039,56 @@ void TargetCallback::onTargetCombat(Creature* creature, Creature* target) const
 
 void AreaCombat::clear()
 {
-	for (const auto& it : areas) {
-		delete it.second;
+	for (AreaOffsets& area : areas) {
+		area = AreaOffsets();
 	}
-	areas.clear();
 }
 
-AreaCombat::AreaCombat(const AreaCombat& rhs)
+void AreaCombat::getList(const Position& centerPos, const Position& targetPos, std::vector<Tile*>& list) const
 {
-	hasExtArea = rhs.hasExtArea;
-	for (const auto& it : rhs.areas) {
-		areas[it.first] = new MatrixArea(*it.second);
+	for (const auto& offset : getArea(centerPos, targetPos).offsets) {
+		Position tilePos(targetPos.x + offset.first, targetPos.y + offset.second, targetPos.z);
+		if (!g_game.isSightClear(targetPos, tilePos, true)) {
+			continue;
+		}
+
+		Tile* tile = g_game.map.getTile(tilePos);
+		if (!tile) {
+			tile = new StaticTile(tilePos.x, tilePos.y, tilePos.z);
+			g_game.map.setTile(tilePos, tile);
+		}
+		list.push_back(tile);
 	}
 }
 
-void AreaCombat::getList(const Position& centerPos, const Position& targetPos, std::forward_list<Tile*>& list) const
+void AreaCombat::getExtents(const Position& centerPos, const Position& targetPos, uint32_t& maxX, uint32_t& maxY) const
 {
-	const MatrixArea* area = getArea(centerPos, targetPos);
-	if (!area) {
-		return;
-	}
+	const AreaOffsets& area = getArea(centerPos, targetPos);
+	maxX = area.maxX;
+	maxY = area.maxY;
+}
 
+void AreaCombat::setArea(Direction dir, const MatrixArea* area)
+{
 	uint32_t centerY, centerX;
 	area->getCenter(centerY, centerX);
 
-	Position tmpPos(targetPos.x - centerX, targetPos.y - centerY, targetPos.z);
-	uint32_t cols = area->getCols();
-	for (uint32_t y = 0, rows = area->getRows(); y < rows; ++y) {
-		for (uint32_t x = 0; x < cols; ++x) {
-			if (area->getValue(y, x) != 0) {
-				if (g_game.isSightClear(targetPos, tmpPos, true)) {
-					Tile* tile = g_game.map.getTile(tmpPos);
-					if (!tile) {
-						tile = new StaticTile(tmpPos.x, tmpPos.y, tmpPos.z);
-						g_game.map.setTile(tmpPos, tile);
-					}
-					list.push_front(tile);
-				}
+	AreaOffsets& offsets = areas[dir];
+	offsets = AreaOffsets();
+
+	// bottom row first, the order the tiles were always hit in
+	for (int32_t y = area->getRows(); --y >= 0;) {
+		for (int32_t x = area->getCols(); --x >= 0;) {
+			if (!area->getValue(y, x)) {
+				continue;
 			}
-			tmpPos.x++;
+
+			int32_t offsetX = x - static_cast<int32_t>(centerX);
+			int32_t offsetY = y - static_cast<int32_t>(centerY);
+			offsets.offsets.emplace_back(offsetX, offsetY);
+			offsets.maxX = std::max<uint32_t>(offsets.maxX, std::abs(offsetX));
+			offsets.maxY = std::max<uint32_t>(offsets.maxY, std::abs(offsetY));
 		}
-		tmpPos.x -= cols;
-		tmpPos.y++;
 	}
 }
 
@@ -1196,27 +1209,27 @@ MatrixArea* AreaCombat::createArea(const std::list<uint32_t>& list, uint32_t row
 
 void AreaCombat::setupArea(const std::list<uint32_t>& list, uint32_t rows)
 {
-	MatrixArea* area = createArea(list, rows);
+	std::unique_ptr<MatrixArea> area(createArea(list, rows));
 
 	//NORTH
-	areas[DIRECTION_NORTH] = area;
+	setArea(DIRECTION_NORTH, area.get());
 
 	uint32_t maxOutput = std::max<uint32_t>(area->getCols(), area->getRows()) * 2;
 
 	//SOUTH
-	MatrixArea* southArea = new MatrixArea(maxOutput, maxOutput);
-	AreaCombat::copyArea(area, southArea, MATRIXOPERATION_ROTATE180);
-	areas[DIRECTION_SOUTH] = southArea;
+	MatrixArea southArea(maxOutput, maxOutput);
+	AreaCombat::copyArea(area.get(), &southArea, MATRIXOPERATION_ROTATE180);
+	setArea(DIRECTION_SOUTH, &southArea);
 
 	//EAST
-	MatrixArea* eastArea = new MatrixArea(maxOutput, maxOutput);
-	AreaCombat::copyArea(area, eastArea, MATRIXOPERATION_ROTATE90);
-	areas[DIRECTION_EAST] = eastArea;
+	MatrixArea eastArea(maxOutput, maxOutput);
+	AreaCombat::copyArea(area.get(), &eastArea, MATRIXOPERATION_ROTATE90);
+	setArea(DIRECTION_EAST, &eastArea);
 
 	//WEST
-	MatrixArea* westArea = new MatrixArea(maxOutput, maxOutput);
-	AreaCombat::copyArea(area, westArea, MATRIXOPERATION_ROTATE270);
-	areas[DIRECTION_WEST] = westArea;
+	MatrixArea westArea(maxOutput, maxOutput);
+	AreaCombat::copyArea(area.get(), &westArea, MATRIXOPERATION_ROTATE270);
+	setArea(DIRECTION_WEST, &westArea);
 }
 
 void AreaCombat::setupArea(int32_t length, int32_t spread)
@@ -1296,27 +1309,27 @@ void AreaCombat::setupExtArea(const std::list<uint32_t>& list, uint32_t rows)
 	}
 
 	hasExtArea = true;
-	MatrixArea* area = createArea(list, rows);
+	std::unique_ptr<MatrixArea> area(createArea(list, rows));
 
 	//NORTH-WEST
-	areas[DIRECTION_NORTHWEST] = area;
+	setArea(DIRECTION_NORTHWEST, area.get());
 
 	uint32_t maxOutput = std::max<uint32_t>(area->getCols(), area->getRows()) * 2;
 
 	//NORTH-EAST
-	MatrixArea* neArea = new MatrixArea(maxOutput, maxOutput);
-	AreaCombat::copyArea(area, neArea, MATRIXOPERATION_MIRROR);
-	areas[DIRECTION_NORTHEAST] = neArea;
+	MatrixArea neArea(maxOutput, maxOutput);
+	AreaCombat::copyArea(area.get(), &neArea, MATRIXOPERATION_MIRROR);
+	setArea(DIRECTION_NORTHEAST, &neArea);
 
 	//SOUTH-WEST
-	MatrixArea* swArea = new MatrixArea(maxOutput, maxOutput);
-	AreaCombat::copyArea(area, swArea, MATRIXOPERATION_FLIP);
-	areas[DIRECTION_SOUTHWEST] = swArea;
+	MatrixArea swArea(maxOutput, maxOutput);
+	AreaCombat::copyArea(area.get(), &swArea, MATRIXOPERATION_FLIP);
+	setArea(DIRECTION_SOUTHWEST, &swArea);
 
 	//SOUTH-EAST
-	MatrixArea* seArea = new MatrixArea(maxOutput, maxOutput);
-	AreaCombat::copyArea(swArea, seArea, MATRIXOPERATION_MIRROR);
-	areas[DIRECTION_SOUTHEAST] = seArea;
+	MatrixArea seArea(maxOutput, maxOutput);
+	AreaCombat::copyArea(&swArea, &seArea, MATRIXOPERATION_MIRROR);
+	setArea(DIRECTION_SOUTHEAST, &seArea);
 }
 
 //**********************************************************//
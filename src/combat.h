@@ -162,17 +162,9 @@ class MatrixArea
 class AreaCombat
 {
 	public:
-		AreaCombat() = default;
-
-		AreaCombat(const AreaCombat& rhs);
-		~AreaCombat() {
-			clear();
-		}
-
-		// non-assignable
-		AreaCombat& operator=(const AreaCombat&) = delete;
-
-		void getList(const Position& centerPos, const Position& targetPos, std::forward_list<Tile*>& list) const;
+		void getList(const Position& centerPos, const Position& targetPos, std::vector<Tile*>& list) const;
+		// how far the tiles getList returns can be from targetPos
+		void getExtents(const Position& centerPos, const Position& targetPos, uint32_t& maxX, uint32_t& maxY) const;
 
 		void setupArea(const std::list<uint32_t>& list, uint32_t rows);
 		void setupArea(int32_t length, int32_t spread);
@@ -190,10 +182,19 @@ class AreaCombat
 			MATRIXOPERATION_ROTATE270,
 		};
 
-		MatrixArea* createArea(const std::list<uint32_t>& list, uint32_t rows);
+		// the cells of an area as offsets from its center, in the order they
+		// are hit, and the farthest they reach
+		struct AreaOffsets {
+			std::vector<std::pair<int32_t, int32_t>> offsets;
+			uint32_t maxX = 0;
+			uint32_t maxY = 0;
+		};
+
+		static MatrixArea* createArea(const std::list<uint32_t>& list, uint32_t rows);
 		static void copyArea(const MatrixArea* input, MatrixArea* output, MatrixOperation_t op);
+		void setArea(Direction dir, const MatrixArea* area);
 
-		MatrixArea* getArea(const Position& centerPos, const Position& targetPos) const {
+		const AreaOffsets& getArea(const Position& centerPos, const Position& targetPos) const {
 			int32_t dx = Position::getOffsetX(targetPos, centerPos);
 			int32_t dy = Position::getOffsetY(targetPos, centerPos);
 
@@ -219,15 +220,12 @@ class AreaCombat
 					dir = DIRECTION_SOUTHEAST;
 				}
 			}
-
-			auto it = areas.find(dir);
-			if (it == areas.end()) {
-				return nullptr;
-			}
-			return it->second;
+			return areas[dir];
 		}
 
-		std::map<Direction, MatrixArea*> areas;
+		// compiled once from the rotated MatrixAreas, a direction without
+		// an area hits nothing
+		std::array<AreaOffsets, DIRECTION_LAST + 1> areas;
 		bool hasExtArea = false;
 };
 
@@ -240,7 +238,7 @@ class Combat
 		Combat(const Combat&) = delete;
 		Combat& operator=(const Combat&) = delete;
 
-		static void getCombatArea(const Position& centerPos, const Position& targetPos, const AreaCombat* area, std::forward_list<Tile*>& list);
+		static void getCombatArea(const Position& centerPos, const Position& targetPos, const AreaCombat* area, std::vector<Tile*>& list);
 
 		static bool isInPvpZone(const Creature* attacker, const Creature* target);
 		static bool isProtected(const Player* attacker, const Player* target);
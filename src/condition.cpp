@@ -132,7 +132,7 @@ void Condition::serialize(PropWriteStream& propWriteStream)
 	propWriteStream.write<uint32_t>(id);
 
 	propWriteStream.write<uint8_t>(CONDITIONATTR_TICKS);
-	propWriteStream.write<uint32_t>(ticks);
+	propWriteStream.write<uint32_t>(getTicks());
 
 	propWriteStream.write<uint8_t>(CONDITIONATTR_ISBUFF);
 	propWriteStream.write<uint8_t>(isBuff);
@@ -144,10 +144,28 @@ void Condition::serialize(PropWriteStream& propWriteStream)
 	propWriteStream.write<uint8_t>(aggressive);
 }
 
+int32_t Condition::getTicks() const
+{
+	// a started condition that is not periodic is only executed once it runs
+	// out, until then its ticks follow from the end time
+	if (!started || ticks <= 0 || isPeriodic()) {
+		return ticks;
+	}
+	return static_cast<int32_t>(std::max<int64_t>(0, endTime - OTSYS_TIME()));
+}
+
 void Condition::setTicks(int32_t newTicks)
 {
 	ticks = newTicks;
 	endTime = ticks + OTSYS_TIME();
+
+	// the creature does not look at its conditions before the end time it
+	// has cached, the new one may be earlier
+	if (started && holderId != 0) {
+		if (Creature* holder = g_game.getCreatureByID(holderId)) {
+			holder->updateConditions();
+		}
+	}
 }
 
 bool Condition::executeCondition(Creature*, int32_t interval)
@@ -274,11 +292,13 @@ Condition* Condition::createCondition(PropStream& propStream)
 	return createCondition(static_cast<ConditionId_t>(id), static_cast<ConditionType_t>(type), ticks, 0, buff != 0, subId, aggressive);
 }
 
-bool Condition::startCondition(Creature*)
+bool Condition::startCondition(Creature* creature)
 {
 	if (ticks > 0) {
 		endTime = ticks + OTSYS_TIME();
 	}
+	started = true;
+	holderId = creature->getID();
 	return true;
 }
 
@@ -80,6 +80,11 @@ class Condition
 		virtual bool startCondition(Creature* creature);
 		virtual bool executeCondition(Creature* creature, int32_t interval);
 		virtual void endCondition(Creature* creature) = 0;
+		// true if executeCondition does more than count down the ticks, the
+		// creature skips executing conditions that are not until one runs out
+		virtual bool isPeriodic() const {
+			return false;
+		}
 		virtual void addCondition(Creature* creature, const Condition* condition) = 0;
 		virtual uint32_t getIcons() const;
 		ConditionId_t getId() const {
@@ -97,9 +102,7 @@ class Condition
 		int64_t getEndTime() const {
 			return endTime;
 		}
-		int32_t getTicks() const {
-			return ticks;
-		}
+		int32_t getTicks() const;
 		void setTicks(int32_t newTicks);
 		bool isAggressive() const {
 			return aggressive;
@@ -126,6 +129,9 @@ class Condition
 		ConditionType_t conditionType;
 		bool isBuff;
 		bool aggressive;
+		bool started = false;
+		// id of the creature the condition was started on
+		uint32_t holderId = 0;
 
 	private:
 		ConditionId_t id;
@@ -193,6 +199,9 @@ class ConditionRegeneration final : public ConditionGeneric
 
 		void addCondition(Creature* creature, const Condition* condition) override;
 		bool executeCondition(Creature* creature, int32_t interval) override;
+		bool isPeriodic() const override {
+			return true;
+		}
 
 		bool setParam(ConditionParam_t param, int32_t value) override;
 
@@ -222,6 +231,9 @@ class ConditionSoul final : public ConditionGeneric
 
 		void addCondition(Creature* creature, const Condition* condition) override;
 		bool executeCondition(Creature* creature, int32_t interval) override;
+		bool isPeriodic() const override {
+			return true;
+		}
 
 		bool setParam(ConditionParam_t param, int32_t value) override;
 
@@ -264,6 +276,9 @@ class ConditionDamage final : public Condition
 
 		bool startCondition(Creature* creature) override;
 		bool executeCondition(Creature* creature, int32_t interval) override;
+		bool isPeriodic() const override {
+			return true;
+		}
 		void endCondition(Creature* creature) override;
 		void addCondition(Creature* creature, const Condition* condition) override;
 		uint32_t getIcons() const override;
@@ -381,6 +396,9 @@ class ConditionLight final : public Condition
 
 		bool startCondition(Creature* creature) override;
 		bool executeCondition(Creature* creature, int32_t interval) override;
+		bool isPeriodic() const override {
+			return true;
+		}
 		void endCondition(Creature* creature) override;
 		void addCondition(Creature* creature, const Condition* condition) override;
 
@@ -110,6 +110,7 @@ bool ConfigManager::load()
 	if (!loaded) { //info that must be loaded one time (unless we reset the modules involved)
 		boolean[BIND_ONLY_GLOBAL_ADDRESS] = getGlobalBoolean(L, "bindOnlyGlobalAddress", false);
 		boolean[OPTIMIZE_DATABASE] = getGlobalBoolean(L, "startupDatabaseOptimization", true);
+		boolean[WORLD_SNAPSHOT] = getGlobalBoolean(L, "worldSnapshot", false);
 
 		string[IP_STRING] = getGlobalString(L, "ip", "127.0.0.1");
 		string[MAP_NAME] = getGlobalString(L, "mapName", "forgotten");
@@ -128,6 +129,8 @@ bool ConfigManager::load()
 		integer[STATUS_PORT] = getGlobalNumber(L, "statusProtocolPort", 7171);
 
 		integer[MARKET_OFFER_DURATION] = getGlobalNumber(L, "marketOfferDuration", 30 * 24 * 60 * 60);
+		integer[MAP_LOADER_THREADS] = getGlobalNumber(L, "mapLoaderThreads", 0);
+		integer[MONSTER_PRELOAD_THREADS] = getGlobalNumber(L, "monsterPreloadThreads", 0);
 		std::string ipString = string[IP_STRING];
 		uint32_t ip = inet_addr(ipString.c_str());
 		if (ip == INADDR_NONE) {
@@ -176,6 +179,10 @@ bool ConfigManager::load()
 	boolean[CLEAN_PROTECTION_ZONES] = getGlobalBoolean(L, "cleanProtectionZones", false);
 	boolean[HOUSE_DOOR_SHOW_PRICE] = getGlobalBoolean(L, "houseDoorShowPrice", true);
 	boolean[PACKET_COMPRESSION] = getGlobalBoolean(L, "packetCompression", true);
+	boolean[LUA_USERDATA_CACHE] = getGlobalBoolean(L, "luaUserdataCache", false);
+	boolean[LUA_PROFILER] = getGlobalBoolean(L, "luaProfiler", false);
+	boolean[DISPATCHER_TRACE] = getGlobalBoolean(L, "dispatcherTrace", false);
+	boolean[COMBAT_BATCHING] = getGlobalBoolean(L, "combatBatching", false);
 	boolean[LIVE_CAST_ENABLED] = getGlobalBoolean(L, "liveCastEnabled", true);
 
 	string[DEFAULT_PRIORITY] = getGlobalString(L, "defaultPriority", "high");
@@ -214,6 +221,9 @@ bool ConfigManager::load()
 	integer[MAX_PACKETS_PER_SECOND] = getGlobalNumber(L, "maxPacketsPerSecond", 25);
 	integer[SERVER_SAVE_NOTIFY_DURATION] = getGlobalNumber(L, "serverSaveNotifyDuration", 5);
 	integer[YELL_MINIMUM_LEVEL] = getGlobalNumber(L, "yellMinimumLevel", 2);
+	integer[LUA_PROFILER_SAMPLE_INTERVAL] = getGlobalNumber(L, "luaProfilerSampleInterval", 0);
+	integer[DISPATCHER_TRACE_LONG_TASK_THRESHOLD] = getGlobalNumber(L, "dispatcherTraceLongTaskThreshold", 50);
+	integer[DISPATCHER_TRACE_DUMP_INTERVAL] = getGlobalNumber(L, "dispatcherTraceDumpInterval", 0);
 
 	loaded = true;
 	lua_close(L);
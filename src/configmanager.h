@@ -56,6 +56,11 @@ class ConfigManager
 			CLEAN_PROTECTION_ZONES,
 			HOUSE_DOOR_SHOW_PRICE,
 			PACKET_COMPRESSION,
+			LUA_USERDATA_CACHE,
+			LUA_PROFILER,
+			DISPATCHER_TRACE,
+			WORLD_SNAPSHOT,
+			COMBAT_BATCHING,
 
 			LAST_BOOLEAN_CONFIG /* this must be the last one */
 		};
@@ -117,6 +122,11 @@ class ConfigManager
 			MAX_PACKETS_PER_SECOND,
 			SERVER_SAVE_NOTIFY_DURATION,
 			YELL_MINIMUM_LEVEL,
+			LUA_PROFILER_SAMPLE_INTERVAL,
+			DISPATCHER_TRACE_LONG_TASK_THRESHOLD,
+			DISPATCHER_TRACE_DUMP_INTERVAL,
+			MAP_LOADER_THREADS,
+			MONSTER_PRELOAD_THREADS,
 
 			LAST_INTEGER_CONFIG /* this must be the last one */
 		};
@@ -74,7 +74,7 @@ void Connection::close(bool force)
 
 	if (protocol) {
 		g_dispatcher.addTask(
-			createTask(std::bind(&Protocol::release, protocol)));
+			createTask(std::bind(&Protocol::release, protocol), "Protocol::release"));
 	}
 
 	if (messageQueue.empty() || force) {
@@ -107,7 +107,7 @@ Connection::~Connection()
 void Connection::accept(Protocol_ptr protocol)
 {
 	this->protocol = protocol;
-	g_dispatcher.addTask(createTask(std::bind(&Protocol::onConnect, protocol)));
+	g_dispatcher.addTask(createTask(std::bind(&Protocol::onConnect, protocol), "Protocol::onConnect"));
 
 	accept();
 }
@@ -22,6 +22,14 @@
 
 static constexpr int32_t NETWORKMESSAGE_MAXSIZE = 65500;
 
+// creature id ranges, the kind of a creature can be told by its id
+static constexpr uint32_t PLAYER_ID_FIRST = 0x10000000;
+static constexpr uint32_t PLAYER_ID_LAST = 0x3FFFFFFF;
+static constexpr uint32_t MONSTER_ID_FIRST = 0x40000000;
+static constexpr uint32_t MONSTER_ID_LAST = 0x7FFFFFFF;
+static constexpr uint32_t NPC_ID_FIRST = 0x80000000;
+static constexpr uint32_t NPC_ID_LAST = 0xFFFFFFFF;
+
 enum MagicEffectClasses : uint8_t {
 	CONST_ME_NONE,
 
@@ -96,7 +96,7 @@ bool Container::unserializeItemNode(OTB::Loader& loader, const OTB::Node& node,
 		return false;
 	}
 
-	for (auto& itemNode : node.children) {
+	for (const OTB::Node& itemNode : loader.getChildren(node)) {
 		//load container items
 		if (itemNode.type != OTBM_ITEM) {
 			// unknown type
@@ -123,6 +123,14 @@ bool Container::unserializeItemNode(OTB::Loader& loader, const OTB::Node& node,
 	return true;
 }
 
+void Container::registerDeferred()
+{
+	Item::registerDeferred();
+	for (Item* item : itemlist) {
+		item->registerDeferred();
+	}
+}
+
 void Container::updateItemWeight(int32_t diff)
 {
 	totalWeight += diff;
@@ -75,6 +75,7 @@ class Container : public Item, public Cylinder
 
 		Attr_ReadValue readAttr(AttrTypes_t attr, PropStream& propStream) override;
 		bool unserializeItemNode(OTB::Loader& loader, const OTB::Node& node, PropStream& propStream) override;
+		void registerDeferred() override;
 		std::string getContentDescription() const;
 
 		size_t size() const {
@@ -170,6 +171,7 @@ class Container : public Item, public Cylinder
 		void updateItemWeight(int32_t diff);
 
 		friend class ContainerIterator;
+		friend class IOMap;
 		friend class IOMapSerialize;
 };
 
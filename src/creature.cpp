@@ -45,6 +45,8 @@ Creature::~Creature()
 		condition->endCondition(this);
 		delete condition;
 	}
+
+	LuaScriptInterface::invalidateUserdata(this);
 }
 
 bool Creature::canSee(const Position& myPos, const Position& pos, int32_t viewRangeX, int32_t viewRangeY)
@@ -87,6 +89,26 @@ void Creature::setSkull(Skulls_t newSkull)
 	g_game.updateCreatureSkull(this);
 }
 
+void Creature::setHearListener(bool listener)
+{
+	if (hearListener == listener) {
+		return;
+	}
+
+	// the leaf keeps listeners in their own list, move this creature over
+	QTreeLeafNode* leaf = nullptr;
+	if (!isRemoved() && getTile()) {
+		leaf = g_game.map.getQTNode(position.x, position.y);
+		leaf->removeCreature(this);
+	}
+
+	hearListener = listener;
+
+	if (leaf) {
+		leaf->addCreature(this);
+	}
+}
+
 int64_t Creature::getTimeSinceLastMove() const
 {
 	if (lastStep) {
@@ -277,18 +299,16 @@ void Creature::addEventWalk()
 
 	// Take first step right away, but still queue the next
 	if (ticks == 1) {
-		g_game.checkCreatureWalk(getID());
+		g_game.checkCreatureWalk(this);
 	}
 
-	eventWalk = g_scheduler.addEvent(createSchedulerTask(ticks, std::bind(&Game::checkCreatureWalk, &g_game, getID())));
+	eventWalk = g_game.addCreatureWalk(this, ticks);
 }
 
 void Creature::stopEventWalk()
 {
-	if (eventWalk != 0) {
-		g_scheduler.stopEvent(eventWalk);
-		eventWalk = 0;
-	}
+	// the queued step is dropped when it comes up
+	eventWalk = 0;
 }
 
 void Creature::updateMapCache()
@@ -602,7 +622,7 @@ void Creature::onCreatureMove(Creature* creature, const Tile* newTile, const Pos
 		} else {
 			if (hasExtraSwing()) {
 				//our target is moving lets see if we can get in hit
-				g_dispatcher.addTask(createTask(std::bind(&Game::checkCreatureAttack, &g_game, getID())));
+				g_dispatcher.addTask(createTask(std::bind(&Game::checkCreatureAttack, &g_game, getID()), "Game::checkCreatureAttack"));
 			}
 
 			if (newTile->getZone() != oldTile->getZone()) {
@@ -1121,7 +1141,7 @@ bool Creature::addCondition(Condition* condition, bool force/* = false*/)
 	if (!force && condition->getType() == CONDITION_HASTE && hasCondition(CONDITION_PARALYZE)) {
 		int64_t walkDelay = getWalkDelay();
 		if (walkDelay > 0) {
-			g_scheduler.addEvent(createSchedulerTask(walkDelay, std::bind(&Game::forceAddCondition, &g_game, getID(), condition)));
+			g_scheduler.addEvent(createSchedulerTask(walkDelay, std::bind(&Game::forceAddCondition, &g_game, getID(), condition), "Game::forceAddCondition"));
 			return false;
 		}
 	}
@@ -1130,11 +1150,13 @@ bool Creature::addCondition(Condition* condition, bool force/* = false*/)
 	if (prevCond) {
 		prevCond->addCondition(this, condition);
 		delete condition;
+		updateConditions();
 		return true;
 	}
 
 	if (condition->startCondition(this)) {
 		conditions.push_back(condition);
+		updateConditions();
 		onAddCondition(condition->getType());
 		return true;
 	}
@@ -1158,23 +1180,29 @@ bool Creature::addCombatCondition(Condition* condition)
 
 void Creature::removeCondition(ConditionType_t type, bool force/* = false*/)
 {
-	auto it = conditions.begin(), end = conditions.end();
-	while (it != end) {
-		Condition* condition = *it;
+	if (!(conditionTypes & type)) {
+		return;
+	}
+
+	// ending a condition may add others
+	size_t i = 0;
+	while (i < conditions.size()) {
+		Condition* condition = conditions[i];
 		if (condition->getType() != type) {
-			++it;
+			++i;
 			continue;
 		}
 
 		if (!force && type == CONDITION_PARALYZE) {
 			int64_t walkDelay = getWalkDelay();
 			if (walkDelay > 0) {
-				g_scheduler.addEvent(createSchedulerTask(walkDelay, std::bind(&Game::forceRemoveCondition, &g_game, getID(), type)));
+				g_scheduler.addEvent(createSchedulerTask(walkDelay, std::bind(&Game::forceRemoveCondition, &g_game, getID(), type), "Game::forceRemoveCondition"));
 				return;
 			}
 		}
 
-		it = conditions.erase(it);
+		conditions.erase(conditions.begin() + i);
+		updateConditions();
 
 		condition->endCondition(this);
 		delete condition;
@@ -1185,23 +1213,29 @@ void Creature::removeCondition(ConditionType_t type, bool force/* = false*/)
 
 void Creature::removeCondition(ConditionType_t type, ConditionId_t conditionId, bool force/* = false*/)
 {
-	auto it = conditions.begin(), end = conditions.end();
-	while (it != end) {
-		Condition* condition = *it;
+	if (!(conditionTypes & type)) {
+		return;
+	}
+
+	// ending a condition may add others
+	size_t i = 0;
+	while (i < conditions.size()) {
+		Condition* condition = conditions[i];
 		if (condition->getType() != type || condition->getId() != conditionId) {
-			++it;
+			++i;
 			continue;
 		}
 
 		if (!force && type == CONDITION_PARALYZE) {
 			int64_t walkDelay = getWalkDelay();
 			if (walkDelay > 0) {
-				g_scheduler.addEvent(createSchedulerTask(walkDelay, std::bind(&Game::forceRemoveCondition, &g_game, getID(), type)));
+				g_scheduler.addEvent(createSchedulerTask(walkDelay, std::bind(&Game::forceRemoveCondition, &g_game, getID(), type), "Game::forceRemoveCondition"));
 				return;
 			}
 		}
 
-		it = conditions.erase(it);
+		conditions.erase(conditions.begin() + i);
+		updateConditions();
 
 		condition->endCondition(this);
 		delete condition;
@@ -1234,12 +1268,13 @@ void Creature::removeCondition(Condition* condition, bool force/* = false*/)
 	if (!force && condition->getType() == CONDITION_PARALYZE) {
 		int64_t walkDelay = getWalkDelay();
 		if (walkDelay > 0) {
-			g_scheduler.addEvent(createSchedulerTask(walkDelay, std::bind(&Game::forceRemoveCondition, &g_game, getID(), condition->getType())));
+			g_scheduler.addEvent(createSchedulerTask(walkDelay, std::bind(&Game::forceRemoveCondition, &g_game, getID(), condition->getType()), "Game::forceRemoveCondition"));
 			return;
 		}
 	}
 
 	conditions.erase(it);
+	updateConditions();
 
 	condition->endCondition(this);
 	onEndCondition(condition->getType());
@@ -1248,6 +1283,10 @@ void Creature::removeCondition(Condition* condition, bool force/* = false*/)
 
 Condition* Creature::getCondition(ConditionType_t type) const
 {
+	if (!(conditionTypes & type)) {
+		return nullptr;
+	}
+
 	for (Condition* condition : conditions) {
 		if (condition->getType() == type) {
 			return condition;
@@ -1258,6 +1297,10 @@ Condition* Creature::getCondition(ConditionType_t type) const
 
 Condition* Creature::getCondition(ConditionType_t type, ConditionId_t conditionId, uint32_t subId/* = 0*/) const
 {
+	if (!(conditionTypes & type)) {
+		return nullptr;
+	}
+
 	for (Condition* condition : conditions) {
 		if (condition->getType() == type && condition->getId() == conditionId && condition->getSubId() == subId) {
 			return condition;
@@ -1268,6 +1311,12 @@ Condition* Creature::getCondition(ConditionType_t type, ConditionId_t conditionI
 
 void Creature::executeConditions(uint32_t interval)
 {
+	// nothing ticks and nothing runs out yet, the remaining ticks of these
+	// conditions follow from their end time
+	if (OTSYS_TIME() < nextConditionTick) {
+		return;
+	}
+
 	ConditionList tempConditions{ conditions };
 	for (Condition* condition : tempConditions) {
 		auto it = std::find(conditions.begin(), conditions.end(), condition);
@@ -1279,17 +1328,21 @@ void Creature::executeConditions(uint32_t interval)
 			it = std::find(conditions.begin(), conditions.end(), condition);
 			if (it != conditions.end()) {
 				conditions.erase(it);
+				updateConditions();
 				condition->endCondition(this);
 				onEndCondition(condition->getType());
 				delete condition;
 			}
 		}
 	}
+
+	// executing may have changed end times without adding or removing anything
+	updateConditions();
 }
 
 bool Creature::hasCondition(ConditionType_t type, uint32_t subId/* = 0*/) const
 {
-	if (isSuppress(type)) {
+	if (!(conditionTypes & type) || isSuppress(type)) {
 		return false;
 	}
 
@@ -1306,6 +1359,20 @@ bool Creature::hasCondition(ConditionType_t type, uint32_t subId/* = 0*/) const
 	return false;
 }
 
+void Creature::updateConditions()
+{
+	conditionTypes = 0;
+	nextConditionTick = std::numeric_limits<int64_t>::max();
+	for (const Condition* condition : conditions) {
+		conditionTypes |= condition->getType();
+		if (condition->isPeriodic()) {
+			nextConditionTick = 0;
+		} else {
+			nextConditionTick = std::min(nextConditionTick, condition->getEndTime());
+		}
+	}
+}
+
 bool Creature::isImmune(CombatType_t type) const
 {
 	return hasBitSet(static_cast<uint32_t>(type), getDamageImmunities());
@@ -1537,9 +1604,7 @@ bool FrozenPathingConditionCall::operator()(const Position& startPos, const Posi
 
 bool Creature::isInvisible() const
 {
-	return std::find_if(conditions.begin(), conditions.end(), [] (const Condition* condition) {
-		return condition->getType() == CONDITION_INVISIBLE;
-	}) != conditions.end();
+	return (conditionTypes & CONDITION_INVISIBLE) != 0;
 }
 
 bool Creature::getPathTo(const Position& targetPos, std::list<Direction>& dirList, const FindPathParams& fpp) const
@@ -28,7 +28,7 @@
 #include "enums.h"
 #include "creatureevent.h"
 
-using ConditionList = std::list<Condition*>;
+using ConditionList = std::vector<Condition*>;
 using CreatureEventList = std::list<CreatureEvent*>;
 
 enum slots_t : uint8_t {
@@ -131,8 +131,7 @@ class Creature : virtual public Thing
 
 		virtual const std::string& getName() const = 0;
 		virtual const std::string& getNameDescription() const = 0;
-		
-		virtual void setID() = 0;
+
 		void setRemoved() {
 			isInternalRemoved = true;
 		}
@@ -170,6 +169,13 @@ class Creature : virtual public Thing
 			hiddenHealth = b;
 		}
 
+		// only hear listeners get onCreatureSay and Creature:onHear, the map
+		// keeps them in their own list so speech does not visit the crowd
+		bool isHearListener() const {
+			return hearListener;
+		}
+		void setHearListener(bool listener);
+
 		int32_t getThrowRange() const override final {
 			return 1;
 		}
@@ -480,6 +486,10 @@ class Creature : virtual public Thing
 		std::list<Creature*> summons;
 		CreatureEventList eventsList;
 		ConditionList conditions;
+		// the types of the conditions above, and when executeConditions next
+		// has something to do, 0 while one of them does work every interval
+		int64_t nextConditionTick = std::numeric_limits<int64_t>::max();
+		uint32_t conditionTypes = 0;
 
 		std::list<Direction> listWalkDir;
 
@@ -518,12 +528,14 @@ class Creature : virtual public Thing
 		bool isUpdatingPath = false;
 		bool creatureCheck = false;
 		bool inCheckCreaturesVector = false;
+		bool walkUpdateQueued = false;
 		bool skillLoss = true;
 		bool lootDrop = true;
 		bool cancelNextWalk = false;
 		bool hasFollowPath = false;
 		bool forceUpdateFollowPath = false;
 		bool hiddenHealth = false;
+		bool hearListener = false;
 		bool canUseDefense = true;
 
 		//creature script events
@@ -532,6 +544,7 @@ class Creature : virtual public Thing
 		}
 		CreatureEventList getCreatureEvents(CreatureEventType_t type);
 
+		void updateConditions();
 		void updateMapCache();
 		void updateTileCache(const Tile* tile, int32_t dx, int32_t dy);
 		void updateTileCache(const Tile* tile, const Position& pos);
@@ -553,6 +566,7 @@ class Creature : virtual public Thing
 		virtual bool dropCorpse(Creature* lastHitCreature, Creature* mostDamageCreature, bool lastHitUnjustified, bool mostDamageUnjustified);
 		virtual Item* getCorpse(Creature* lastHitCreature, Creature* mostDamageCreature);
 
+		friend class Condition;
 		friend class Game;
 		friend class Map;
 		friend class LuaScriptInterface;
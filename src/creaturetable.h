@@ -0,0 +1,129 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef FS_CREATURETABLE_H_D08AC60F647042F19EE2DBA45C4A92AF
+#define FS_CREATURETABLE_H_D08AC60F647042F19EE2DBA45C4A92AF
+
+#include <deque>
+#include <vector>
+
+// Creatures of one kind in the game, by id. An id is firstId plus a slot
+// index in the low SLOT_BITS and the generation of the slot above them, a
+// lookup is a bounds check and a generation compare. A slot moves to the
+// next generation when its creature is removed, so the old id stops
+// matching; freed slots are reused oldest first to make the generations
+// last. The creatures themselves are kept contiguous for iteration, in no
+// particular order.
+template <typename T>
+class CreatureTable
+{
+	public:
+		static constexpr uint32_t SLOT_BITS = 18;
+		static constexpr uint32_t SLOT_COUNT = 1 << SLOT_BITS;
+
+		// lastId - firstId + 1 must be a multiple of SLOT_COUNT
+		CreatureTable(uint32_t firstId, uint32_t lastId) :
+			firstId(firstId), generationCount(((lastId - firstId) >> SLOT_BITS) + 1) {}
+
+		// non-copyable
+		CreatureTable(const CreatureTable&) = delete;
+		CreatureTable& operator=(const CreatureTable&) = delete;
+
+		// the id of the creature, 0 if every slot is taken
+		uint32_t add(T* creature) {
+			uint32_t slotIndex;
+			if (!freeSlots.empty()) {
+				slotIndex = freeSlots.front();
+				freeSlots.pop_front();
+			} else if (slots.size() < SLOT_COUNT) {
+				slotIndex = slots.size();
+				slots.emplace_back();
+			} else {
+				return 0;
+			}
+
+			Slot& slot = slots[slotIndex];
+			slot.creature = creature;
+			slot.index = creatures.size();
+			creatures.push_back(creature);
+			return firstId + (slot.generation << SLOT_BITS) + slotIndex;
+		}
+
+		void remove(uint32_t id) {
+			if (!get(id)) {
+				return;
+			}
+
+			uint32_t slotIndex = (id - firstId) & (SLOT_COUNT - 1);
+			Slot& slot = slots[slotIndex];
+
+			// the last creature takes the place of the removed one
+			T* last = creatures.back();
+			creatures[slot.index] = last;
+			slots[(last->getID() - firstId) & (SLOT_COUNT - 1)].index = slot.index;
+			creatures.pop_back();
+
+			slot.creature = nullptr;
+			slot.generation = (slot.generation + 1) % generationCount;
+			freeSlots.push_back(slotIndex);
+		}
+
+		T* get(uint32_t id) const {
+			if (id < firstId) {
+				return nullptr;
+			}
+
+			uint32_t offset = id - firstId;
+			uint32_t slotIndex = offset & (SLOT_COUNT - 1);
+			if (slotIndex >= slots.size()) {
+				return nullptr;
+			}
+
+			const Slot& slot = slots[slotIndex];
+			if (slot.generation != (offset >> SLOT_BITS)) {
+				return nullptr;
+			}
+			return slot.creature;
+		}
+
+		const std::vector<T*>& getCreatures() const {
+			return creatures;
+		}
+		size_t size() const {
+			return creatures.size();
+		}
+
+	private:
+		struct Slot {
+			T* creature = nullptr;
+			uint32_t generation = 0;
+			// position in creatures
+			uint32_t index = 0;
+		};
+
+		std::vector<Slot> slots;
+		std::deque<uint32_t> freeSlots;
+		std::vector<T*> creatures;
+
+		uint32_t firstId;
+		uint32_t generationCount;
+};
+
+#endif
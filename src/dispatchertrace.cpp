@@ -0,0 +1,208 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "otpch.h"
+
+#include "dispatchertrace.h"
+#include "scheduler.h"
+#include "tools.h"
+
+#include <cmath>
+#include <fstream>
+
+DispatcherTrace g_dispatcherTrace;
+
+void DispatcherTrace::Histogram::add(uint64_t duration)
+{
+	size_t bucket = 0;
+	while (bucket + 1 < HISTOGRAM_BUCKETS && (duration >> (bucket + 1)) != 0) {
+		++bucket;
+	}
+
+	++buckets[bucket];
+	++count;
+	total += duration;
+	max = std::max(max, duration);
+}
+
+void DispatcherTrace::Histogram::merge(const Histogram& other)
+{
+	for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+		buckets[i] += other.buckets[i];
+	}
+	count += other.count;
+	total += other.total;
+	max = std::max(max, other.max);
+}
+
+uint64_t DispatcherTrace::Histogram::percentile(double fraction) const
+{
+	// upper bound of the bucket holding the requested rank
+	uint64_t rank = static_cast<uint64_t>(std::ceil(count * fraction));
+	uint64_t seen = 0;
+	for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+		seen += buckets[i];
+		if (seen >= rank && seen != 0) {
+			return std::min<uint64_t>(max, (static_cast<uint64_t>(1) << (i + 1)) - 1);
+		}
+	}
+	return max;
+}
+
+void DispatcherTrace::start(uint32_t longTaskThreshold, uint32_t dumpInterval /*= 0*/)
+{
+	this->longTaskThreshold = static_cast<uint64_t>(longTaskThreshold) * 1000;
+	this->dumpInterval = dumpInterval * 60 * 1000;
+
+	if (!isEnabled()) {
+		reset();
+		enabled.store(true, std::memory_order_relaxed);
+	}
+
+	if (dumpEventId != 0) {
+		g_scheduler.stopEvent(dumpEventId);
+		dumpEventId = 0;
+	}
+
+	if (this->dumpInterval != 0) {
+		dumpEventId = g_scheduler.addEvent(createSchedulerTask(this->dumpInterval,
+		                                   std::bind(&DispatcherTrace::dumpEvent, this, std::string("data/logs/dispatcher.log")), "DispatcherTrace::dumpEvent"));
+	}
+}
+
+void DispatcherTrace::stop()
+{
+	enabled.store(false, std::memory_order_relaxed);
+	dumpInterval = 0;
+
+	if (dumpEventId != 0) {
+		g_scheduler.stopEvent(dumpEventId);
+		dumpEventId = 0;
+	}
+}
+
+void DispatcherTrace::reset()
+{
+	origins.clear();
+	ticks = Histogram();
+	longTasks.clear();
+	since = std::chrono::steady_clock::now();
+}
+
+void DispatcherTrace::record(const Task& task, std::chrono::steady_clock::time_point startTime, std::chrono::steady_clock::time_point endTime)
+{
+	uint64_t execution = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+
+	// tasks queued before tracing was enabled have no queued time
+	uint64_t wait = 0;
+	auto queuedTime = task.getQueuedTime();
+	if (queuedTime.time_since_epoch().count() != 0 && queuedTime < startTime) {
+		wait = std::chrono::duration_cast<std::chrono::microseconds>(startTime - queuedTime).count();
+	}
+
+	const char* origin = task.getOrigin();
+	if (!origin) {
+		origin = "(untagged)";
+	}
+
+	OriginStats& stats = origins[origin];
+	stats.execution.add(execution);
+	stats.wait.add(wait);
+	ticks.add(execution);
+
+	if (longTaskThreshold != 0 && execution >= longTaskThreshold) {
+		if (longTasks.size() >= LONG_TASK_HISTORY) {
+			longTasks.pop_front();
+		}
+		longTasks.emplace_back(origin, time(nullptr), execution, wait);
+	}
+}
+
+bool DispatcherTrace::dump(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::app);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	// the same origin literal may live at different addresses in different translation units
+	std::map<std::string, OriginStats> merged;
+	for (const auto& it : origins) {
+		OriginStats& stats = merged[it.first];
+		stats.execution.merge(it.second.execution);
+		stats.wait.merge(it.second.wait);
+	}
+
+	std::vector<std::pair<const std::string*, const OriginStats*>> sorted;
+	sorted.reserve(merged.size());
+	for (const auto& it : merged) {
+		sorted.emplace_back(&it.first, &it.second);
+	}
+
+	std::sort(sorted.begin(), sorted.end(), [](const std::pair<const std::string*, const OriginStats*>& lhs, const std::pair<const std::string*, const OriginStats*>& rhs) {
+		return lhs.second->execution.total > rhs.second->execution.total;
+	});
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - since).count();
+	file << "== Dispatcher trace " << formatDate(time(nullptr)) << " (" << elapsed << " seconds, " << ticks.count << " tasks) ==" << std::endl;
+
+	file << std::endl << "Task duration histogram (us):" << std::endl;
+	for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+		if (ticks.buckets[i] == 0) {
+			continue;
+		}
+
+		uint64_t lower = i == 0 ? 0 : static_cast<uint64_t>(1) << i;
+		uint64_t upper = (static_cast<uint64_t>(1) << (i + 1)) - 1;
+		file << std::setw(10) << lower << " - " << std::setw(10) << upper << ": " << ticks.buckets[i] << std::endl;
+	}
+
+	file << std::endl << std::setw(10) << "count" << std::setw(12) << "total (ms)" << std::setw(10) << "avg (us)" << std::setw(10) << "p50 (us)"
+	     << std::setw(10) << "p99 (us)" << std::setw(10) << "max (us)" << std::setw(12) << "wait (us)" << std::setw(12) << "wait max" << "  origin" << std::endl;
+	for (const auto& it : sorted) {
+		const Histogram& execution = it.second->execution;
+		const Histogram& wait = it.second->wait;
+		file << std::setw(10) << execution.count << std::setw(12) << (execution.total / 1000) << std::setw(10) << (execution.total / execution.count)
+		     << std::setw(10) << execution.percentile(0.5) << std::setw(10) << execution.percentile(0.99) << std::setw(10) << execution.max
+		     << std::setw(12) << (wait.total / wait.count) << std::setw(12) << wait.max << "  " << *it.first << std::endl;
+	}
+
+	if (!longTasks.empty()) {
+		file << std::endl << "Tasks above " << (longTaskThreshold / 1000) << " ms:" << std::endl;
+		for (const LongTask& longTask : longTasks) {
+			file << formatDate(longTask.time) << "  " << std::setw(10) << longTask.execution << " us  (waited " << longTask.wait << " us)  " << longTask.origin << std::endl;
+		}
+	}
+
+	file << std::endl;
+	return true;
+}
+
+void DispatcherTrace::dumpEvent(const std::string& path)
+{
+	if (!dump(path)) {
+		std::cout << "[Warning - DispatcherTrace::dumpEvent] Can not write to " << path << std::endl;
+	}
+	reset();
+
+	dumpEventId = 0;
+	if (dumpInterval != 0 && isEnabled()) {
+		dumpEventId = g_scheduler.addEvent(createSchedulerTask(dumpInterval, std::bind(&DispatcherTrace::dumpEvent, this, path), "DispatcherTrace::dumpEvent"));
+	}
+}
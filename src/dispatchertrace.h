@@ -0,0 +1,100 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef FS_DISPATCHERTRACE_H_7B3E9A4C2D1F4E6A8B5C0D9E7F3A1B2C
+#define FS_DISPATCHERTRACE_H_7B3E9A4C2D1F4E6A8B5C0D9E7F3A1B2C
+
+#include <array>
+#include <atomic>
+#include <deque>
+
+class Task;
+
+// Per-origin execution and queue wait histograms of dispatcher tasks, plus
+// a history of tasks that ran longer than a threshold. Everything except
+// isEnabled() must only be called from the dispatcher thread.
+class DispatcherTrace
+{
+	public:
+		DispatcherTrace() = default;
+
+		// non-copyable
+		DispatcherTrace(const DispatcherTrace&) = delete;
+		DispatcherTrace& operator=(const DispatcherTrace&) = delete;
+
+		// longTaskThreshold in milliseconds, dumpInterval in minutes
+		void start(uint32_t longTaskThreshold, uint32_t dumpInterval = 0);
+		void stop();
+		void reset();
+		bool dump(const std::string& path) const;
+
+		bool isEnabled() const {
+			return enabled.load(std::memory_order_relaxed);
+		}
+
+		void record(const Task& task, std::chrono::steady_clock::time_point startTime, std::chrono::steady_clock::time_point endTime);
+
+	private:
+		// bucket i counts durations in [2^i, 2^(i+1)) microseconds, bucket 0 also counts 0
+		static constexpr size_t HISTOGRAM_BUCKETS = 25;
+		static constexpr size_t LONG_TASK_HISTORY = 256;
+
+		struct Histogram {
+			void add(uint64_t duration);
+			void merge(const Histogram& other);
+			uint64_t percentile(double fraction) const;
+
+			std::array<uint64_t, HISTOGRAM_BUCKETS> buckets = {};
+			uint64_t count = 0;
+			uint64_t total = 0;
+			uint64_t max = 0;
+		};
+
+		struct OriginStats {
+			Histogram execution;
+			Histogram wait;
+		};
+
+		struct LongTask {
+			LongTask(const char* origin, time_t time, uint64_t execution, uint64_t wait) :
+				origin(origin), time(time), execution(execution), wait(wait) {}
+
+			const char* origin;
+			time_t time;
+			uint64_t execution;
+			uint64_t wait;
+		};
+
+		void dumpEvent(const std::string& path);
+
+		std::unordered_map<const char*, OriginStats> origins;
+		Histogram ticks;
+		std::deque<LongTask> longTasks;
+
+		std::chrono::steady_clock::time_point since;
+		uint64_t longTaskThreshold = 0; // microseconds
+		uint32_t dumpInterval = 0; // milliseconds
+		uint32_t dumpEventId = 0;
+
+		std::atomic<bool> enabled {false};
+};
+
+extern DispatcherTrace g_dispatcherTrace;
+
+#endif
@@ -19,7 +19,6 @@
 
 #include "otpch.h"
 
-#include <stack>
 #include "fileloader.h"
 
 
@@ -27,81 +26,136 @@ namespace OTB {
 
 constexpr Identifier wildcard = {{'\0', '\0', '\0', '\0'}};
 
-Loader::Loader(const std::string& fileName, const Identifier& acceptedIdentifier):
-	fileContents(fileName)
+namespace {
+
+// Position of the first unescaped START or END, which ends the properties
+ContentIt findPropsEnd(ContentIt it, ContentIt end)
 {
-	constexpr auto minimalSize = sizeof(Identifier) + sizeof(Node::START) + sizeof(Node::type) + sizeof(Node::END);
-	if (fileContents.size() <= minimalSize) {
-		throw InvalidOTBFormat{};
-	}
+	for (; it != end; ++it) {
+		switch (static_cast<uint8_t>(*it)) {
+			case Node::START:
+			case Node::END:
+				return it;
 
-	Identifier fileIdentifier;
-	std::copy(fileContents.begin(), fileContents.begin() + fileIdentifier.size(), fileIdentifier.begin());
-	if (fileIdentifier != acceptedIdentifier && fileIdentifier != wildcard) {
-		throw InvalidOTBFormat{};
-	}
-}
+			case Node::ESCAPE: {
+				if (++it == end) {
+					throw InvalidOTBFormat{};
+				}
+				break;
+			}
 
-using NodeStack = std::stack<Node*, std::vector<Node*>>;
-static Node& getCurrentNode(const NodeStack& nodeStack) {
-	if (nodeStack.empty()) {
-		throw InvalidOTBFormat{};
+			default: {
+				break;
+			}
+		}
 	}
-	return *nodeStack.top();
+	throw InvalidOTBFormat{};
 }
 
-const Node& Loader::parseTree()
+// it points at the START of a node
+Node readNodeHeader(ContentIt it, ContentIt end)
 {
-	auto it = fileContents.begin() + sizeof(Identifier);
-	if (static_cast<uint8_t>(*it) != Node::START) {
+	if (++it == end) {
 		throw InvalidOTBFormat{};
 	}
-	root.type = *(++it);
-	root.propsBegin = ++it;
-	NodeStack parseStack;
-	parseStack.push(&root);
 
-	for (; it != fileContents.end(); ++it) {
-		switch(static_cast<uint8_t>(*it)) {
+	Node node;
+	node.type = *it;
+	node.propsBegin = it + sizeof(Node::type);
+	node.propsEnd = findPropsEnd(node.propsBegin, end);
+	return node;
+}
+
+// Position after the END of the node, its children are skipped
+ContentIt skipNode(const Node& node, ContentIt end)
+{
+	size_t depth = 0;
+	for (auto it = node.propsEnd; it != end; ++it) {
+		switch (static_cast<uint8_t>(*it)) {
 			case Node::START: {
-				auto& currentNode = getCurrentNode(parseStack);
-				if (currentNode.children.empty()) {
-					currentNode.propsEnd = it;
-				}
-				currentNode.children.emplace_back();
-				auto& child = currentNode.children.back();
-				if (++it == fileContents.end()) {
+				// the type byte is never escaped
+				if (++it == end) {
 					throw InvalidOTBFormat{};
 				}
-				child.type = *it;
-				child.propsBegin = it + sizeof(Node::type);
-				parseStack.push(&child);
+				++depth;
 				break;
 			}
+
 			case Node::END: {
-				auto& currentNode = getCurrentNode(parseStack);
-				if (currentNode.children.empty()) {
-					currentNode.propsEnd = it;
+				if (depth == 0) {
+					return it + 1;
 				}
-				parseStack.pop();
+				--depth;
 				break;
 			}
+
 			case Node::ESCAPE: {
-				if (++it == fileContents.end()) {
+				if (++it == end) {
 					throw InvalidOTBFormat{};
 				}
 				break;
 			}
+
 			default: {
 				break;
 			}
 		}
 	}
-	if (!parseStack.empty()) {
+	throw InvalidOTBFormat{};
+}
+
+}
+
+ChildIterator::ChildIterator(ContentIt pos, ContentIt fileEnd) :
+	pos(pos), fileEnd(fileEnd), atEnd(false)
+{
+	readNode();
+}
+
+ChildIterator& ChildIterator::operator++()
+{
+	pos = skipNode(node, fileEnd);
+	readNode();
+	return *this;
+}
+
+void ChildIterator::readNode()
+{
+	if (pos == fileEnd) {
+		throw InvalidOTBFormat{};
+	}
+
+	if (static_cast<uint8_t>(*pos) == Node::END) {
+		atEnd = true;
+		return;
+	}
+
+	// anything between the END of a child and the next one is malformed
+	if (static_cast<uint8_t>(*pos) != Node::START) {
+		throw InvalidOTBFormat{};
+	}
+	node = readNodeHeader(pos, fileEnd);
+}
+
+Loader::Loader(const std::string& fileName, const Identifier& acceptedIdentifier):
+	fileContents(fileName)
+{
+	constexpr auto minimalSize = sizeof(Identifier) + sizeof(Node::START) + sizeof(Node::type) + sizeof(Node::END);
+	if (fileContents.size() <= minimalSize) {
+		throw InvalidOTBFormat{};
+	}
+
+	Identifier fileIdentifier;
+	std::copy(fileContents.begin(), fileContents.begin() + fileIdentifier.size(), fileIdentifier.begin());
+	if (fileIdentifier != acceptedIdentifier && fileIdentifier != wildcard) {
 		throw InvalidOTBFormat{};
 	}
 
-	return root;
+	auto it = fileContents.begin() + sizeof(Identifier);
+	if (static_cast<uint8_t>(*it) != Node::START) {
+		throw InvalidOTBFormat{};
+	}
+	root = readNodeHeader(it, fileContents.end());
 }
 
 bool Loader::getProps(const Node& node, PropStream& props)
@@ -110,6 +164,8 @@ bool Loader::getProps(const Node& node, PropStream& props)
 	if (size == 0) {
 		return false;
 	}
+
+	static thread_local std::vector<char> propBuffer;
 	propBuffer.resize(size);
 	bool lastEscaped = false;
 
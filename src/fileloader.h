@@ -33,11 +33,8 @@ using Identifier = std::array<char, 4>;
 
 struct Node
 {
-	using ChildrenVector = std::vector<Node>;
-
-	ChildrenVector children;
 	ContentIt      propsBegin;
-	ContentIt      propsEnd;
+	ContentIt      propsEnd; // the first child or the END of this node starts here
 	uint8_t           type;
 	enum NodeChar: uint8_t
 	{
@@ -57,14 +54,73 @@ struct InvalidOTBFormat final : LoadError {
 	}
 };
 
+// Reads the children of a node straight from the mapped file, only the
+// current child is held. Moving to the next sibling scans past whatever is
+// left of the current child's subtree. A malformed file throws
+// InvalidOTBFormat when the bad part is reached.
+class ChildIterator
+{
+	public:
+		ChildIterator() = default;
+		ChildIterator(ContentIt pos, ContentIt fileEnd);
+
+		const Node& operator*() const {
+			return node;
+		}
+		const Node* operator->() const {
+			return &node;
+		}
+
+		ChildIterator& operator++();
+
+		// only meant to compare against the end iterator
+		bool operator==(const ChildIterator& other) const {
+			return atEnd == other.atEnd;
+		}
+		bool operator!=(const ChildIterator& other) const {
+			return atEnd != other.atEnd;
+		}
+
+	private:
+		void readNode();
+
+		Node node;
+		ContentIt pos = nullptr;
+		ContentIt fileEnd = nullptr;
+		bool atEnd = true;
+};
+
+class Children
+{
+	public:
+		Children(const Node& parent, ContentIt fileEnd) : parent(parent), fileEnd(fileEnd) {}
+
+		ChildIterator begin() const {
+			return ChildIterator(parent.propsEnd, fileEnd);
+		}
+		ChildIterator end() const {
+			return ChildIterator();
+		}
+
+	private:
+		const Node& parent;
+		ContentIt fileEnd;
+};
+
 class Loader {
 	MappedFile     fileContents;
 	Node              root;
-	std::vector<char> propBuffer;
 public:
 	Loader(const std::string& fileName, const Identifier& acceptedIdentifier);
+	// the returned stream is valid until the next getProps call on the same
+	// thread, the map loader reads tile areas from several threads at once
 	bool getProps(const Node& node, PropStream& props);
-	const Node& parseTree();
+	const Node& getRoot() const {
+		return root;
+	}
+	Children getChildren(const Node& node) const {
+		return Children(node, fileContents.end());
+	}
 };
 
 } //namespace OTB
@@ -120,6 +176,17 @@ class PropStream
 			return true;
 		}
 
+		// hands the next n bytes to another stream without copying them
+		bool readStream(PropStream& stream, size_t n) {
+			if (size() < n) {
+				return false;
+			}
+
+			stream.init(p, n);
+			p += n;
+			return true;
+		}
+
 	private:
 		const char* p = nullptr;
 		const char* end = nullptr;
@@ -160,6 +227,10 @@ class PropWriteStream
 			std::copy(str.begin(), str.end(), std::back_inserter(buffer));
 		}
 
+		void writeBytes(const char* data, size_t size) {
+			buffer.insert(buffer.end(), data, data + size);
+		}
+
 	private:
 		std::vector<char> buffer;
 };
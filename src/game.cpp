@@ -30,6 +30,7 @@
 #include "events.h"
 #include "game.h"
 #include "globalevent.h"
+#include "iodelivery.h"
 #include "iologindata.h"
 #include "iomarket.h"
 #include "items.h"
@@ -72,9 +73,9 @@ void Game::start(ServiceManager* manager)
 {
 	serviceManager = manager;
 
-	g_scheduler.addEvent(createSchedulerTask(EVENT_LIGHTINTERVAL, std::bind(&Game::checkLight, this)));
-	g_scheduler.addEvent(createSchedulerTask(EVENT_CREATURE_THINK_INTERVAL, std::bind(&Game::checkCreatures, this, 0)));
-	g_scheduler.addEvent(createSchedulerTask(EVENT_DECAYINTERVAL, std::bind(&Game::checkDecay, this)));
+	g_scheduler.addEvent(createSchedulerTask(EVENT_LIGHTINTERVAL, std::bind(&Game::checkLight, this), "Game::checkLight"));
+	g_scheduler.addEvent(createSchedulerTask(EVENT_CREATURE_THINK_INTERVAL, std::bind(&Game::checkCreatures, this, 0), "Game::checkCreatures"));
+	g_scheduler.addEvent(createSchedulerTask(EVENT_DECAYINTERVAL, std::bind(&Game::checkDecay, this), "Game::checkDecay"));
 }
 
 GameState_t Game::getGameState() const
@@ -123,17 +124,15 @@ void Game::setGameState(GameState_t newState)
 			g_globalEvents->execute(GLOBALEVENT_SHUTDOWN);
 
 			//kick all players that are still online
-			auto it = players.begin();
-			while (it != players.end()) {
-				it->second->kickPlayer(true);
-				it = players.begin();
+			while (players.size() != 0) {
+				getPlayers().front()->kickPlayer(true);
 			}
 
 			saveMotdNum();
 			saveGameState();
 
 			g_dispatcher.addTask(
-				createTask(std::bind(&Game::shutdown, this)));
+				createTask(std::bind(&Game::shutdown, this), "Game::shutdown"));
 
 			g_scheduler.stop();
 			g_databaseTasks.stop();
@@ -143,13 +142,10 @@ void Game::setGameState(GameState_t newState)
 
 		case GAME_STATE_CLOSED: {
 			/* kick all players without the CanAlwaysLogin flag */
-			auto it = players.begin();
-			while (it != players.end()) {
-				if (!it->second->hasFlag(PlayerFlag_CanAlwaysLogin)) {
-					it->second->kickPlayer(true);
-					it = players.begin();
-				} else {
-					++it;
+			const std::vector<Player*> online = getPlayers();
+			for (Player* player : online) {
+				if (!player->hasFlag(PlayerFlag_CanAlwaysLogin)) {
+					player->kickPlayer(true);
 				}
 			}
 
@@ -170,9 +166,9 @@ void Game::saveGameState()
 
 	std::cout << "Saving server..." << std::endl;
 
-	for (const auto& it : players) {
-		it.second->loginPosition = it.second->getPosition();
-		IOLoginData::savePlayer(it.second);
+	for (Player* player : getPlayers()) {
+		player->loginPosition = player->getPosition();
+		IOLoginData::savePlayer(player);
 	}
 
 	Map::save();
@@ -339,53 +335,27 @@ void Game::internalGetPosition(Item* item, Position& pos, uint8_t& stackpos)
 
 Creature* Game::getCreatureByID(uint32_t id)
 {
-	if (id <= Player::playerAutoID) {
-		return getPlayerByID(id);
-	} else if (id <= Monster::monsterAutoID) {
-		return getMonsterByID(id);
-	} else if (id <= Npc::npcAutoID) {
-		return getNpcByID(id);
+	if (id >= NPC_ID_FIRST) {
+		return npcs.get(id);
+	} else if (id >= MONSTER_ID_FIRST) {
+		return monsters.get(id);
 	}
-	return nullptr;
+	return players.get(id);
 }
 
 Monster* Game::getMonsterByID(uint32_t id)
 {
-	if (id == 0) {
-		return nullptr;
-	}
-
-	auto it = monsters.find(id);
-	if (it == monsters.end()) {
-		return nullptr;
-	}
-	return it->second;
+	return monsters.get(id);
 }
 
 Npc* Game::getNpcByID(uint32_t id)
 {
-	if (id == 0) {
-		return nullptr;
-	}
-
-	auto it = npcs.find(id);
-	if (it == npcs.end()) {
-		return nullptr;
-	}
-	return it->second;
+	return npcs.get(id);
 }
 
 Player* Game::getPlayerByID(uint32_t id)
 {
-	if (id == 0) {
-		return nullptr;
-	}
-
-	auto it = players.find(id);
-	if (it == players.end()) {
-		return nullptr;
-	}
-	return it->second;
+	return players.get(id);
 }
 
 Creature* Game::getCreatureByName(const std::string& s)
@@ -401,15 +371,15 @@ Creature* Game::getCreatureByName(const std::string& s)
 		return m_it->second;
 	}
 
-	for (const auto& it : npcs) {
-		if (lowerCaseName == asLowerCaseString(it.second->getName())) {
-			return it.second;
+	for (Npc* npc : npcs.getCreatures()) {
+		if (lowerCaseName == asLowerCaseString(npc->getName())) {
+			return npc;
 		}
 	}
 
-	for (const auto& it : monsters) {
-		if (lowerCaseName == asLowerCaseString(it.second->getName())) {
-			return it.second;
+	for (Monster* monster : monsters.getCreatures()) {
+		if (lowerCaseName == asLowerCaseString(monster->getName())) {
+			return monster;
 		}
 	}
 	return nullptr;
@@ -422,9 +392,9 @@ Npc* Game::getNpcByName(const std::string& s)
 	}
 
 	const char* npcName = s.c_str();
-	for (const auto& it : npcs) {
-		if (strcasecmp(npcName, it.second->getName().c_str()) == 0) {
-			return it.second;
+	for (Npc* npc : npcs.getCreatures()) {
+		if (strcasecmp(npcName, npc->getName().c_str()) == 0) {
+			return npc;
 		}
 	}
 	return nullptr;
@@ -485,9 +455,9 @@ ReturnValue Game::getPlayerByNameWildcard(const std::string& s, Player*& player)
 
 Player* Game::getPlayerByAccount(uint32_t acc)
 {
-	for (const auto& it : players) {
-		if (it.second->getAccount() == acc) {
-			return it.second;
+	for (Player* player : getPlayers()) {
+		if (player->getAccount() == acc) {
+			return player;
 		}
 	}
 	return nullptr;
@@ -503,9 +473,16 @@ bool Game::internalPlaceCreature(Creature* creature, const Position& pos, bool e
 		return false;
 	}
 
-	creature->incrementReferenceCounter();
-	creature->setID();
+	// the creature gets its id here
 	creature->addList();
+	if (creature->getID() == 0) {
+		std::cout << "[Error - Game::internalPlaceCreature] No creature id left for " << creature->getName() << '.' << std::endl;
+		creature->getTile()->removeCreature(creature);
+		creature->setParent(nullptr);
+		return false;
+	}
+
+	creature->incrementReferenceCounter();
 	return true;
 }
 
@@ -619,7 +596,7 @@ void Game::playerMoveThing(uint32_t playerId, const Position& fromPos,
 		if (Position::areInRange<1, 1, 0>(movingCreature->getPosition(), player->getPosition())) {
 			SchedulerTask* task = createSchedulerTask(1000,
 			                      std::bind(&Game::playerMoveCreatureByID, this, player->getID(),
-			                                  movingCreature->getID(), movingCreature->getPosition(), tile->getPosition()));
+			                                  movingCreature->getID(), movingCreature->getPosition(), tile->getPosition()), "Game::playerMoveCreatureByID");
 			player->setNextActionTask(task);
 		} else {
 			playerMoveCreature(player, movingCreature, movingCreature->getPosition(), tile);
@@ -661,7 +638,7 @@ void Game::playerMoveCreature(Player* player, Creature* movingCreature, const Po
 	if (!player->canDoAction()) {
 		uint32_t delay = player->getNextActionTime();
 		SchedulerTask* task = createSchedulerTask(delay, std::bind(&Game::playerMoveCreatureByID,
-			this, player->getID(), movingCreature->getID(), movingCreatureOrigPos, toTile->getPosition()));
+			this, player->getID(), movingCreature->getID(), movingCreatureOrigPos, toTile->getPosition()), "Game::playerMoveCreatureByID");
 		player->setNextActionTask(task);
 		return;
 	}
@@ -673,9 +650,9 @@ void Game::playerMoveCreature(Player* player, Creature* movingCreature, const Po
 		std::list<Direction> listDir;
 		if (player->getPathTo(movingCreatureOrigPos, listDir, 0, 1, true, true)) {
 			g_dispatcher.addTask(createTask(std::bind(&Game::playerAutoWalk,
-			                                this, player->getID(), listDir)));
+			                                this, player->getID(), listDir), "Game::playerAutoWalk"));
 			SchedulerTask* task = createSchedulerTask(1500, std::bind(&Game::playerMoveCreatureByID, this,
-				player->getID(), movingCreature->getID(), movingCreatureOrigPos, toTile->getPosition()));
+				player->getID(), movingCreature->getID(), movingCreatureOrigPos, toTile->getPosition()), "Game::playerMoveCreatureByID");
 			player->setNextWalkActionTask(task);
 		} else {
 			player->sendCancelMessage(RETURNVALUE_THEREISNOWAY);
@@ -846,7 +823,7 @@ void Game::playerMoveItem(Player* player, const Position& fromPos,
 	if (!player->canDoAction()) {
 		uint32_t delay = player->getNextActionTime();
 		SchedulerTask* task = createSchedulerTask(delay, std::bind(&Game::playerMoveItemByPlayerID, this,
-		                      player->getID(), fromPos, spriteId, fromStackPos, toPos, count));
+		                      player->getID(), fromPos, spriteId, fromStackPos, toPos, count), "Game::playerMoveItemByPlayerID");
 		player->setNextActionTask(task);
 		return;
 	}
@@ -910,10 +887,10 @@ void Game::playerMoveItem(Player* player, const Position& fromPos,
 		std::list<Direction> listDir;
 		if (player->getPathTo(item->getPosition(), listDir, 0, 1, true, true)) {
 			g_dispatcher.addTask(createTask(std::bind(&Game::playerAutoWalk,
-			                                this, player->getID(), listDir)));
+			                                this, player->getID(), listDir), "Game::playerAutoWalk"));
 
 			SchedulerTask* task = createSchedulerTask(400, std::bind(&Game::playerMoveItemByPlayerID, this,
-			                      player->getID(), fromPos, spriteId, fromStackPos, toPos, count));
+			                      player->getID(), fromPos, spriteId, fromStackPos, toPos, count), "Game::playerMoveItemByPlayerID");
 			player->setNextWalkActionTask(task);
 		} else {
 			player->sendCancelMessage(RETURNVALUE_THEREISNOWAY);
@@ -969,10 +946,10 @@ void Game::playerMoveItem(Player* player, const Position& fromPos,
 			std::list<Direction> listDir;
 			if (player->getPathTo(walkPos, listDir, 0, 0, true, true)) {
 				g_dispatcher.addTask(createTask(std::bind(&Game::playerAutoWalk,
-				                                this, player->getID(), listDir)));
+				                                this, player->getID(), listDir), "Game::playerAutoWalk"));
 
 				SchedulerTask* task = createSchedulerTask(400, std::bind(&Game::playerMoveItemByPlayerID, this,
-				                      player->getID(), itemPos, spriteId, itemStackPos, toPos, count));
+				                      player->getID(), itemPos, spriteId, itemStackPos, toPos, count), "Game::playerMoveItemByPlayerID");
 				player->setNextWalkActionTask(task);
 			} else {
 				player->sendCancelMessage(RETURNVALUE_THEREISNOWAY);
@@ -1734,8 +1711,8 @@ bool Game::playerBroadcastMessage(Player* player, const std::string& text) const
 
 	std::cout << "> " << player->getName() << " broadcasted: \"" << text << "\"." << std::endl;
 
-	for (const auto& it : players) {
-		it.second->sendPrivateMessage(player, TALKTYPE_BROADCAST, text);
+	for (Player* receiver : getPlayers()) {
+		receiver->sendPrivateMessage(player, TALKTYPE_BROADCAST, text);
 	}
 
 	return true;
@@ -2031,10 +2008,10 @@ void Game::playerUseItemEx(uint32_t playerId, const Position& fromPos, uint8_t f
 
 			std::list<Direction> listDir;
 			if (player->getPathTo(walkToPos, listDir, 0, 1, true, true)) {
-				g_dispatcher.addTask(createTask(std::bind(&Game::playerAutoWalk, this, player->getID(), listDir)));
+				g_dispatcher.addTask(createTask(std::bind(&Game::playerAutoWalk, this, player->getID(), listDir), "Game::playerAutoWalk"));
 
 				SchedulerTask* task = createSchedulerTask(400, std::bind(&Game::playerUseItemEx, this,
-				                      playerId, itemPos, itemStackPos, fromSpriteId, toPos, toStackPos, toSpriteId));
+				                      playerId, itemPos, itemStackPos, fromSpriteId, toPos, toStackPos, toSpriteId), "Game::playerUseItemEx");
 				player->setNextWalkActionTask(task);
 			} else {
 				player->sendCancelMessage(RETURNVALUE_THEREISNOWAY);
@@ -2049,7 +2026,7 @@ void Game::playerUseItemEx(uint32_t playerId, const Position& fromPos, uint8_t f
 	if (!player->canDoAction()) {
 		uint32_t delay = player->getNextActionTime();
 		SchedulerTask* task = createSchedulerTask(delay, std::bind(&Game::playerUseItemEx, this,
-		                      playerId, fromPos, fromStackPos, fromSpriteId, toPos, toStackPos, toSpriteId));
+		                      playerId, fromPos, fromStackPos, fromSpriteId, toPos, toStackPos, toSpriteId), "Game::playerUseItemEx");
 		player->setNextActionTask(task);
 		return;
 	}
@@ -2086,10 +2063,10 @@ void Game::playerUseItem(uint32_t playerId, const Position& pos, uint8_t stackPo
 			std::list<Direction> listDir;
 			if (player->getPathTo(pos, listDir, 0, 1, true, true)) {
 				g_dispatcher.addTask(createTask(std::bind(&Game::playerAutoWalk,
-				                                this, player->getID(), listDir)));
+				                                this, player->getID(), listDir), "Game::playerAutoWalk"));
 
 				SchedulerTask* task = createSchedulerTask(400, std::bind(&Game::playerUseItem, this,
-				                      playerId, pos, stackPos, index, spriteId));
+				                      playerId, pos, stackPos, index, spriteId), "Game::playerUseItem");
 				player->setNextWalkActionTask(task);
 				return;
 			}
@@ -2104,7 +2081,7 @@ void Game::playerUseItem(uint32_t playerId, const Position& pos, uint8_t stackPo
 	if (!player->canDoAction()) {
 		uint32_t delay = player->getNextActionTime();
 		SchedulerTask* task = createSchedulerTask(delay, std::bind(&Game::playerUseItem, this,
-		                      playerId, pos, stackPos, index, spriteId));
+		                      playerId, pos, stackPos, index, spriteId), "Game::playerUseItem");
 		player->setNextActionTask(task);
 		return;
 	}
@@ -2173,10 +2150,10 @@ void Game::playerUseWithCreature(uint32_t playerId, const Position& fromPos, uin
 			std::list<Direction> listDir;
 			if (player->getPathTo(walkToPos, listDir, 0, 1, true, true)) {
 				g_dispatcher.addTask(createTask(std::bind(&Game::playerAutoWalk,
-				                                this, player->getID(), listDir)));
+				                                this, player->getID(), listDir), "Game::playerAutoWalk"));
 
 				SchedulerTask* task = createSchedulerTask(400, std::bind(&Game::playerUseWithCreature, this,
-				                      playerId, itemPos, itemStackPos, creatureId, spriteId));
+				                      playerId, itemPos, itemStackPos, creatureId, spriteId), "Game::playerUseWithCreature");
 				player->setNextWalkActionTask(task);
 			} else {
 				player->sendCancelMessage(RETURNVALUE_THEREISNOWAY);
@@ -2191,7 +2168,7 @@ void Game::playerUseWithCreature(uint32_t playerId, const Position& fromPos, uin
 	if (!player->canDoAction()) {
 		uint32_t delay = player->getNextActionTime();
 		SchedulerTask* task = createSchedulerTask(delay, std::bind(&Game::playerUseWithCreature, this,
-		                      playerId, fromPos, fromStackPos, creatureId, spriteId));
+		                      playerId, fromPos, fromStackPos, creatureId, spriteId), "Game::playerUseWithCreature");
 		player->setNextActionTask(task);
 		return;
 	}
@@ -2270,10 +2247,10 @@ void Game::playerRotateItem(uint32_t playerId, const Position& pos, uint8_t stac
 		std::list<Direction> listDir;
 		if (player->getPathTo(pos, listDir, 0, 1, true, true)) {
 			g_dispatcher.addTask(createTask(std::bind(&Game::playerAutoWalk,
-			                                this, player->getID(), listDir)));
+			                                this, player->getID(), listDir), "Game::playerAutoWalk"));
 
 			SchedulerTask* task = createSchedulerTask(400, std::bind(&Game::playerRotateItem, this,
-			                      playerId, pos, stackPos, spriteId));
+			                      playerId, pos, stackPos, spriteId), "Game::playerRotateItem");
 			player->setNextWalkActionTask(task);
 		} else {
 			player->sendCancelMessage(RETURNVALUE_THEREISNOWAY);
@@ -2407,10 +2384,10 @@ void Game::playerWrapItem(uint32_t playerId, const Position& position, uint8_t s
 		std::list<Direction> listDir;
 		if (player->getPathTo(position, listDir, 0, 1, true, true)) {
 			g_dispatcher.addTask(createTask(std::bind(&Game::playerAutoWalk,
-				this, player->getID(), listDir)));
+				this, player->getID(), listDir), "Game::playerAutoWalk"));
 
 			SchedulerTask* task = createSchedulerTask(400, std::bind(&Game::playerWrapItem, this,
-				playerId, position, stackPos, spriteId));
+				playerId, position, stackPos, spriteId), "Game::playerWrapItem");
 			player->setNextWalkActionTask(task);
 		} else {
 			player->sendCancelMessage(RETURNVALUE_THEREISNOWAY);
@@ -2470,10 +2447,10 @@ void Game::playerRequestTrade(uint32_t playerId, const Position& pos, uint8_t st
 		std::list<Direction> listDir;
 		if (player->getPathTo(pos, listDir, 0, 1, true, true)) {
 			g_dispatcher.addTask(createTask(std::bind(&Game::playerAutoWalk,
-			                                this, player->getID(), listDir)));
+			                                this, player->getID(), listDir), "Game::playerAutoWalk"));
 
 			SchedulerTask* task = createSchedulerTask(400, std::bind(&Game::playerRequestTrade, this,
-			                      playerId, pos, stackPos, tradePlayerId, spriteId));
+			                      playerId, pos, stackPos, tradePlayerId, spriteId), "Game::playerRequestTrade");
 			player->setNextWalkActionTask(task);
 		} else {
 			player->sendCancelMessage(RETURNVALUE_THEREISNOWAY);
@@ -2923,7 +2900,7 @@ void Game::playerSetAttackedCreature(uint32_t playerId, uint32_t creatureId)
 	}
 
 	player->setAttackedCreature(attackCreature);
-	g_dispatcher.addTask(createTask(std::bind(&Game::updateCreatureWalk, this, player->getID())));
+	addCreatureWalkUpdate(player);
 }
 
 void Game::playerFollowCreature(uint32_t playerId, uint32_t creatureId)
@@ -2934,7 +2911,7 @@ void Game::playerFollowCreature(uint32_t playerId, uint32_t creatureId)
 	}
 
 	player->setAttackedCreature(nullptr);
-	g_dispatcher.addTask(createTask(std::bind(&Game::updateCreatureWalk, this, player->getID())));
+	addCreatureWalkUpdate(player);
 	player->setFollowCreature(getCreatureByID(creatureId));
 }
 
@@ -3177,7 +3154,7 @@ bool Game::playerSaySpell(Player* player, SpeakClasses type, uint16_t channelId,
 void Game::playerWhisper(Player* player, const std::string& text)
 {
 	SpectatorVec spectators;
-	map.getSpectators(spectators, player->getPosition(), false, false,
+	map.getSpectators(spectators, player->getPosition(), false, true,
 	              Map::maxClientViewportX, Map::maxClientViewportX,
 	              Map::maxClientViewportY, Map::maxClientViewportY);
 
@@ -3193,8 +3170,10 @@ void Game::playerWhisper(Player* player, const std::string& text)
 	}
 
 	//event method
-	for (Creature* spectator : spectators) {
-		spectator->onCreatureSay(player, TALKTYPE_WHISPER, text);
+	SpectatorVec listeners;
+	map.getHearListeners(listeners, player->getPosition(), false, Map::maxClientViewportX, Map::maxClientViewportY);
+	for (Creature* listener : listeners) {
+		listener->onCreatureSay(player, TALKTYPE_WHISPER, text);
 	}
 }
 
@@ -3300,56 +3279,150 @@ bool Game::internalCreatureSay(Creature* creature, SpeakClasses type, const std:
 	}
 
 	SpectatorVec spectators;
+	SpectatorVec listeners;
 
 	if (!spectatorsPtr || spectatorsPtr->empty()) {
-		// This somewhat complex construct ensures that the cached SpectatorVec
-		// is used if available and if it can be used, else a local vector is
-		// used (hopefully the compiler will optimize away the construction of
-		// the temporary when it's not used).
+		// players get the packet, only hear listeners get the event
 		if (type != TALKTYPE_YELL && type != TALKTYPE_MONSTER_YELL) {
-			map.getSpectators(spectators, *pos, false, false,
+			map.getSpectators(spectators, *pos, false, true,
 			              Map::maxClientViewportX, Map::maxClientViewportX,
 			              Map::maxClientViewportY, Map::maxClientViewportY);
+			map.getHearListeners(listeners, *pos, false, Map::maxClientViewportX, Map::maxClientViewportY);
 		} else {
-			map.getSpectators(spectators, *pos, true, false, 18, 18, 14, 14);
+			map.getSpectators(spectators, *pos, true, true, 18, 18, 14, 14);
+			map.getHearListeners(listeners, *pos, true, 18, 14);
 		}
 	} else {
 		spectators = (*spectatorsPtr);
+		for (Creature* spectator : spectators) {
+			if (spectator->isHearListener()) {
+				listeners.emplace_back(spectator);
+			}
+		}
 	}
 
 	//send to client
+	NetworkMessage msg;
+	ProtocolGameBase::AddCreatureSay(msg, creature, type, text, *pos);
 	for (Creature* spectator : spectators) {
 		if (Player* tmpPlayer = spectator->getPlayer()) {
 			if (!ghostMode || tmpPlayer->canSeeCreature(creature)) {
-				tmpPlayer->sendCreatureSay(creature, type, text, pos);
+				tmpPlayer->sendBroadcast(msg);
 			}
 		}
 	}
 
 	//event method
-	for (Creature* spectator : spectators) {
-		spectator->onCreatureSay(creature, type, text);
-		if (creature != spectator) {
-			g_events->eventCreatureOnHear(spectator, creature, text, type);
+	for (Creature* listener : listeners) {
+		listener->onCreatureSay(creature, type, text);
+		if (creature != listener) {
+			g_events->eventCreatureOnHear(listener, creature, text, type);
 		}
 	}
 	return true;
 }
 
-void Game::checkCreatureWalk(uint32_t creatureId)
+void Game::checkCreatureWalk(Creature* creature)
 {
-	Creature* creature = getCreatureByID(creatureId);
-	if (creature && creature->getHealth() > 0) {
+	if (!creature->isRemoved() && creature->getHealth() > 0) {
 		creature->onWalk();
 		cleanup();
 	}
 }
 
-void Game::updateCreatureWalk(uint32_t creatureId)
+uint32_t Game::addCreatureWalk(Creature* creature, int64_t delay)
 {
-	Creature* creature = getCreatureByID(creatureId);
-	if (creature && creature->getHealth() > 0) {
-		creature->goToFollowCreature();
+	if (++lastWalkId == 0) {
+		lastWalkId = 1;
+	}
+
+	int64_t due = OTSYS_TIME() + delay;
+	creature->incrementReferenceCounter();
+	creatureSteps.emplace(due, creature, lastWalkId);
+	scheduleCreatureSteps(due);
+	return lastWalkId;
+}
+
+void Game::addCreatureAttack(Creature* creature, int64_t delay)
+{
+	int64_t due = OTSYS_TIME() + delay;
+	creature->incrementReferenceCounter();
+	creatureSteps.emplace(due, creature, 0);
+	scheduleCreatureSteps(due);
+}
+
+void Game::scheduleCreatureSteps(int64_t due)
+{
+	if (creatureStepsEvent != 0) {
+		if (creatureStepsTime <= due) {
+			return;
+		}
+		g_scheduler.stopEvent(creatureStepsEvent);
+	}
+
+	int64_t delay = std::max<int64_t>(1, due - OTSYS_TIME());
+	creatureStepsTime = OTSYS_TIME() + delay;
+	creatureStepsEvent = g_scheduler.addEvent(createSchedulerTask(delay, std::bind(&Game::checkCreatureSteps, this), "Game::checkCreatureSteps"));
+}
+
+void Game::checkCreatureSteps()
+{
+	creatureStepsEvent = 0;
+
+	startCombatBatch();
+
+	// steps queued while running are due later than now, the loop ends
+	int64_t now = OTSYS_TIME();
+	while (!creatureSteps.empty() && creatureSteps.top().due <= now) {
+		CreatureStep step = creatureSteps.top();
+		creatureSteps.pop();
+
+		Creature* creature = step.creature;
+		if (!creature->isRemoved() && creature->getHealth() > 0) {
+			if (step.walkId == 0) {
+				creature->onAttacking(0);
+			} else if (creature->eventWalk == step.walkId) {
+				// stopEventWalk only forgets the walk id, stale steps end here
+				creature->onWalk();
+			}
+		}
+		ReleaseCreature(creature);
+	}
+
+	endCombatBatch();
+	cleanup();
+
+	if (!creatureSteps.empty()) {
+		scheduleCreatureSteps(creatureSteps.top().due);
+	}
+}
+
+void Game::addCreatureWalkUpdate(Creature* creature)
+{
+	if (creature->walkUpdateQueued) {
+		return;
+	}
+
+	if (creatureWalkUpdates.empty()) {
+		g_dispatcher.addTask(createTask(std::bind(&Game::updateCreatureWalks, this), "Game::updateCreatureWalks"));
+	}
+
+	creature->walkUpdateQueued = true;
+	creature->incrementReferenceCounter();
+	creatureWalkUpdates.push_back(creature);
+}
+
+void Game::updateCreatureWalks()
+{
+	// path updates can queue more updates, those run in the next task
+	std::vector<Creature*> creatures;
+	creatures.swap(creatureWalkUpdates);
+	for (Creature* creature : creatures) {
+		creature->walkUpdateQueued = false;
+		if (!creature->isRemoved() && creature->getHealth() > 0) {
+			creature->goToFollowCreature();
+		}
+		ReleaseCreature(creature);
 	}
 }
 
@@ -3384,7 +3457,9 @@ void Game::removeCreatureCheck(Creature* creature)
 
 void Game::checkCreatures(size_t index)
 {
-	g_scheduler.addEvent(createSchedulerTask(EVENT_CHECK_CREATURE_INTERVAL, std::bind(&Game::checkCreatures, this, (index + 1) % EVENT_CREATURECOUNT)));
+	g_scheduler.addEvent(createSchedulerTask(EVENT_CHECK_CREATURE_INTERVAL, std::bind(&Game::checkCreatures, this, (index + 1) % EVENT_CREATURECOUNT), "Game::checkCreatures"));
+
+	startCombatBatch();
 
 	auto& checkCreatureList = checkCreatureLists[index];
 	auto it = checkCreatureList.begin(), end = checkCreatureList.end();
@@ -3406,6 +3481,7 @@ void Game::checkCreatures(size_t index)
 		}
 	}
 
+	endCombatBatch();
 	cleanup();
 }
 
@@ -3419,8 +3495,11 @@ void Game::changeSpeed(Creature* creature, int32_t varSpeedDelta)
 	//send to clients
 	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), false, true);
+
+	NetworkMessage msg;
+	ProtocolGameBase::AddCreatureSpeed(msg, creature, creature->getStepSpeed());
 	for (Creature* spectator : spectators) {
-		spectator->getPlayer()->sendChangeSpeed(creature, creature->getStepSpeed());
+		spectator->getPlayer()->sendBroadcast(msg);
 	}
 }
 
@@ -3439,8 +3518,11 @@ void Game::internalCreatureChangeOutfit(Creature* creature, const Outfit_t& outf
 	//send to clients
 	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), true, true);
+
+	NetworkMessage msg;
+	ProtocolGameBase::AddCreatureOutfit(msg, creature, outfit);
 	for (Creature* spectator : spectators) {
-		spectator->getPlayer()->sendCreatureChangeOutfit(creature, outfit);
+		spectator->getPlayer()->sendBroadcast(msg, creature);
 	}
 }
 
@@ -3747,7 +3829,7 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 
 				targetPlayer->drainMana(attacker, manaDamage);
 				map.getSpectators(spectators, targetPos, true, true);
-				addMagicEffect(spectators, targetPos, CONST_ME_LOSEENERGY);
+				addCombatEffect(spectators, targetPos, CONST_ME_LOSEENERGY);
 
 				std::stringstream ss;
 
@@ -3755,10 +3837,6 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 
 				std::string spectatorMessage;
 
-				coloredText.text = damageString;
-				coloredText.position = targetPos;
-				coloredText.color = TEXTCOLOR_LIGHTBLUE;
-
 				for (Creature* spectator : spectators) {
 					Player* tmpPlayer = spectator->getPlayer();
 					if (tmpPlayer->getPosition().z != targetPos.z) {
@@ -3806,8 +3884,8 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 						message.text = spectatorMessage;
 					}
 					tmpPlayer->sendTextMessage(message);
-					tmpPlayer->sendColoredText(coloredText);
 				}
+				addCombatText(spectators, targetPos, TEXTCOLOR_LIGHTBLUE, manaDamage);
 
 				damage.primary.value -= manaDamage;
 				if (damage.primary.value < 0) {
@@ -3857,7 +3935,7 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 		if (!coloredText.text.empty()) {
 			combatGetTypeInfo(damage.primary.type, target, coloredText.color, hitEffect);
 			if (hitEffect != CONST_ME_NONE) {
-				addMagicEffect(spectators, targetPos, hitEffect);
+				addCombatEffect(spectators, targetPos, hitEffect);
 			}
 		}
 
@@ -3923,8 +4001,8 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 					message.text = spectatorMessage;
 				}
 				tmpPlayer->sendTextMessage(message);
-				tmpPlayer->sendColoredText(coloredText);
 			}
+			addCombatText(spectators, targetPos, coloredText.color, damage.primary.value);
 		}
 
 		if (realDamage >= targetHealth) {
@@ -3936,7 +4014,7 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 		}
 
 		target->drainHealth(attacker, realDamage);
-		addCreatureHealth(spectators, target);
+		addCombatHealth(spectators, target);
 	}
 
 	return true;
@@ -4085,9 +4163,11 @@ void Game::addCreatureHealth(const Creature* target)
 
 void Game::addCreatureHealth(const SpectatorVec& spectators, const Creature* target)
 {
+	NetworkMessage msg;
+	ProtocolGameBase::AddCreatureHealth(msg, target);
 	for (Creature* spectator : spectators) {
 		if (Player* tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendCreatureHealth(target);
+			tmpPlayer->sendBroadcast(msg);
 		}
 	}
 }
@@ -4101,13 +4181,129 @@ void Game::addMagicEffect(const Position& pos, uint8_t effect)
 
 void Game::addMagicEffect(const SpectatorVec& spectators, const Position& pos, uint8_t effect)
 {
+	NetworkMessage msg;
+	ProtocolGameBase::AddMagicEffect(msg, pos, effect);
 	for (Creature* spectator : spectators) {
 		if (Player* tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendMagicEffect(pos, effect);
+			tmpPlayer->sendBroadcast(msg, pos);
+		}
+	}
+}
+
+void Game::startCombatBatch()
+{
+	if (combatBatchDepth++ == 0) {
+		combatBatchOpen = combatBatching;
+	}
+}
+
+void Game::endCombatBatch()
+{
+	if (--combatBatchDepth != 0 || !combatBatchOpen) {
+		return;
+	}
+
+	combatBatchOpen = false;
+
+	std::sort(combatEffects.begin(), combatEffects.end());
+	combatEffects.erase(std::unique(combatEffects.begin(), combatEffects.end()), combatEffects.end());
+	for (const auto& effect : combatEffects) {
+		SpectatorVec spectators;
+		map.getSpectators(spectators, effect.first, true, true);
+		addMagicEffect(spectators, effect.first, effect.second);
+		combatBatchStats.sent += spectators.size();
+	}
+	combatEffects.clear();
+
+	std::sort(combatTexts.begin(), combatTexts.end(), [](const CombatText& lhs, const CombatText& rhs) {
+		if (lhs.pos == rhs.pos) {
+			return lhs.color < rhs.color;
+		}
+		return lhs.pos < rhs.pos;
+	});
+	for (auto it = combatTexts.begin(), end = combatTexts.end(); it != end;) {
+		CombatText text = *it;
+		while (++it != end && it->pos == text.pos && it->color == text.color) {
+			text.value += it->value;
+		}
+
+		SpectatorVec spectators;
+		map.getSpectators(spectators, text.pos, true, true);
+		combatBatchStats.sent += sendCombatText(spectators, text.pos, text.color, text.value);
+	}
+	combatTexts.clear();
+
+	// creatures that died or left meanwhile have no health bar to update
+	std::sort(combatHealthTargets.begin(), combatHealthTargets.end());
+	combatHealthTargets.erase(std::unique(combatHealthTargets.begin(), combatHealthTargets.end()), combatHealthTargets.end());
+	for (uint32_t creatureId : combatHealthTargets) {
+		Creature* creature = getCreatureByID(creatureId);
+		if (!creature || creature->isRemoved()) {
+			continue;
+		}
+
+		SpectatorVec spectators;
+		map.getSpectators(spectators, creature->getPosition(), true, true);
+		addCreatureHealth(spectators, creature);
+		combatBatchStats.sent += spectators.size();
+	}
+	combatHealthTargets.clear();
+}
+
+void Game::addCombatHealth(const SpectatorVec& spectators, const Creature* target)
+{
+	if (!combatBatchOpen) {
+		addCreatureHealth(spectators, target);
+		return;
+	}
+
+	combatHealthTargets.push_back(target->getID());
+	combatBatchStats.queued += spectators.size();
+}
+
+void Game::addCombatEffect(const SpectatorVec& spectators, const Position& pos, uint8_t effect)
+{
+	if (!combatBatchOpen) {
+		addMagicEffect(spectators, pos, effect);
+		return;
+	}
+
+	combatEffects.emplace_back(pos, effect);
+	combatBatchStats.queued += spectators.size();
+}
+
+void Game::addCombatText(const SpectatorVec& spectators, const Position& pos, TextColor_t color, int32_t value)
+{
+	if (!combatBatchOpen) {
+		sendCombatText(spectators, pos, color, value);
+		return;
+	}
+
+	combatTexts.push_back({pos, color, value});
+	for (Creature* spectator : spectators) {
+		if (spectator->getPosition().z == pos.z) {
+			++combatBatchStats.queued;
 		}
 	}
 }
 
+uint64_t Game::sendCombatText(const SpectatorVec& spectators, const Position& pos, TextColor_t color, int32_t value)
+{
+	// damage numbers are only shown on the floor they happen on
+	ColoredText coloredText(std::to_string(value), pos, color);
+	uint64_t sent = 0;
+	for (Creature* spectator : spectators) {
+		Player* tmpPlayer = spectator->getPlayer();
+		if (!tmpPlayer || tmpPlayer->getPosition().z != pos.z) {
+			continue;
+		}
+
+		tmpPlayer->sendColoredText(coloredText);
+		++sent;
+	}
+	return sent;
+}
+
 void Game::addDistanceEffect(const Position& fromPos, const Position& toPos, uint8_t effect)
 {
 	SpectatorVec spectators, toPosSpectators;
@@ -4120,9 +4316,11 @@ void Game::addDistanceEffect(const Position& fromPos, const Position& toPos, uin
 
 void Game::addDistanceEffect(const SpectatorVec& spectators, const Position& fromPos, const Position& toPos, uint8_t effect)
 {
+	NetworkMessage msg;
+	ProtocolGameBase::AddDistanceShoot(msg, fromPos, toPos, effect);
 	for (Creature* spectator : spectators) {
 		if (Player* tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendDistanceShoot(fromPos, toPos, effect);
+			tmpPlayer->sendBroadcast(msg);
 		}
 	}
 }
@@ -4163,7 +4361,7 @@ void Game::internalDecayItem(Item* item)
 
 void Game::checkDecay()
 {
-	g_scheduler.addEvent(createSchedulerTask(EVENT_DECAYINTERVAL, std::bind(&Game::checkDecay, this)));
+	g_scheduler.addEvent(createSchedulerTask(EVENT_DECAYINTERVAL, std::bind(&Game::checkDecay, this), "Game::checkDecay"));
 
 	size_t bucket = (lastBucket + 1) % EVENT_DECAY_BUCKETS;
 
@@ -4207,7 +4405,7 @@ void Game::checkDecay()
 
 void Game::checkLight()
 {
-	g_scheduler.addEvent(createSchedulerTask(EVENT_LIGHTINTERVAL, std::bind(&Game::checkLight, this)));
+	g_scheduler.addEvent(createSchedulerTask(EVENT_LIGHTINTERVAL, std::bind(&Game::checkLight, this), "Game::checkLight"));
 
 	lightHour += lightHourDelta;
 
@@ -4252,8 +4450,8 @@ void Game::checkLight()
 	if (lightChange) {
 		LightInfo lightInfo = getWorldLightInfo();
 
-		for (const auto& it : players) {
-			it.second->sendWorldLight(lightInfo);
+		for (Player* player : getPlayers()) {
+			player->sendWorldLight(lightInfo);
 		}
 	}
 }
@@ -4321,8 +4519,8 @@ void Game::ReleaseItem(Item* item)
 void Game::broadcastMessage(const std::string& text, MessageClasses type) const
 {
 	std::cout << "> Broadcasted message: \"" << text << "\"." << std::endl;
-	for (const auto& it : players) {
-		it.second->sendTextMessage(type, text);
+	for (Player* player : getPlayers()) {
+		player->sendTextMessage(type, text);
 	}
 }
 
@@ -4765,9 +4963,12 @@ void Game::playerBrowseMarketOwnHistory(uint32_t playerId)
 		return;
 	}
 
-	const HistoryMarketOfferList& buyOffers = IOMarket::getOwnHistory(MARKETACTION_BUY, player->getGUID());
-	const HistoryMarketOfferList& sellOffers = IOMarket::getOwnHistory(MARKETACTION_SELL, player->getGUID());
-	player->sendMarketBrowseOwnHistory(buyOffers, sellOffers);
+	// the first browse reads the history from the database, IOMarket sends it once it arrives
+	HistoryMarketOfferList buyOffers;
+	HistoryMarketOfferList sellOffers;
+	if (IOMarket::getOwnHistory(player->getGUID(), buyOffers, sellOffers)) {
+		player->sendMarketBrowseOwnHistory(buyOffers, sellOffers);
+	}
 }
 
 void Game::playerCreateMarketOffer(uint32_t playerId, uint8_t type, uint16_t spriteId, uint16_t amount, uint32_t price, bool anonymous)
@@ -4867,7 +5068,7 @@ void Game::playerCreateMarketOffer(uint32_t playerId, uint8_t type, uint16_t spr
 		player->bankBalance -= totalPrice;
 	}
 
-	IOMarket::createOffer(player->getGUID(), static_cast<MarketAction_t>(type), it.id, amount, price, anonymous);
+	IOMarket::createOffer(player->getGUID(), player->getName(), static_cast<MarketAction_t>(type), it.id, amount, price, anonymous);
 
 	player->sendMarketEnter(player->getLastDepotId());
 	const MarketOfferList& buyOffers = IOMarket::getActiveOffers(MARKETACTION_BUY, it.id);
@@ -4979,15 +5180,6 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 			return;
 		}
 
-		Player* buyerPlayer = getPlayerByGUID(offer.playerId);
-		if (!buyerPlayer) {
-			buyerPlayer = new Player(nullptr);
-			if (!IOLoginData::loadPlayerById(buyerPlayer, offer.playerId)) {
-				delete buyerPlayer;
-				return;
-			}
-		}
-
 		if (it.stackable) {
 			uint16_t tmpAmount = amount;
 			for (Item* item : itemList) {
@@ -5007,12 +5199,16 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 
 		player->bankBalance += totalPrice;
 
-		if (it.stackable) {
+		Player* buyerPlayer = getPlayerByGUID(offer.playerId);
+		DepotChest* buyerDepotChest = (buyerPlayer ? buyerPlayer->getDepotChest(player->getLastDepotId(), false) : nullptr);
+		if (!buyerDepotChest) {
+			IODelivery::addItemType(offer.playerId, player->getLastDepotId(), it.id, amount);
+		} else if (it.stackable) {
 			uint16_t tmpAmount = amount;
 			while (tmpAmount > 0) {
 				uint16_t stackCount = std::min<uint16_t>(100, tmpAmount);
 				Item* item = Item::CreateItem(it.id, stackCount);
-				if (internalAddItem(buyerPlayer->getDepotChest(player->getLastDepotId(), false), item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
+				if (internalAddItem(buyerDepotChest, item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
 					delete item;
 					break;
 				}
@@ -5029,17 +5225,14 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 
 			for (uint16_t i = 0; i < amount; ++i) {
 				Item* item = Item::CreateItem(it.id, subType);
-				if (internalAddItem(buyerPlayer->getDepotChest(player->getLastDepotId(), false), item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
+				if (internalAddItem(buyerDepotChest, item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
 					delete item;
 					break;
 				}
 			}
 		}
 
-		if (buyerPlayer->isOffline()) {
-			IOLoginData::savePlayer(buyerPlayer);
-			delete buyerPlayer;
-		} else {
+		if (buyerPlayer) {
 			buyerPlayer->onReceiveMail();
 		}
 	} else {
@@ -5082,7 +5275,7 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 		if (sellerPlayer) {
 			sellerPlayer->bankBalance += totalPrice;
 		} else {
-			IOLoginData::increaseBankBalance(offer.playerId, totalPrice);
+			IODelivery::addBankBalance(offer.playerId, totalPrice);
 		}
 
 		player->onReceiveMail();
@@ -5207,7 +5400,8 @@ void Game::addPlayer(Player* player)
 	mappedPlayerNames[lowercase_name] = player;
 	mappedPlayerGuids[player->getGUID()] = player;
 	wildcardTree.insert(lowercase_name);
-	players[player->getID()] = player;
+	player->id = players.add(player);
+	map.spawns.addPlayer(player);
 }
 
 void Game::removePlayer(Player* player)
@@ -5216,27 +5410,30 @@ void Game::removePlayer(Player* player)
 	mappedPlayerNames.erase(lowercase_name);
 	mappedPlayerGuids.erase(player->getGUID());
 	wildcardTree.remove(lowercase_name);
-	players.erase(player->getID());
+	players.remove(player->getID());
+	map.spawns.removePlayer(player);
+
+	IOMarket::unloadHistory(player->getGUID());
 }
 
 void Game::addNpc(Npc* npc)
 {
-	npcs[npc->getID()] = npc;
+	npc->id = npcs.add(npc);
 }
 
 void Game::removeNpc(Npc* npc)
 {
-	npcs.erase(npc->getID());
+	npcs.remove(npc->getID());
 }
 
 void Game::addMonster(Monster* monster)
 {
-	monsters[monster->getID()] = monster;
+	monster->id = monsters.add(monster);
 }
 
 void Game::removeMonster(Monster* monster)
 {
-	monsters.erase(monster->getID());
+	monsters.remove(monster->getID());
 }
 
 Guild* Game::getGuild(uint32_t id) const
@@ -5330,7 +5527,14 @@ bool Game::reload(ReloadTypes_t reloadType)
 	switch (reloadType) {
 		case RELOAD_TYPE_ACTIONS: return g_actions->reload();
 		case RELOAD_TYPE_CHAT: return g_chat->load();
-		case RELOAD_TYPE_CONFIG: return g_config.reload();
+		case RELOAD_TYPE_CONFIG: {
+			if (!g_config.reload()) {
+				return false;
+			}
+
+			setCombatBatching(g_config.getBoolean(ConfigManager::COMBAT_BATCHING));
+			return true;
+		}
 		case RELOAD_TYPE_CREATURESCRIPTS: {
 			g_creatureEvents->reload();
 			g_creatureEvents->removeInvalidEvents();
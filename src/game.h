@@ -27,6 +27,7 @@
 #include "position.h"
 #include "item.h"
 #include "container.h"
+#include "creaturetable.h"
 #include "player.h"
 #include "raids.h"
 #include "npc.h"
@@ -112,6 +113,10 @@ class Game
 			return worldType;
 		}
 
+		void setCombatBatching(bool enabled) {
+			combatBatching = enabled;
+		}
+
 		Cylinder* internalGetCylinder(Player* player, const Position& pos) const;
 		Thing* internalGetThing(Player* player, const Position& pos, int32_t index,
 		                        uint32_t spriteId, stackPosType_t type) const;
@@ -425,8 +430,14 @@ class Game
 		void saveGameState();
 
 		//Events
-		void checkCreatureWalk(uint32_t creatureId);
-		void updateCreatureWalk(uint32_t creatureId);
+		void checkCreatureWalk(Creature* creature);
+		// returns the walk id the creature keeps in eventWalk, the step is
+		// skipped if eventWalk changed in the meantime
+		uint32_t addCreatureWalk(Creature* creature, int64_t delay);
+		void addCreatureWalkUpdate(Creature* creature);
+		void addCreatureAttack(Creature* creature, int64_t delay);
+		void checkCreatureSteps();
+		void updateCreatureWalks();
 		void checkCreatureAttack(uint32_t creatureId);
 		void checkCreatures(size_t index);
 		void checkLight();
@@ -448,6 +459,25 @@ class Game
 		void addDistanceEffect(const Position& fromPos, const Position& toPos, uint8_t effect);
 		static void addDistanceEffect(const SpectatorVec& spectators, const Position& fromPos, const Position& toPos, uint8_t effect);
 
+		// With combatBatching the health bars, hit effects and damage numbers
+		// of a creature check or an area combat wait for the outermost batch
+		// to end. Then every creature gets one health update, every tile one
+		// effect of each kind and one damage number of each color, added up.
+		void startCombatBatch();
+		void endCombatBatch();
+		void addCombatHealth(const SpectatorVec& spectators, const Creature* target);
+		void addCombatEffect(const SpectatorVec& spectators, const Position& pos, uint8_t effect);
+		void addCombatText(const SpectatorVec& spectators, const Position& pos, TextColor_t color, int32_t value);
+
+		// messages to players the batched updates stood for, and those sent
+		struct CombatBatchStats {
+			uint64_t queued = 0;
+			uint64_t sent = 0;
+		};
+		const CombatBatchStats& getCombatBatchStats() const {
+			return combatBatchStats;
+		}
+
 		void startDecay(Item* item);
 		int32_t getLightHour() const {
 			return lightHour;
@@ -462,8 +492,8 @@ class Game
 		uint32_t getMotdNum() const { return motdNum; }
 		void incrementMotdNum() { motdNum++; }
 
-		const std::unordered_map<uint32_t, Player*>& getPlayers() const { return players; }
-		const std::map<uint32_t, Npc*>& getNpcs() const { return npcs; }
+		const std::vector<Player*>& getPlayers() const { return players.getCreatures(); }
+		const std::vector<Npc*>& getNpcs() const { return npcs.getCreatures(); }
 
 		void addPlayer(Player* player);
 		void removePlayer(Player* player);
@@ -521,7 +551,23 @@ class Game
 		void checkDecay();
 		void internalDecayItem(Item* item);
 
-		std::unordered_map<uint32_t, Player*> players;
+		// walk steps and attack checks of all creatures ordered by due time,
+		// one scheduler event armed for the earliest runs everything due
+		struct CreatureStep {
+			CreatureStep(int64_t due, Creature* creature, uint32_t walkId) : due(due), creature(creature), walkId(walkId) {}
+
+			bool operator>(const CreatureStep& other) const {
+				return due > other.due;
+			}
+
+			int64_t due;
+			Creature* creature;
+			uint32_t walkId; // 0 for an attack check
+		};
+
+		void scheduleCreatureSteps(int64_t due);
+
+		CreatureTable<Player> players {PLAYER_ID_FIRST, PLAYER_ID_LAST};
 		std::unordered_map<std::string, Player*> mappedPlayerNames;
 		std::unordered_map<uint32_t, Player*> mappedPlayerGuids;
 		std::unordered_map<uint32_t, Guild*> guilds;
@@ -531,6 +577,28 @@ class Game
 		std::list<Item*> decayItems[EVENT_DECAY_BUCKETS];
 		std::list<Creature*> checkCreatureLists[EVENT_CREATURECOUNT];
 
+		std::priority_queue<CreatureStep, std::vector<CreatureStep>, std::greater<CreatureStep>> creatureSteps;
+		std::vector<Creature*> creatureWalkUpdates;
+		int64_t creatureStepsTime = 0;
+		uint32_t creatureStepsEvent = 0;
+		uint32_t lastWalkId = 0;
+
+		struct CombatText {
+			Position pos;
+			TextColor_t color;
+			int32_t value;
+		};
+
+		static uint64_t sendCombatText(const SpectatorVec& spectators, const Position& pos, TextColor_t color, int32_t value);
+
+		std::vector<uint32_t> combatHealthTargets;
+		std::vector<std::pair<Position, uint8_t>> combatEffects;
+		std::vector<CombatText> combatTexts;
+		CombatBatchStats combatBatchStats;
+		uint32_t combatBatchDepth = 0;
+		bool combatBatching = false;
+		bool combatBatchOpen = false;
+
 		std::vector<Creature*> ToReleaseCreatures;
 		std::vector<Item*> ToReleaseItems;
 
@@ -538,8 +606,8 @@ class Game
 
 		WildcardTreeNode wildcardTree { false };
 
-		std::map<uint32_t, Npc*> npcs;
-		std::map<uint32_t, Monster*> monsters;
+		CreatureTable<Npc> npcs {NPC_ID_FIRST, NPC_ID_LAST};
+		CreatureTable<Monster> monsters {MONSTER_ID_FIRST, MONSTER_ID_LAST};
 
 		//list of items that are in trading state, mapped to the player
 		std::map<Item*, uint32_t> tradeItems;
@@ -22,6 +22,7 @@
 #include "pugicast.h"
 
 #include "house.h"
+#include "iodelivery.h"
 #include "iologindata.h"
 #include "game.h"
 #include "configmanager.h"
@@ -228,15 +229,13 @@ bool House::transferToDepot() const
 
 	Player* player = g_game.getPlayerByGUID(owner);
 	if (player) {
-		transferToDepot(player);
-	} else {
-		Player tmpPlayer(nullptr);
-		if (!IOLoginData::loadPlayerById(&tmpPlayer, owner)) {
-			return false;
-		}
+		return transferToDepot(player);
+	}
 
-		transferToDepot(&tmpPlayer);
-		IOLoginData::savePlayer(&tmpPlayer);
+	// delivered to the depot at the owner's next login
+	for (Item* item : getTransferItems()) {
+		IODelivery::addItem(owner, townId, item);
+		g_game.internalRemoveItem(item, item->getItemCount(), false, FLAG_NOLIMIT);
 	}
 	return true;
 }
@@ -247,6 +246,17 @@ bool House::transferToDepot(Player* player) const
 		return false;
 	}
 
+	for (Item* item : getTransferItems()) {
+		// WARNING: This can fail, that is not the best idea to handle items from houses, but thats the only one.
+		if (DepotLocker* depotLocker = player->getDepotLocker(townId)) {
+			g_game.internalMoveItem(item->getParent(), depotLocker, INDEX_WHEREEVER, item, item->getItemCount(), nullptr, FLAG_NOLIMIT);
+		}
+	}
+	return true;
+}
+
+ItemList House::getTransferItems() const
+{
 	ItemList moveItemList;
 	for (HouseTile* tile : houseTiles) {
 		if (const TileItemVector* items = tile->getItemList()) {
@@ -264,14 +274,7 @@ bool House::transferToDepot(Player* player) const
 			}
 		}
 	}
-
-	for (Item* item : moveItemList) {
-		// WARNING: This can fail, that is not the best idea to handle items from houses, but thats the only one.
-		if (DepotLocker* depotLocker = player->getDepotLocker(townId)) {
-			g_game.internalMoveItem(item->getParent(), depotLocker, INDEX_WHEREEVER, item, item->getItemCount(), nullptr, FLAG_NOLIMIT);
-		}
-	}
-	return true;
+	return moveItemList;
 }
 
 bool House::getAccessList(uint32_t listId, std::string& list) const
@@ -667,6 +670,10 @@ void Houses::payHouses(RentPeriod_t rentPeriod) const
 		return;
 	}
 
+	// the debits of offline owners are queued, an owner of several houses
+	// pays each rent from what is left after the previous one
+	std::map<uint32_t, uint64_t> offlineBalances;
+
 	time_t currentTime = time(nullptr);
 	for (const auto& it : houseMap) {
 		House* house = it.second;
@@ -685,15 +692,33 @@ void Houses::payHouses(RentPeriod_t rentPeriod) const
 			continue;
 		}
 
-		Player player(nullptr);
-		if (!IOLoginData::loadPlayerById(&player, ownerId)) {
-			// Player doesn't exist, reset house owner
-			house->setOwner(0);
-			continue;
+		// offline owners are not loaded, the rent and the letters become deliveries
+		Player* player = g_game.getPlayerByGUID(ownerId);
+
+		uint64_t bankBalance;
+		auto balanceIt = offlineBalances.end();
+		if (player) {
+			bankBalance = player->getBankBalance();
+		} else {
+			balanceIt = offlineBalances.find(ownerId);
+			if (balanceIt == offlineBalances.end()) {
+				if (!IODelivery::getBankBalance(ownerId, bankBalance)) {
+					// Player doesn't exist, reset house owner
+					house->setOwner(0);
+					continue;
+				}
+				balanceIt = offlineBalances.emplace(ownerId, bankBalance).first;
+			}
+			bankBalance = balanceIt->second;
 		}
 
-		if (player.getBankBalance() >= rent) {
-			player.setBankBalance(player.getBankBalance() - rent);
+		if (bankBalance >= rent) {
+			if (player) {
+				player->setBankBalance(bankBalance - rent);
+			} else {
+				IODelivery::addBankBalance(ownerId, -static_cast<int64_t>(rent));
+				balanceIt->second -= rent;
+			}
 
 			time_t paidUntil = currentTime;
 			switch (rentPeriod) {
@@ -745,13 +770,12 @@ void Houses::payHouses(RentPeriod_t rentPeriod) const
 				std::ostringstream ss;
 				ss << "Warning! \nThe " << period << " rent of " << house->getRent() << " gold for your house \"" << house->getName() << "\" is payable. Have it within " << daysLeft << " days or you will lose this house.";
 				letter->setText(ss.str());
-				g_game.internalAddItem(nullptr, letter, INDEX_WHEREEVER, FLAG_NOLIMIT);
+				IODelivery::addItem(ownerId, house->getTownId(), letter);
+				delete letter;
 				house->setPayRentWarnings(house->getPayRentWarnings() + 1);
 			} else {
-				house->setOwner(0, true, &player);
+				house->setOwner(0, true, player);
 			}
 		}
-
-		IOLoginData::savePlayer(&player);
 	}
 }
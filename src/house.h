@@ -226,6 +226,7 @@ class House
 	private:
 		bool transferToDepot() const;
 		bool transferToDepot(Player* player) const;
+		ItemList getTransferItems() const;
 
 		AccessList guestList;
 		AccessList subOwnerList;
@@ -0,0 +1,162 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "otpch.h"
+
+#include "iodelivery.h"
+
+#include "databasetasks.h"
+#include "iomapserialize.h"
+#include "player.h"
+#include "town.h"
+
+void IODelivery::addBankBalance(uint32_t guid, int64_t amount)
+{
+	std::ostringstream query;
+	query << "INSERT INTO `player_deliveries` (`player_id`, `type`, `amount`, `item`) VALUES (" << guid << ',' << static_cast<uint16_t>(DELIVERY_BALANCE) << ',' << amount << ", '')";
+	g_databaseTasks.addTask(query.str());
+}
+
+void IODelivery::addItemType(uint32_t guid, uint16_t depotId, uint16_t itemId, uint16_t amount)
+{
+	std::ostringstream query;
+	query << "INSERT INTO `player_deliveries` (`player_id`, `type`, `depot_id`, `itemtype`, `amount`, `item`) VALUES (" << guid << ',' << static_cast<uint16_t>(DELIVERY_ITEMTYPE) << ',' << depotId << ',' << itemId << ',' << amount << ", '')";
+	g_databaseTasks.addTask(query.str());
+}
+
+void IODelivery::addItem(uint32_t guid, uint16_t depotId, const Item* item)
+{
+	PropWriteStream propWriteStream;
+	IOMapSerialize::saveItem(propWriteStream, item);
+
+	size_t itemSize;
+	const char* itemData = propWriteStream.getStream(itemSize);
+
+	std::ostringstream query;
+	query << "INSERT INTO `player_deliveries` (`player_id`, `type`, `depot_id`, `itemtype`, `item`) VALUES (" << guid << ',' << static_cast<uint16_t>(DELIVERY_ITEM) << ',' << depotId << ',' << item->getID() << ',' << Database::getInstance().escapeBlob(itemData, itemSize) << ')';
+	g_databaseTasks.addTask(query.str());
+}
+
+bool IODelivery::getBankBalance(uint32_t guid, uint64_t& balance)
+{
+	std::ostringstream query;
+	query << "SELECT `balance` + COALESCE((SELECT SUM(`amount`) FROM `player_deliveries` WHERE `player_id` = " << guid << " AND `type` = " << static_cast<uint16_t>(DELIVERY_BALANCE) << "), 0) AS `balance` FROM `players` WHERE `id` = " << guid;
+
+	DBResult_ptr result = Database::getInstance().storeQuery(query.str());
+	if (!result) {
+		return false;
+	}
+
+	balance = std::max<int64_t>(0, result->getNumber<int64_t>("balance"));
+	return true;
+}
+
+std::vector<uint32_t> IODelivery::applyDeliveries(Player* player)
+{
+	std::vector<uint32_t> deliveryIds;
+
+	std::ostringstream query;
+	query << "SELECT `id`, `type`, `depot_id`, `itemtype`, `amount`, `item` FROM `player_deliveries` WHERE `player_id` = " << player->getGUID() << " ORDER BY `id`";
+
+	DBResult_ptr result = Database::getInstance().storeQuery(query.str());
+	if (!result) {
+		return deliveryIds;
+	}
+
+	do {
+		uint32_t deliveryId = result->getNumber<uint32_t>("id");
+
+		DeliveryType_t type = static_cast<DeliveryType_t>(result->getNumber<uint16_t>("type"));
+		if (type == DELIVERY_BALANCE) {
+			int64_t amount = result->getNumber<int64_t>("amount");
+			if (amount < 0 && static_cast<uint64_t>(-amount) > player->getBankBalance()) {
+				player->setBankBalance(0);
+			} else {
+				player->setBankBalance(player->getBankBalance() + amount);
+			}
+			deliveryIds.push_back(deliveryId);
+			continue;
+		}
+
+		uint16_t depotId = result->getNumber<uint16_t>("depot_id");
+		if (depotId == 0) {
+			// kept until the player has a town again
+			Town* town = player->getTown();
+			if (!town) {
+				continue;
+			}
+			depotId = town->getID();
+		}
+
+		deliveryIds.push_back(deliveryId);
+
+		DepotChest* depotChest = player->getDepotChest(depotId, true);
+		if (type == DELIVERY_ITEMTYPE) {
+			const ItemType& itemType = Item::items[result->getNumber<uint16_t>("itemtype")];
+			if (itemType.id == 0) {
+				continue;
+			}
+
+			uint16_t amount = result->getNumber<uint16_t>("amount");
+			if (itemType.stackable) {
+				while (amount > 0) {
+					uint16_t stackCount = std::min<uint16_t>(100, amount);
+					depotChest->internalAddThing(Item::CreateItem(itemType.id, stackCount));
+					amount -= stackCount;
+				}
+			} else {
+				int32_t subType;
+				if (itemType.charges != 0) {
+					subType = itemType.charges;
+				} else {
+					subType = -1;
+				}
+
+				for (uint16_t i = 0; i < amount; ++i) {
+					depotChest->internalAddThing(Item::CreateItem(itemType.id, subType));
+				}
+			}
+		} else if (type == DELIVERY_ITEM) {
+			unsigned long itemSize;
+			const char* itemData = result->getStream("item", itemSize);
+
+			PropStream propStream;
+			propStream.init(itemData, itemSize);
+			if (!IOMapSerialize::loadItem(propStream, depotChest)) {
+				std::cout << "WARNING: Unserialization error in IODelivery::applyDeliveries" << std::endl;
+			}
+		}
+	} while (result->next());
+	return deliveryIds;
+}
+
+bool IODelivery::deleteDeliveries(uint32_t guid, const std::vector<uint32_t>& deliveryIds)
+{
+	std::ostringstream query;
+	query << "DELETE FROM `player_deliveries` WHERE `player_id` = " << guid << " AND `id` IN (";
+	for (size_t i = 0; i < deliveryIds.size(); ++i) {
+		if (i != 0) {
+			query << ',';
+		}
+		query << deliveryIds[i];
+	}
+	query << ')';
+	return Database::getInstance().executeQuery(query.str());
+}
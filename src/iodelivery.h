@@ -0,0 +1,59 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef FS_IODELIVERY_H_4495D0186DF54C9C9ABF3F5805ED913E
+#define FS_IODELIVERY_H_4495D0186DF54C9C9ABF3F5805ED913E
+
+#include "database.h"
+
+class Item;
+class Player;
+
+enum DeliveryType_t : uint8_t {
+	DELIVERY_BALANCE = 0,
+	DELIVERY_ITEMTYPE = 1,
+	DELIVERY_ITEM = 2,
+};
+
+// Money and items for players that are not online. Every delivery is one
+// row in player_deliveries written through g_databaseTasks, the player is
+// never loaded for it. IOLoginData::loadPlayer applies the pending rows
+// and savePlayer deletes them in the transaction that stores the result,
+// a crash in between applies them again on the next login.
+class IODelivery
+{
+	public:
+		// depot id 0 is the depot of the player's town
+		static void addBankBalance(uint32_t guid, int64_t amount);
+		static void addItemType(uint32_t guid, uint16_t depotId, uint16_t itemId, uint16_t amount);
+		// serialized with its contents, the caller still owns the item
+		static void addItem(uint32_t guid, uint16_t depotId, const Item* item);
+
+		// bank balance including the deliveries not applied yet, false if
+		// the player does not exist
+		static bool getBankBalance(uint32_t guid, uint64_t& balance);
+
+		// returns the ids of the deliveries applied, items for the town depot
+		// of a player without a town stay pending
+		static std::vector<uint32_t> applyDeliveries(Player* player);
+		static bool deleteDeliveries(uint32_t guid, const std::vector<uint32_t>& deliveryIds);
+};
+
+#endif
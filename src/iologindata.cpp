@@ -22,6 +22,7 @@
 #include "iologindata.h"
 #include "configmanager.h"
 #include "game.h"
+#include "iodelivery.h"
 
 extern ConfigManager g_config;
 extern Game g_game;
@@ -542,6 +543,9 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 		}
 	}
 
+	//apply money and items delivered while offline
+	player->deliveryIds = IODelivery::applyDeliveries(player);
+
 	//load storage map
 	query.str(std::string());
 	query << "SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = " << player->getGUID();
@@ -801,7 +805,7 @@ bool IOLoginData::savePlayer(Player* player)
 		return false;
 	}
 
-	if (player->lastDepotId != -1) {
+	if (player->lastDepotId != -1 || !player->deliveryIds.empty()) {
 		//save depot items
 		query.str(std::string());
 		query << "DELETE FROM `player_depotitems` WHERE `player_id` = " << player->getGUID();
@@ -847,8 +851,17 @@ bool IOLoginData::savePlayer(Player* player)
 		return false;
 	}
 
+	if (!player->deliveryIds.empty() && !IODelivery::deleteDeliveries(player->getGUID(), player->deliveryIds)) {
+		return false;
+	}
+
 	//End the transaction
-	return transaction.commit();
+	if (!transaction.commit()) {
+		return false;
+	}
+
+	player->deliveryIds.clear();
+	return true;
 }
 
 std::string IOLoginData::getNameByGuid(uint32_t guid)
@@ -943,13 +956,6 @@ void IOLoginData::loadItems(ItemMap& itemMap, DBResult_ptr result)
 	} while (result->next());
 }
 
-void IOLoginData::increaseBankBalance(uint32_t guid, uint64_t bankBalance)
-{
-	std::ostringstream query;
-	query << "UPDATE `players` SET `balance` = `balance` + " << bankBalance << " WHERE `id` = " << guid;
-	Database::getInstance().executeQuery(query.str());
-}
-
 bool IOLoginData::hasBiddedOnHouse(uint32_t guid)
 {
 	Database& db = Database::getInstance();
@@ -22,6 +22,11 @@
 #include "iomap.h"
 
 #include "bed.h"
+#include "depotlocker.h"
+#include "worldsnapshot.h"
+
+#include <condition_variable>
+#include <thread>
 
 /*
 	OTBM_ROOTV1
@@ -61,6 +66,7 @@ Tile* IOMap::createTile(Item*& ground, Item* item, uint16_t x, uint16_t y, uint8
 	}
 
 	tile->internalAddThing(ground);
+	ground->registerDeferred();
 	ground->startDecaying();
 	ground = nullptr;
 	return tile;
@@ -70,7 +76,7 @@ bool IOMap::loadMap(Map* map, const std::string& fileName)
 {
 	int64_t start = OTSYS_TIME();
 	OTB::Loader loader{fileName, OTB::Identifier{{'O', 'T', 'B', 'M'}}};
-	auto& root = loader.parseTree();
+	const OTB::Node& root = loader.getRoot();
 
 	PropStream propStream;
 	if (!loader.getProps(root, propStream)) {
@@ -124,33 +130,146 @@ bool IOMap::loadMap(Map* map, const std::string& fileName)
 	map->width = root_header.width;
 	map->height = root_header.height;
 
-	if (root.children.size() != 1 || root.children[0].type != OTBM_MAP_DATA) {
+	// only the first child is looked at, finding out whether there is another
+	// one would mean scanning past the whole map
+	OTB::ChildIterator mapNodeIt = loader.getChildren(root).begin();
+	if (mapNodeIt == OTB::ChildIterator() || mapNodeIt->type != OTBM_MAP_DATA) {
 		setLastErrorString("Could not read data node.");
 		return false;
 	}
 
-	auto& mapNode = root.children[0];
+	const OTB::Node& mapNode = *mapNodeIt;
 	if (!parseMapDataAttributes(loader, mapNode, *map, fileName)) {
 		return false;
 	}
 
-	for (auto& mapDataNode : mapNode.children) {
-		if (mapDataNode.type == OTBM_TILE_AREA) {
-			if (!parseTileArea(loader, mapDataNode, *map)) {
-				return false;
+	uint32_t threads = loaderThreads != 0 ? loaderThreads : std::thread::hardware_concurrency();
+
+	// This thread scans the map data children and hands each tile area to the
+	// loader threads as soon as its end is found, then commits the areas in
+	// file order as they become ready so the result and the first reported
+	// error are the same as with a single thread. Only the area boundaries are
+	// kept, the tiles and items inside are read by the loader threads.
+	std::mutex stagingLock;
+	std::condition_variable stagingSignal;
+	std::vector<std::unique_ptr<StagedTileArea>> areas;
+	size_t nextArea = 0;
+	bool scanned = false;
+	bool stopDecoding = false;
+
+	std::vector<std::thread> decoders;
+	if (threads > 1) {
+		decoders.reserve(threads);
+		for (uint32_t i = 0; i < threads; ++i) {
+			decoders.emplace_back([&]() {
+				Item::setDeferRegistration(true);
+				while (true) {
+					StagedTileArea* area;
+					{
+						std::unique_lock<std::mutex> lock(stagingLock);
+						stagingSignal.wait(lock, [&]() { return stopDecoding || scanned || nextArea < areas.size(); });
+						if (stopDecoding || nextArea == areas.size()) {
+							break;
+						}
+						area = areas[nextArea++].get();
+					}
+
+					decodeTileArea(loader, *area);
+
+					{
+						std::lock_guard<std::mutex> lockGuard(stagingLock);
+						area->decoded = true;
+					}
+					stagingSignal.notify_all();
+				}
+				Item::setDeferRegistration(false);
+			});
+		}
+	}
+
+	bool success = true;
+	try {
+		std::vector<OTB::Node> mapDataNodes;
+		for (const OTB::Node& mapDataNode : loader.getChildren(mapNode)) {
+			mapDataNodes.push_back(mapDataNode);
+			if (mapDataNode.type == OTBM_TILE_AREA) {
+				{
+					std::lock_guard<std::mutex> lockGuard(stagingLock);
+					areas.emplace_back(new StagedTileArea);
+					areas.back()->node = mapDataNode;
+				}
+				stagingSignal.notify_one();
 			}
-		} else if (mapDataNode.type == OTBM_TOWNS) {
-			if (!parseTowns(loader, mapDataNode, *map)) {
-				return false;
+		}
+
+		{
+			std::lock_guard<std::mutex> lockGuard(stagingLock);
+			scanned = true;
+		}
+		stagingSignal.notify_all();
+
+		size_t areaIndex = 0;
+		for (const OTB::Node& mapDataNode : mapDataNodes) {
+			if (mapDataNode.type == OTBM_TILE_AREA) {
+				StagedTileArea& area = *areas[areaIndex++];
+				if (decoders.empty()) {
+					Item::setDeferRegistration(true);
+					decodeTileArea(loader, area);
+					Item::setDeferRegistration(false);
+				} else {
+					std::unique_lock<std::mutex> lock(stagingLock);
+					stagingSignal.wait(lock, [&area]() { return area.decoded; });
+				}
+
+				// written before committing, that hands the items to the tiles
+				if (recordedAreas && area.error.empty()) {
+					writeSnapshotArea(*recordedAreas, area);
+					++recordedAreaCount;
+				}
+
+				if (!commitTileArea(area, *map)) {
+					success = false;
+					break;
+				}
+			} else if (mapDataNode.type == OTBM_TOWNS) {
+				if (!parseTowns(loader, mapDataNode, *map)) {
+					success = false;
+					break;
+				}
+			} else if (mapDataNode.type == OTBM_WAYPOINTS && headerVersion > 1) {
+				if (!parseWaypoints(loader, mapDataNode, *map)) {
+					success = false;
+					break;
+				}
+			} else {
+				setLastErrorString("Unknown map node.");
+				success = false;
+				break;
 			}
-		} else if (mapDataNode.type == OTBM_WAYPOINTS && headerVersion > 1) {
-			if (!parseWaypoints(loader, mapDataNode, *map)) {
-				return false;
+		}
+	} catch (const OTB::LoadError& err) {
+		setLastErrorString(err.what());
+		success = false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lockGuard(stagingLock);
+		stopDecoding = true;
+	}
+	stagingSignal.notify_all();
+
+	for (std::thread& decoder : decoders) {
+		decoder.join();
+	}
+
+	if (!success) {
+		// items staged after the error never made it to a tile
+		for (auto& area : areas) {
+			for (Item* item : area->items) {
+				delete item;
 			}
-		} else {
-			setLastErrorString("Unknown map node.");
-			return false;
 		}
+		return false;
 	}
 
 	std::cout << "> Map loading time: " << (OTSYS_TIME() - start) / (1000.) << " seconds." << std::endl;
@@ -206,70 +325,70 @@ bool IOMap::parseMapDataAttributes(OTB::Loader& loader, const OTB::Node& mapNode
 	return true;
 }
 
-bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Map& map)
+void IOMap::decodeTileArea(OTB::Loader& loader, StagedTileArea& area)
 {
+	// runs on the loader threads, a malformed area must not take them down
+	try {
+		readTileArea(loader, area);
+	} catch (const OTB::LoadError& err) {
+		area.error = err.what();
+	}
+}
+
+void IOMap::readTileArea(OTB::Loader& loader, StagedTileArea& area)
+{
+	const OTB::Node& tileAreaNode = area.node;
+
 	PropStream propStream;
 	if (!loader.getProps(tileAreaNode, propStream)) {
-		setLastErrorString("Invalid map node.");
-		return false;
+		area.error = "Invalid map node.";
+		return;
 	}
 
 	OTBM_Destination_coords area_coord;
 	if (!propStream.read(area_coord)) {
-		setLastErrorString("Invalid map node.");
-		return false;
+		area.error = "Invalid map node.";
+		return;
 	}
 
 	uint16_t base_x = area_coord.x;
 	uint16_t base_y = area_coord.y;
 	uint16_t z = area_coord.z;
+	area.z = z;
 
-	for (auto& tileNode : tileAreaNode.children) {
+	for (const OTB::Node& tileNode : loader.getChildren(tileAreaNode)) {
 		if (tileNode.type != OTBM_TILE && tileNode.type != OTBM_HOUSETILE) {
-			setLastErrorString("Unknown tile node.");
-			return false;
+			area.error = "Unknown tile node.";
+			return;
 		}
 
 		if (!loader.getProps(tileNode, propStream)) {
-			setLastErrorString("Could not read node data.");
-			return false;
+			area.error = "Could not read node data.";
+			return;
 		}
 
 		OTBM_Tile_coords tile_coord;
 		if (!propStream.read(tile_coord)) {
-			setLastErrorString("Could not read tile position.");
-			return false;
+			area.error = "Could not read tile position.";
+			return;
 		}
 
 		uint16_t x = base_x + tile_coord.x;
 		uint16_t y = base_y + tile_coord.y;
 
-		bool isHouseTile = false;
-		House* house = nullptr;
-		Tile* tile = nullptr;
-		Item* ground_item = nullptr;
-		uint32_t tileflags = TILESTATE_NONE;
-
-		if (tileNode.type == OTBM_HOUSETILE) {
-			uint32_t houseId;
-			if (!propStream.read<uint32_t>(houseId)) {
-				std::ostringstream ss;
-				ss << "[x:" << x << ", y:" << y << ", z:" << z << "] Could not read house id.";
-				setLastErrorString(ss.str());
-				return false;
-			}
-
-			house = map.houses.addHouse(houseId);
-			if (!house) {
-				std::ostringstream ss;
-				ss << "[x:" << x << ", y:" << y << ", z:" << z << "] Could not create house id: " << houseId;
-				setLastErrorString(ss.str());
-				return false;
-			}
-
-			tile = new HouseTile(x, y, z, house);
-			house->addTile(static_cast<HouseTile*>(tile));
-			isHouseTile = true;
+		StagedTile tile;
+		tile.x = x;
+		tile.y = y;
+		tile.houseId = 0;
+		tile.flags = TILESTATE_NONE;
+		tile.itemCount = 0;
+		tile.isHouseTile = tileNode.type == OTBM_HOUSETILE;
+
+		if (tile.isHouseTile && !propStream.read<uint32_t>(tile.houseId)) {
+			std::ostringstream ss;
+			ss << "[x:" << x << ", y:" << y << ", z:" << z << "] Could not read house id.";
+			area.error = ss.str();
+			return;
 		}
 
 		uint8_t attribute;
@@ -281,20 +400,20 @@ bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Ma
 					if (!propStream.read<uint32_t>(flags)) {
 						std::ostringstream ss;
 						ss << "[x:" << x << ", y:" << y << ", z:" << z << "] Failed to read tile flags.";
-						setLastErrorString(ss.str());
-						return false;
+						area.error = ss.str();
+						return;
 					}
 
 					if ((flags & OTBM_TILEFLAG_PROTECTIONZONE) != 0) {
-						tileflags |= TILESTATE_PROTECTIONZONE;
+						tile.flags |= TILESTATE_PROTECTIONZONE;
 					} else if ((flags & OTBM_TILEFLAG_NOPVPZONE) != 0) {
-						tileflags |= TILESTATE_NOPVPZONE;
+						tile.flags |= TILESTATE_NOPVPZONE;
 					} else if ((flags & OTBM_TILEFLAG_PVPZONE) != 0) {
-						tileflags |= TILESTATE_PVPZONE;
+						tile.flags |= TILESTATE_PVPZONE;
 					}
 
 					if ((flags & OTBM_TILEFLAG_NOLOGOUT) != 0) {
-						tileflags |= TILESTATE_NOLOGOUT;
+						tile.flags |= TILESTATE_NOLOGOUT;
 					}
 					break;
 				}
@@ -304,94 +423,115 @@ bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Ma
 					if (!item) {
 						std::ostringstream ss;
 						ss << "[x:" << x << ", y:" << y << ", z:" << z << "] Failed to create item.";
-						setLastErrorString(ss.str());
-						return false;
+						area.error = ss.str();
+						return;
 					}
 
-					if (isHouseTile && item->isMoveable()) {
-						std::cout << "[Warning - IOMap::loadMap] Moveable item with ID: " << item->getID() << ", in house: " << house->getId() << ", at position [x: " << x << ", y: " << y << ", z: " << z << "]." << std::endl;
-						delete item;
-					} else {
-						if (item->getItemCount() == 0) {
-							item->setItemCount(1);
-						}
-
-						if (tile) {
-							tile->internalAddThing(item);
-							item->startDecaying();
-							item->setLoadedFromMap(true);
-						} else if (item->isGroundTile()) {
-							delete ground_item;
-							ground_item = item;
-						} else {
-							tile = createTile(ground_item, item, x, y, z);
-							tile->internalAddThing(item);
-							item->startDecaying();
-							item->setLoadedFromMap(true);
-						}
-					}
+					area.items.push_back(item);
+					++tile.itemCount;
 					break;
 				}
 
 				default:
 					std::ostringstream ss;
 					ss << "[x:" << x << ", y:" << y << ", z:" << z << "] Unknown tile attribute.";
-					setLastErrorString(ss.str());
-					return false;
+					area.error = ss.str();
+					return;
 			}
 		}
 
-		for (auto& itemNode : tileNode.children) {
+		for (const OTB::Node& itemNode : loader.getChildren(tileNode)) {
 			if (itemNode.type != OTBM_ITEM) {
 				std::ostringstream ss;
 				ss << "[x:" << x << ", y:" << y << ", z:" << z << "] Unknown node type.";
-				setLastErrorString(ss.str());
-				return false;
+				area.error = ss.str();
+				return;
 			}
 
 			PropStream stream;
 			if (!loader.getProps(itemNode, stream)) {
-				setLastErrorString("Invalid item node.");
-				return false;
+				area.error = "Invalid item node.";
+				return;
 			}
 
 			Item* item = Item::CreateItem(stream);
 			if (!item) {
 				std::ostringstream ss;
 				ss << "[x:" << x << ", y:" << y << ", z:" << z << "] Failed to create item.";
-				setLastErrorString(ss.str());
-				return false;
+				area.error = ss.str();
+				return;
 			}
 
+			// staged before unserializing so loadMap deletes it on failure, items
+			// are only deleted on the calling thread
+			area.items.push_back(item);
 			if (!item->unserializeItemNode(loader, itemNode, stream)) {
 				std::ostringstream ss;
 				ss << "[x:" << x << ", y:" << y << ", z:" << z << "] Failed to load item " << item->getID() << '.';
+				area.error = ss.str();
+				return;
+			}
+			++tile.itemCount;
+		}
+
+		area.tiles.push_back(tile);
+	}
+}
+
+bool IOMap::commitTileArea(StagedTileArea& area, Map& map)
+{
+	uint16_t z = area.z;
+
+	size_t itemIndex = 0;
+	for (const StagedTile& staged : area.tiles) {
+		uint16_t x = staged.x;
+		uint16_t y = staged.y;
+
+		House* house = nullptr;
+		Tile* tile = nullptr;
+		Item* ground_item = nullptr;
+
+		if (staged.isHouseTile) {
+			house = map.houses.addHouse(staged.houseId);
+			if (!house) {
+				std::ostringstream ss;
+				ss << "[x:" << x << ", y:" << y << ", z:" << z << "] Could not create house id: " << staged.houseId;
 				setLastErrorString(ss.str());
-				delete item;
 				return false;
 			}
 
-			if (isHouseTile && item->isMoveable()) {
+			tile = new HouseTile(x, y, z, house);
+			house->addTile(static_cast<HouseTile*>(tile));
+		}
+
+		for (uint32_t i = 0; i < staged.itemCount; ++i) {
+			Item* item = area.items[itemIndex];
+			area.items[itemIndex++] = nullptr;
+
+			if (staged.isHouseTile && item->isMoveable()) {
 				std::cout << "[Warning - IOMap::loadMap] Moveable item with ID: " << item->getID() << ", in house: " << house->getId() << ", at position [x: " << x << ", y: " << y << ", z: " << z << "]." << std::endl;
 				delete item;
-			} else {
-				if (item->getItemCount() == 0) {
-					item->setItemCount(1);
-				}
+				continue;
+			}
 
-				if (tile) {
-					tile->internalAddThing(item);
-					item->startDecaying();
-					item->setLoadedFromMap(true);
-				} else if (item->isGroundTile()) {
-					delete ground_item;
-					ground_item = item;
-				} else {
-					tile = createTile(ground_item, item, x, y, z);
-					tile->internalAddThing(item);
-					item->startDecaying();
-					item->setLoadedFromMap(true);
-				}
+			if (item->getItemCount() == 0) {
+				item->setItemCount(1);
+			}
+
+			if (tile) {
+				tile->internalAddThing(item);
+				item->registerDeferred();
+				item->startDecaying();
+				item->setLoadedFromMap(true);
+			} else if (item->isGroundTile()) {
+				delete ground_item;
+				ground_item = item;
+			} else {
+				tile = createTile(ground_item, item, x, y, z);
+				tile->internalAddThing(item);
+				item->registerDeferred();
+				item->startDecaying();
+				item->setLoadedFromMap(true);
 			}
 		}
 
@@ -399,16 +539,25 @@ bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Ma
 			tile = createTile(ground_item, nullptr, x, y, z);
 		}
 
-		tile->setFlag(static_cast<tileflags_t>(tileflags));
+		tile->setFlag(static_cast<tileflags_t>(staged.flags));
 
 		map.setTile(x, y, z, tile);
 	}
+
+	if (!area.error.empty()) {
+		setLastErrorString(area.error);
+		return false;
+	}
+
+	// the staged data of a committed area is not needed anymore
+	std::vector<StagedTile>().swap(area.tiles);
+	std::vector<Item*>().swap(area.items);
 	return true;
 }
 
 bool IOMap::parseTowns(OTB::Loader& loader, const OTB::Node& townsNode, Map& map)
 {
-	for (auto& townNode : townsNode.children) {
+	for (const OTB::Node& townNode : loader.getChildren(townsNode)) {
 		PropStream propStream;
 		if (townNode.type != OTBM_TOWN) {
 			setLastErrorString("Unknown town node.");
@@ -455,7 +604,7 @@ bool IOMap::parseTowns(OTB::Loader& loader, const OTB::Node& townsNode, Map& map
 bool IOMap::parseWaypoints(OTB::Loader& loader, const OTB::Node& waypointsNode, Map& map)
 {
 	PropStream propStream;
-	for (auto& node : waypointsNode.children) {
+	for (const OTB::Node& node : loader.getChildren(waypointsNode)) {
 		if (node.type != OTBM_WAYPOINT) {
 			setLastErrorString("Unknown waypoint node.");
 			return false;
@@ -483,3 +632,434 @@ bool IOMap::parseWaypoints(OTB::Loader& loader, const OTB::Node& waypointsNode,
 	return true;
 }
 
+
+/*
+	Snapshot payload, all values in host byte order
+
+	uint16 width, uint16 height, string spawnfile, string housefile
+	uint32 town count, towns: uint32 id, string name, temple position
+	uint32 waypoint count, waypoints: string name, position
+	uint32 area count, areas: uint32 size, uint8 z, uint32 tile count,
+		tiles: uint16 x, uint16 y, uint32 house id, uint32 flags, uint8 house tile, uint32 item count, items
+	uint32 spawn count, spawns: center position, int32 radius,
+		uint32 monster count, monsters: string name, position, uint8 direction, uint32 interval
+		uint32 npc count, npcs: the same as monsters
+
+	Tile areas are kept the way loader threads stage them, before they are
+	committed, so loading a snapshot builds the tiles with the same code.
+*/
+
+namespace {
+
+void writePosition(PropWriteStream& stream, const Position& pos)
+{
+	stream.write<uint16_t>(pos.x);
+	stream.write<uint16_t>(pos.y);
+	stream.write<uint8_t>(pos.z);
+}
+
+bool readPosition(PropStream& stream, Position& pos)
+{
+	return stream.read<uint16_t>(pos.x) && stream.read<uint16_t>(pos.y) && stream.read<uint8_t>(pos.z);
+}
+
+void writeSpawnCreatures(PropWriteStream& stream, const std::vector<SpawnDefinition::Creature>& creatures)
+{
+	stream.write<uint32_t>(creatures.size());
+	for (const SpawnDefinition::Creature& creature : creatures) {
+		stream.writeString(creature.name);
+		writePosition(stream, creature.pos);
+		stream.write<uint8_t>(creature.direction);
+		stream.write<uint32_t>(creature.interval);
+	}
+}
+
+bool readSpawnCreatures(PropStream& stream, std::vector<SpawnDefinition::Creature>& creatures)
+{
+	uint32_t count;
+	if (!stream.read<uint32_t>(count)) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < count; ++i) {
+		SpawnDefinition::Creature creature;
+		uint8_t direction;
+		if (!stream.readString(creature.name) || !readPosition(stream, creature.pos) || !stream.read<uint8_t>(direction) || !stream.read<uint32_t>(creature.interval)) {
+			return false;
+		}
+
+		creature.direction = static_cast<Direction>(direction);
+		creatures.push_back(std::move(creature));
+	}
+	return true;
+}
+
+}
+
+std::string IOMap::getSnapshotFile(const std::string& fileName)
+{
+	return fileName.substr(0, fileName.rfind('.')) + ".snapshot";
+}
+
+bool IOMap::loadSnapshot(Map* map, const std::string& fileName)
+{
+	int64_t start = OTSYS_TIME();
+	WorldSnapshot snapshot(getSnapshotFile(fileName));
+	if (!snapshot.open()) {
+		std::cout << "> World snapshot not used: " << snapshot.getLastErrorString() << std::endl;
+		return false;
+	}
+
+	if (!snapshot.hasSource(fileName)) {
+		std::cout << "> World snapshot not used: It was written for another map." << std::endl;
+		return false;
+	}
+
+	// everything is read and decoded before the map is touched, a snapshot
+	// that can not be loaded leaves nothing behind for loadMap to trip over
+	PropStream& stream = snapshot.getPayload();
+
+	uint16_t width, height;
+	std::string spawnfile, housefile;
+	uint32_t townCount;
+	if (!stream.read<uint16_t>(width) || !stream.read<uint16_t>(height) || !stream.readString(spawnfile) || !stream.readString(housefile) || !stream.read<uint32_t>(townCount)) {
+		std::cout << "[Warning - IOMap::loadSnapshot] Could not read the map header." << std::endl;
+		return false;
+	}
+
+	std::vector<std::tuple<uint32_t, std::string, Position>> towns;
+	for (uint32_t i = 0; i < townCount; ++i) {
+		uint32_t townId;
+		std::string townName;
+		Position templePos;
+		if (!stream.read<uint32_t>(townId) || !stream.readString(townName) || !readPosition(stream, templePos)) {
+			std::cout << "[Warning - IOMap::loadSnapshot] Could not read town data." << std::endl;
+			return false;
+		}
+		towns.emplace_back(townId, std::move(townName), templePos);
+	}
+
+	uint32_t waypointCount;
+	if (!stream.read<uint32_t>(waypointCount)) {
+		std::cout << "[Warning - IOMap::loadSnapshot] Could not read waypoint data." << std::endl;
+		return false;
+	}
+
+	std::vector<std::pair<std::string, Position>> waypoints;
+	for (uint32_t i = 0; i < waypointCount; ++i) {
+		std::string name;
+		Position pos;
+		if (!stream.readString(name) || !readPosition(stream, pos)) {
+			std::cout << "[Warning - IOMap::loadSnapshot] Could not read waypoint data." << std::endl;
+			return false;
+		}
+		waypoints.emplace_back(std::move(name), pos);
+	}
+
+	uint32_t areaCount;
+	if (!stream.read<uint32_t>(areaCount)) {
+		std::cout << "[Warning - IOMap::loadSnapshot] Could not read tile areas." << std::endl;
+		return false;
+	}
+
+	std::vector<PropStream> areaStreams;
+	for (uint32_t i = 0; i < areaCount; ++i) {
+		uint32_t size;
+		areaStreams.emplace_back();
+		if (!stream.read<uint32_t>(size) || !stream.readStream(areaStreams.back(), size)) {
+			std::cout << "[Warning - IOMap::loadSnapshot] Could not read tile areas." << std::endl;
+			return false;
+		}
+	}
+
+	uint32_t spawnCount;
+	if (!stream.read<uint32_t>(spawnCount)) {
+		std::cout << "[Warning - IOMap::loadSnapshot] Could not read spawns." << std::endl;
+		return false;
+	}
+
+	std::vector<SpawnDefinition> spawns(spawnCount);
+	for (SpawnDefinition& spawn : spawns) {
+		if (!readPosition(stream, spawn.centerPos) || !stream.read<int32_t>(spawn.radius) || !readSpawnCreatures(stream, spawn.monsters) || !readSpawnCreatures(stream, spawn.npcs)) {
+			std::cout << "[Warning - IOMap::loadSnapshot] Could not read spawns." << std::endl;
+			return false;
+		}
+	}
+
+	// the areas are independent, every loader thread takes the next one
+	std::vector<StagedTileArea> areas(areaCount);
+	std::atomic<size_t> nextArea {0};
+	auto decodeAreas = [&]() {
+		Item::setDeferRegistration(true);
+		for (size_t i = nextArea++; i < areas.size(); i = nextArea++) {
+			readSnapshotArea(areaStreams[i], areas[i]);
+		}
+		Item::setDeferRegistration(false);
+	};
+
+	uint32_t threads = loaderThreads != 0 ? loaderThreads : std::thread::hardware_concurrency();
+	std::vector<std::thread> decoders;
+	for (uint32_t i = 1; i < threads; ++i) {
+		decoders.emplace_back(decodeAreas);
+	}
+	decodeAreas();
+
+	for (std::thread& decoder : decoders) {
+		decoder.join();
+	}
+
+	for (const StagedTileArea& area : areas) {
+		if (!area.error.empty()) {
+			std::cout << "[Warning - IOMap::loadSnapshot] " << area.error << std::endl;
+			for (const StagedTileArea& stagedArea : areas) {
+				for (Item* item : stagedArea.items) {
+					delete item;
+				}
+			}
+			return false;
+		}
+	}
+
+	map->width = width;
+	map->height = height;
+	map->spawnfile = spawnfile;
+	map->housefile = housefile;
+
+	for (const auto& it : towns) {
+		uint32_t townId = std::get<0>(it);
+		Town* town = map->towns.getTown(townId);
+		if (!town) {
+			town = new Town(townId);
+			map->towns.addTown(townId, town);
+		}
+
+		town->setName(std::get<1>(it));
+		town->setTemplePos(std::get<2>(it));
+	}
+
+	for (auto& it : waypoints) {
+		map->waypoints[it.first] = it.second;
+	}
+
+	// decoded areas only fail to commit if the map loader itself would
+	for (StagedTileArea& area : areas) {
+		commitTileArea(area, *map);
+	}
+
+	map->spawns.load(map->spawnfile, spawns);
+
+	std::cout << "> Map size: " << width << "x" << height << '.' << std::endl;
+	std::cout << "> Map loading time: " << (OTSYS_TIME() - start) / (1000.) << " seconds (snapshot)." << std::endl;
+	return true;
+}
+
+bool IOMap::saveSnapshot(Map* map, const std::string& fileName)
+{
+	if (!recordedAreas) {
+		return false;
+	}
+
+	std::unique_ptr<PropWriteStream> areas = std::move(recordedAreas);
+	uint32_t areaCount = recordedAreaCount;
+	recordedAreaCount = 0;
+
+	// spawns are only kept as built spawns, parsing the file again is cheap
+	// next to the map and only happens when the snapshot is written
+	std::vector<SpawnDefinition> spawns;
+	if (!Spawns::parseXml(map->spawnfile, spawns)) {
+		std::cout << "[Warning - IOMap::saveSnapshot] Could not read " << map->spawnfile << '.' << std::endl;
+		return false;
+	}
+
+	WorldSnapshot snapshot(getSnapshotFile(fileName));
+	for (const std::string& source : {fileName, map->spawnfile, std::string("data/items/items.otb"), std::string("data/items/items.xml")}) {
+		if (!snapshot.addSource(source)) {
+			std::cout << "[Warning - IOMap::saveSnapshot] " << snapshot.getLastErrorString() << std::endl;
+			return false;
+		}
+	}
+
+	PropWriteStream payload;
+	payload.write<uint16_t>(map->width);
+	payload.write<uint16_t>(map->height);
+	payload.writeString(map->spawnfile);
+	payload.writeString(map->housefile);
+
+	const TownMap& towns = map->towns.getTowns();
+	payload.write<uint32_t>(towns.size());
+	for (const auto& it : towns) {
+		const Town* town = it.second;
+		payload.write<uint32_t>(town->getID());
+		payload.writeString(town->getName());
+		writePosition(payload, town->getTemplePosition());
+	}
+
+	payload.write<uint32_t>(map->waypoints.size());
+	for (const auto& it : map->waypoints) {
+		payload.writeString(it.first);
+		writePosition(payload, it.second);
+	}
+
+	size_t areasSize;
+	const char* areaData = areas->getStream(areasSize);
+	payload.write<uint32_t>(areaCount);
+	payload.writeBytes(areaData, areasSize);
+	areas.reset();
+
+	payload.write<uint32_t>(spawns.size());
+	for (const SpawnDefinition& spawn : spawns) {
+		writePosition(payload, spawn.centerPos);
+		payload.write<int32_t>(spawn.radius);
+		writeSpawnCreatures(payload, spawn.monsters);
+		writeSpawnCreatures(payload, spawn.npcs);
+	}
+
+	if (!snapshot.save(payload)) {
+		std::cout << "[Warning - IOMap::saveSnapshot] " << snapshot.getLastErrorString() << std::endl;
+		return false;
+	}
+
+	std::cout << "> World snapshot written to " << snapshot.getFileName() << '.' << std::endl;
+	return true;
+}
+
+void IOMap::writeSnapshotArea(PropWriteStream& stream, const StagedTileArea& area)
+{
+	PropWriteStream areaStream;
+	areaStream.write<uint8_t>(area.z);
+	areaStream.write<uint32_t>(area.tiles.size());
+
+	size_t itemIndex = 0;
+	for (const StagedTile& tile : area.tiles) {
+		areaStream.write<uint16_t>(tile.x);
+		areaStream.write<uint16_t>(tile.y);
+		areaStream.write<uint32_t>(tile.houseId);
+		areaStream.write<uint32_t>(tile.flags);
+		areaStream.write<uint8_t>(tile.isHouseTile ? 1 : 0);
+		areaStream.write<uint32_t>(tile.itemCount);
+		for (uint32_t i = 0; i < tile.itemCount; ++i) {
+			writeSnapshotItem(areaStream, area.items[itemIndex++]);
+		}
+	}
+
+	size_t size;
+	const char* data = areaStream.getStream(size);
+	stream.write<uint32_t>(size);
+	stream.writeBytes(data, size);
+}
+
+void IOMap::writeSnapshotItem(PropWriteStream& stream, const Item* item)
+{
+	stream.write<uint16_t>(item->getID());
+
+	// serializeAttr only covers what players can change, the map attributes
+	// are added here. Doors write nothing at all, house doors are never saved
+	// with the house items.
+	if (const Door* door = item->getDoor()) {
+		door->Item::serializeAttr(stream);
+		if (door->getDoorId() != 0) {
+			stream.write<uint8_t>(ATTR_HOUSEDOORID);
+			stream.write<uint8_t>(door->getDoorId());
+		}
+	} else {
+		item->serializeAttr(stream);
+	}
+
+	if (!Item::items[item->getID()].moveable && item->getActionId() != 0) {
+		stream.write<uint8_t>(ATTR_ACTION_ID);
+		stream.write<uint16_t>(item->getActionId());
+	}
+
+	if (item->getUniqueId() != 0) {
+		stream.write<uint8_t>(ATTR_UNIQUE_ID);
+		stream.write<uint16_t>(item->getUniqueId());
+	}
+
+	if (const DepotLocker* depotLocker = dynamic_cast<const DepotLocker*>(item)) {
+		stream.write<uint8_t>(ATTR_DEPOT_ID);
+		stream.write<uint16_t>(depotLocker->getDepotId());
+	}
+
+	stream.write<uint8_t>(0x00); // attr end
+
+	if (const Container* container = item->getContainer()) {
+		stream.write<uint32_t>(container->size());
+		for (const Item* containerItem : container->getItemList()) {
+			writeSnapshotItem(stream, containerItem);
+		}
+	}
+}
+
+void IOMap::readSnapshotArea(PropStream& stream, StagedTileArea& area)
+{
+	uint8_t z;
+	uint32_t tileCount;
+	if (!stream.read<uint8_t>(z) || !stream.read<uint32_t>(tileCount)) {
+		area.error = "Invalid tile area.";
+		return;
+	}
+	area.z = z;
+
+	for (uint32_t i = 0; i < tileCount; ++i) {
+		StagedTile tile;
+		uint8_t isHouseTile;
+		if (!stream.read<uint16_t>(tile.x) || !stream.read<uint16_t>(tile.y) || !stream.read<uint32_t>(tile.houseId) ||
+		        !stream.read<uint32_t>(tile.flags) || !stream.read<uint8_t>(isHouseTile) || !stream.read<uint32_t>(tile.itemCount)) {
+			area.error = "Invalid tile.";
+			return;
+		}
+		tile.isHouseTile = isHouseTile != 0;
+
+		for (uint32_t j = 0; j < tile.itemCount; ++j) {
+			Item* item = Item::CreateItem(stream);
+			if (!item) {
+				std::ostringstream ss;
+				ss << "[x:" << tile.x << ", y:" << tile.y << ", z:" << static_cast<uint16_t>(z) << "] Failed to create item.";
+				area.error = ss.str();
+				return;
+			}
+
+			// staged first, items are only deleted on the calling thread
+			area.items.push_back(item);
+			if (!readSnapshotItem(stream, item)) {
+				std::ostringstream ss;
+				ss << "[x:" << tile.x << ", y:" << tile.y << ", z:" << static_cast<uint16_t>(z) << "] Failed to load item " << item->getID() << '.';
+				area.error = ss.str();
+				return;
+			}
+		}
+		area.tiles.push_back(tile);
+	}
+}
+
+bool IOMap::readSnapshotItem(PropStream& stream, Item* item)
+{
+	if (!item->unserializeAttr(stream)) {
+		return false;
+	}
+
+	Container* container = item->getContainer();
+	if (!container) {
+		return true;
+	}
+
+	uint32_t count;
+	if (!stream.read<uint32_t>(count)) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < count; ++i) {
+		Item* containerItem = Item::CreateItem(stream);
+		if (!containerItem) {
+			return false;
+		}
+
+		// owned by the container before it is read, see readSnapshotArea
+		container->addItem(containerItem);
+		if (!readSnapshotItem(stream, containerItem)) {
+			return false;
+		}
+		container->updateItemWeight(containerItem->getWeight());
+	}
+	return true;
+}
@@ -147,12 +147,76 @@ class IOMap
 			errorString = error;
 		}
 
+		// 0 uses one thread per core, 1 loads the whole map on the calling thread
+		void setLoaderThreads(uint32_t threads) {
+			loaderThreads = threads;
+		}
+
+		/* Load the map and its spawns from the snapshot next to the map file
+		 * \param map pointer to the Map class
+		 * \param fileName the map file the snapshot was written for
+		 * \returns Returns false and leaves the map untouched if there is no
+		 * usable snapshot
+		 */
+		bool loadSnapshot(Map* map, const std::string& fileName);
+
+		/* Write the snapshot of a map loaded by loadMap with recording enabled
+		 * and its spawns
+		 * \param map pointer to the Map class
+		 * \param fileName the map file that was loaded
+		 * \returns Returns true if the snapshot was written
+		 */
+		bool saveSnapshot(Map* map, const std::string& fileName);
+
+		// keep a copy of the tile areas read by loadMap for saveSnapshot
+		void setSnapshotRecording(bool record) {
+			if (record) {
+				recordedAreas.reset(new PropWriteStream);
+			} else {
+				recordedAreas.reset();
+			}
+			recordedAreaCount = 0;
+		}
+
 	private:
+		// Tile areas are decoded by loader threads into a StagedTileArea, the
+		// items are created but nothing touches the map, houses or g_game until
+		// the area is committed on the calling thread in file order.
+		struct StagedTile {
+			uint16_t x;
+			uint16_t y;
+			uint32_t houseId;
+			uint32_t flags;
+			uint32_t itemCount;
+			bool isHouseTile;
+		};
+
+		struct StagedTileArea {
+			OTB::Node node;
+			std::vector<StagedTile> tiles;
+			std::vector<Item*> items; // items of all tiles in file order, committed ones are set to nullptr
+			std::string error;
+			uint16_t z = 0;
+			bool decoded = false;
+		};
+
 		bool parseMapDataAttributes(OTB::Loader& loader, const OTB::Node& mapNode, Map& map, const std::string& fileName);
 		bool parseWaypoints(OTB::Loader& loader, const OTB::Node& waypointsNode, Map& map);
 		bool parseTowns(OTB::Loader& loader, const OTB::Node& townsNode, Map& map);
-		bool parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Map& map);
+		static void decodeTileArea(OTB::Loader& loader, StagedTileArea& area);
+		static void readTileArea(OTB::Loader& loader, StagedTileArea& area);
+		bool commitTileArea(StagedTileArea& area, Map& map);
+
+		static std::string getSnapshotFile(const std::string& fileName);
+		static void writeSnapshotArea(PropWriteStream& stream, const StagedTileArea& area);
+		static void writeSnapshotItem(PropWriteStream& stream, const Item* item);
+		static void readSnapshotArea(PropStream& stream, StagedTileArea& area);
+		static bool readSnapshotItem(PropStream& stream, Item* item);
+
 		std::string errorString;
+		std::unique_ptr<PropWriteStream> recordedAreas;
+		uint32_t recordedAreaCount = 0;
+		uint32_t loaderThreads = 0;
 };
 
 #endif
@@ -23,40 +23,115 @@
 
 #include "configmanager.h"
 #include "databasetasks.h"
-#include "iologindata.h"
+#include "iodelivery.h"
 #include "game.h"
 #include "scheduler.h"
 
 extern ConfigManager g_config;
 extern Game g_game;
 
+void IOMarket::loadOffers()
+{
+	// the foreign key removes the offers of deleted players, databases
+	// without it keep them and their ids would be given out again
+	Database& db = Database::getInstance();
+	if (!db.executeQuery("DELETE FROM `market_offers` WHERE NOT EXISTS (SELECT 1 FROM `players` WHERE `players`.`id` = `market_offers`.`player_id`)")) {
+		std::cout << "[Warning - IOMarket::loadOffers] Could not remove the offers of deleted players." << std::endl;
+	}
+
+	DBResult_ptr result = db.storeQuery("SELECT `o`.`id`, `o`.`player_id`, `o`.`sale`, `o`.`itemtype`, `o`.`amount`, `o`.`price`, `o`.`created`, `o`.`anonymous`, `p`.`name` FROM `market_offers` AS `o` INNER JOIN `players` AS `p` ON `p`.`id` = `o`.`player_id`");
+	if (!result) {
+		return;
+	}
+
+	do {
+		Offer offer;
+		offer.id = result->getNumber<uint32_t>("id");
+		offer.playerId = result->getNumber<uint32_t>("player_id");
+		offer.type = static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale"));
+		offer.itemId = result->getNumber<uint16_t>("itemtype");
+		offer.amount = result->getNumber<uint16_t>("amount");
+		offer.price = result->getNumber<uint32_t>("price");
+		offer.created = result->getNumber<uint32_t>("created");
+		offer.anonymous = result->getNumber<uint16_t>("anonymous") != 0;
+		offer.playerName = result->getString("name");
+
+		nextOfferId = std::max<uint32_t>(nextOfferId, offer.id + 1);
+		addOffer(std::move(offer));
+	} while (result->next());
+}
+
+void IOMarket::addOffer(Offer&& offer)
+{
+	const Offer& stored = offers.emplace(offer.id, std::move(offer)).first->second;
+	itemOffers[stored.type][stored.itemId].push_back(&stored);
+	playerOffers[stored.playerId].push_back(&stored);
+}
+
+void IOMarket::removeOffer(const Offer& offer)
+{
+	auto removeFrom = [&offer](OfferVector& offerVector) {
+		auto it = std::find(offerVector.begin(), offerVector.end(), &offer);
+		if (it != offerVector.end()) {
+			*it = offerVector.back();
+			offerVector.pop_back();
+		}
+	};
+
+	auto itemIt = itemOffers[offer.type].find(offer.itemId);
+	if (itemIt != itemOffers[offer.type].end()) {
+		removeFrom(itemIt->second);
+		if (itemIt->second.empty()) {
+			itemOffers[offer.type].erase(itemIt);
+		}
+	}
+
+	auto playerIt = playerOffers.find(offer.playerId);
+	if (playerIt != playerOffers.end()) {
+		removeFrom(playerIt->second);
+		if (playerIt->second.empty()) {
+			playerOffers.erase(playerIt);
+		}
+	}
+
+	offers.erase(offer.id);
+}
+
+IOMarket::Offer* IOMarket::getOffer(uint32_t offerId)
+{
+	auto it = offers.find(offerId);
+	if (it == offers.end()) {
+		return nullptr;
+	}
+	return &it->second;
+}
+
 MarketOfferList IOMarket::getActiveOffers(MarketAction_t action, uint16_t itemId)
 {
 	MarketOfferList offerList;
 
-	std::ostringstream query;
-	query << "SELECT `id`, `amount`, `price`, `created`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `sale` = " << action << " AND `itemtype` = " << itemId;
-
-	DBResult_ptr result = Database::getInstance().storeQuery(query.str());
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.itemOffers[action].find(itemId);
+	if (it == market.itemOffers[action].end()) {
 		return offerList;
 	}
 
 	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	do {
+	for (const Offer* activeOffer : it->second) {
 		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint32_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		if (result->getNumber<uint16_t>("anonymous") == 0) {
-			offer.playerName = result->getString("player_name");
+		offer.amount = activeOffer->amount;
+		offer.price = activeOffer->price;
+		offer.timestamp = activeOffer->created + marketOfferDuration;
+		offer.counter = activeOffer->id & 0xFFFF;
+		offer.itemId = activeOffer->itemId;
+		if (!activeOffer->anonymous) {
+			offer.playerName = activeOffer->playerName;
 		} else {
 			offer.playerName = "Anonymous";
 		}
 		offerList.push_back(offer);
-	} while (result->next());
+	}
 	return offerList;
 }
 
@@ -64,216 +139,326 @@ MarketOfferList IOMarket::getOwnOffers(MarketAction_t action, uint32_t playerId)
 {
 	MarketOfferList offerList;
 
-	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
-
-	std::ostringstream query;
-	query << "SELECT `id`, `amount`, `price`, `created`, `itemtype` FROM `market_offers` WHERE `player_id` = " << playerId << " AND `sale` = " << action;
-
-	DBResult_ptr result = Database::getInstance().storeQuery(query.str());
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.playerOffers.find(playerId);
+	if (it == market.playerOffers.end()) {
 		return offerList;
 	}
 
-	do {
+	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
+
+	for (const Offer* activeOffer : it->second) {
+		if (activeOffer->type != action) {
+			continue;
+		}
+
 		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint32_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
+		offer.amount = activeOffer->amount;
+		offer.price = activeOffer->price;
+		offer.timestamp = activeOffer->created + marketOfferDuration;
+		offer.counter = activeOffer->id & 0xFFFF;
+		offer.itemId = activeOffer->itemId;
 		offerList.push_back(offer);
-	} while (result->next());
+	}
 	return offerList;
 }
 
-HistoryMarketOfferList IOMarket::getOwnHistory(MarketAction_t action, uint32_t playerId)
+bool IOMarket::getOwnHistory(uint32_t playerId, HistoryMarketOfferList& buyOffers, HistoryMarketOfferList& sellOffers)
+{
+	IOMarket& market = getInstance();
+	auto it = market.playerHistory.find(playerId);
+	if (it == market.playerHistory.end()) {
+		market.loadHistory(playerId, market.playerHistory[playerId]);
+		return false;
+	}
+
+	const PlayerHistory& history = it->second;
+	if (history.loadId != 0) {
+		return false;
+	}
+
+	buyOffers = history.offers[MARKETACTION_BUY];
+	sellOffers = history.offers[MARKETACTION_SELL];
+	return true;
+}
+
+void IOMarket::unloadHistory(uint32_t playerId)
 {
-	HistoryMarketOfferList offerList;
+	getInstance().playerHistory.erase(playerId);
+}
+
+void IOMarket::loadHistory(uint32_t playerId, PlayerHistory& history)
+{
+	// queued behind the history rows that are still being written, entries
+	// appended from now on go straight to the cache
+	history.loadId = ++historyLoads;
+	if (history.loadId == 0) {
+		history.loadId = ++historyLoads;
+	}
 
 	std::ostringstream query;
-	query << "SELECT `itemtype`, `amount`, `price`, `expires_at`, `state` FROM `market_history` WHERE `player_id` = " << playerId << " AND `sale` = " << action;
+	query << "SELECT `sale`, `itemtype`, `amount`, `price`, `expires_at`, `state` FROM `market_history` WHERE `player_id` = " << playerId << " ORDER BY `id`";
 
-	DBResult_ptr result = Database::getInstance().storeQuery(query.str());
-	if (!result) {
-		return offerList;
+	uint32_t loadId = history.loadId;
+	g_databaseTasks.addTask(query.str(), [playerId, loadId](DBResult_ptr result, bool) {
+		IOMarket::getInstance().onHistoryLoaded(playerId, loadId, result);
+	}, true);
+}
+
+void IOMarket::onHistoryLoaded(uint32_t playerId, uint32_t loadId, DBResult_ptr result)
+{
+	auto it = playerHistory.find(playerId);
+	if (it == playerHistory.end() || it->second.loadId != loadId) {
+		// unloaded while the query was queued
+		return;
 	}
 
-	do {
-		HistoryMarketOffer offer;
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint32_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("expires_at");
+	PlayerHistory& history = it->second;
+	history.loadId = 0;
+
+	HistoryMarketOfferList storedOffers[2];
+	if (result) {
+		do {
+			HistoryMarketOffer offer;
+			offer.itemId = result->getNumber<uint16_t>("itemtype");
+			offer.amount = result->getNumber<uint16_t>("amount");
+			offer.price = result->getNumber<uint32_t>("price");
+			offer.timestamp = result->getNumber<uint32_t>("expires_at");
+
+			MarketOfferState_t offerState = static_cast<MarketOfferState_t>(result->getNumber<uint16_t>("state"));
+			if (offerState == OFFERSTATE_ACCEPTEDEX) {
+				offerState = OFFERSTATE_ACCEPTED;
+			}
 
-		MarketOfferState_t offerState = static_cast<MarketOfferState_t>(result->getNumber<uint16_t>("state"));
-		if (offerState == OFFERSTATE_ACCEPTEDEX) {
-			offerState = OFFERSTATE_ACCEPTED;
-		}
+			offer.state = offerState;
 
-		offer.state = offerState;
+			storedOffers[result->getNumber<uint16_t>("sale") == MARKETACTION_BUY ? MARKETACTION_BUY : MARKETACTION_SELL].push_back(offer);
+		} while (result->next());
+	}
 
-		offerList.push_back(offer);
-	} while (result->next());
-	return offerList;
+	for (size_t i = 0; i < 2; ++i) {
+		storedOffers[i].splice(storedOffers[i].end(), history.offers[i]);
+		history.offers[i] = std::move(storedOffers[i]);
+	}
+
+	Player* player = g_game.getPlayerByGUID(playerId);
+	if (player && player->isInMarket()) {
+		player->sendMarketBrowseOwnHistory(history.offers[MARKETACTION_BUY], history.offers[MARKETACTION_SELL]);
+	}
 }
 
-void IOMarket::processExpiredOffers(DBResult_ptr result, bool)
+void IOMarket::expireOffer(const Offer& offer)
 {
-	if (!result) {
+	// moving the offer to the history frees it, keep what the refund needs
+	const uint32_t playerId = offer.playerId;
+	const uint16_t amount = offer.amount;
+	const uint16_t itemId = offer.itemId;
+	const uint32_t price = offer.price;
+	const MarketAction_t type = offer.type;
+
+	if (!IOMarket::moveOfferToHistory(offer.id, OFFERSTATE_EXPIRED)) {
 		return;
 	}
 
-	do {
-		if (!IOMarket::moveOfferToHistory(result->getNumber<uint32_t>("id"), OFFERSTATE_EXPIRED)) {
-			continue;
+	if (type == MARKETACTION_SELL) {
+		const ItemType& itemType = Item::items[itemId];
+		if (itemType.id == 0) {
+			return;
 		}
 
-		const uint32_t playerId = result->getNumber<uint32_t>("player_id");
-		const uint16_t amount = result->getNumber<uint16_t>("amount");
-		if (result->getNumber<uint16_t>("sale") == 1) {
-			const ItemType& itemType = Item::items[result->getNumber<uint16_t>("itemtype")];
-			if (itemType.id == 0) {
-				continue;
-			}
+		Player* player = g_game.getPlayerByGUID(playerId);
+		DepotChest* depotChest = (player ? player->getDepotChest(player->getLastDepotId(), false) : nullptr);
+		if (!depotChest) {
+			IODelivery::addItemType(playerId, 0, itemType.id, amount);
+			return;
+		}
 
-			Player* player = g_game.getPlayerByGUID(playerId);
-			if (!player) {
-				player = new Player(nullptr);
-				if (!IOLoginData::loadPlayerById(player, playerId)) {
-					delete player;
-					continue;
+		if (itemType.stackable) {
+			uint16_t tmpAmount = amount;
+			while (tmpAmount > 0) {
+				uint16_t stackCount = std::min<uint16_t>(100, tmpAmount);
+				Item* item = Item::CreateItem(itemType.id, stackCount);
+				if (g_game.internalAddItem(depotChest, item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
+					delete item;
+					break;
 				}
-			}
 
-			if (itemType.stackable) {
-				uint16_t tmpAmount = amount;
-				while (tmpAmount > 0) {
-					uint16_t stackCount = std::min<uint16_t>(100, tmpAmount);
-					Item* item = Item::CreateItem(itemType.id, stackCount);
-					if (g_game.internalAddItem(player->getDepotChest(player->getLastDepotId(), false), item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
-						delete item;
-						break;
-					}
-
-					tmpAmount -= stackCount;
-				}
+				tmpAmount -= stackCount;
+			}
+		} else {
+			int32_t subType;
+			if (itemType.charges != 0) {
+				subType = itemType.charges;
 			} else {
-				int32_t subType;
-				if (itemType.charges != 0) {
-					subType = itemType.charges;
-				} else {
-					subType = -1;
-				}
+				subType = -1;
+			}
 
-				for (uint16_t i = 0; i < amount; ++i) {
-					Item* item = Item::CreateItem(itemType.id, subType);
-					if (g_game.internalAddItem(player->getDepotChest(player->getLastDepotId(), false), item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
-						delete item;
-						break;
-					}
+			for (uint16_t i = 0; i < amount; ++i) {
+				Item* item = Item::CreateItem(itemType.id, subType);
+				if (g_game.internalAddItem(depotChest, item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
+					delete item;
+					break;
 				}
 			}
+		}
+	} else {
+		uint64_t totalPrice = static_cast<uint64_t>(price) * amount;
 
-			if (player->isOffline()) {
-				IOLoginData::savePlayer(player);
-				delete player;
-			}
+		Player* player = g_game.getPlayerByGUID(playerId);
+		if (player) {
+			player->setBankBalance(player->getBankBalance() + totalPrice);
 		} else {
-			uint64_t totalPrice = result->getNumber<uint64_t>("price") * amount;
-
-			Player* player = g_game.getPlayerByGUID(playerId);
-			if (player) {
-				player->setBankBalance(player->getBankBalance() + totalPrice);
-			} else {
-				IOLoginData::increaseBankBalance(playerId, totalPrice);
-			}
+			IODelivery::addBankBalance(playerId, totalPrice);
 		}
-	} while (result->next());
+	}
 }
 
 void IOMarket::checkExpiredOffers()
 {
 	const time_t lastExpireDate = time(nullptr) - g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	std::ostringstream query;
-	query << "SELECT `id`, `amount`, `price`, `itemtype`, `player_id`, `sale` FROM `market_offers` WHERE `created` <= " << lastExpireDate;
-	g_databaseTasks.addTask(query.str(), IOMarket::processExpiredOffers, true);
+	// expiring an offer removes it from the book, collect the ids first
+	std::vector<uint32_t> expiredOffers;
+	for (const auto& it : getInstance().offers) {
+		if (it.second.created <= lastExpireDate) {
+			expiredOffers.push_back(it.first);
+		}
+	}
+
+	for (uint32_t offerId : expiredOffers) {
+		if (const Offer* offer = getInstance().getOffer(offerId)) {
+			expireOffer(*offer);
+		}
+	}
 
 	int32_t checkExpiredMarketOffersEachMinutes = g_config.getNumber(ConfigManager::CHECK_EXPIRED_MARKET_OFFERS_EACH_MINUTES);
 	if (checkExpiredMarketOffersEachMinutes <= 0) {
 		return;
 	}
 
-	g_scheduler.addEvent(createSchedulerTask(checkExpiredMarketOffersEachMinutes * 60 * 1000, IOMarket::checkExpiredOffers));
+	g_scheduler.addEvent(createSchedulerTask(checkExpiredMarketOffersEachMinutes * 60 * 1000, IOMarket::checkExpiredOffers, "IOMarket::checkExpiredOffers"));
 }
 
 uint32_t IOMarket::getPlayerOfferCount(uint32_t playerId)
 {
-	std::ostringstream query;
-	query << "SELECT COUNT(*) AS `count` FROM `market_offers` WHERE `player_id` = " << playerId;
-
-	DBResult_ptr result = Database::getInstance().storeQuery(query.str());
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.playerOffers.find(playerId);
+	if (it == market.playerOffers.end()) {
 		return 0;
 	}
-	return result->getNumber<int32_t>("count");
+	return it->second.size();
 }
 
 MarketOfferEx IOMarket::getOfferByCounter(uint32_t timestamp, uint16_t counter)
 {
 	MarketOfferEx offer;
 
-	const int32_t created = timestamp - g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
+	const uint32_t created = timestamp - g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	std::ostringstream query;
-	query << "SELECT `id`, `sale`, `itemtype`, `amount`, `created`, `price`, `player_id`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `created` = " << created << " AND (`id` & 65535) = " << counter << " LIMIT 1";
+	// the client only knows the low 16 bits of the id, try every id that has them
+	IOMarket& market = getInstance();
+	for (uint64_t offerId = counter; offerId < market.nextOfferId; offerId += 0x10000) {
+		const Offer* activeOffer = market.getOffer(offerId);
+		if (!activeOffer || activeOffer->created != created) {
+			continue;
+		}
 
-	DBResult_ptr result = Database::getInstance().storeQuery(query.str());
-	if (!result) {
-		offer.id = 0;
-		offer.playerId = 0;
+		offer.id = activeOffer->id;
+		offer.type = activeOffer->type;
+		offer.amount = activeOffer->amount;
+		offer.counter = activeOffer->id & 0xFFFF;
+		offer.timestamp = activeOffer->created;
+		offer.price = activeOffer->price;
+		offer.itemId = activeOffer->itemId;
+		offer.playerId = activeOffer->playerId;
+		if (!activeOffer->anonymous) {
+			offer.playerName = activeOffer->playerName;
+		} else {
+			offer.playerName = "Anonymous";
+		}
 		return offer;
 	}
 
-	offer.id = result->getNumber<uint32_t>("id");
-	offer.type = static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale"));
-	offer.amount = result->getNumber<uint16_t>("amount");
-	offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-	offer.timestamp = result->getNumber<uint32_t>("created");
-	offer.price = result->getNumber<uint32_t>("price");
-	offer.itemId = result->getNumber<uint16_t>("itemtype");
-	offer.playerId = result->getNumber<uint32_t>("player_id");
-	if (result->getNumber<uint16_t>("anonymous") == 0) {
-		offer.playerName = result->getString("player_name");
-	} else {
-		offer.playerName = "Anonymous";
-	}
+	offer.id = 0;
+	offer.playerId = 0;
 	return offer;
 }
 
-void IOMarket::createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous)
+void IOMarket::createOffer(uint32_t playerId, const std::string& playerName, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous)
 {
+	IOMarket& market = getInstance();
+
+	Offer offer;
+	offer.id = market.nextOfferId++;
+	offer.playerId = playerId;
+	offer.type = action;
+	offer.itemId = itemId;
+	offer.amount = amount;
+	offer.price = price;
+	offer.created = time(nullptr);
+	offer.anonymous = anonymous;
+	offer.playerName = playerName;
+
 	std::ostringstream query;
-	query << "INSERT INTO `market_offers` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `anonymous`) VALUES (" << playerId << ',' << action << ',' << itemId << ',' << amount << ',' << price << ',' << time(nullptr) << ',' << anonymous << ')';
-	Database::getInstance().executeQuery(query.str());
+	query << "INSERT INTO `market_offers` (`id`, `player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `anonymous`) VALUES (" << offer.id << ',' << playerId << ',' << action << ',' << itemId << ',' << amount << ',' << price << ',' << offer.created << ',' << anonymous << ')';
+	g_databaseTasks.addTask(query.str());
+
+	market.addOffer(std::move(offer));
 }
 
 void IOMarket::acceptOffer(uint32_t offerId, uint16_t amount)
 {
+	Offer* offer = getInstance().getOffer(offerId);
+	if (!offer) {
+		return;
+	}
+
+	offer->amount -= amount;
+
 	std::ostringstream query;
 	query << "UPDATE `market_offers` SET `amount` = `amount` - " << amount << " WHERE `id` = " << offerId;
-	Database::getInstance().executeQuery(query.str());
+	g_databaseTasks.addTask(query.str());
 }
 
 void IOMarket::deleteOffer(uint32_t offerId)
 {
+	IOMarket& market = getInstance();
+	if (const Offer* offer = market.getOffer(offerId)) {
+		market.removeOffer(*offer);
+	}
+
 	std::ostringstream query;
 	query << "DELETE FROM `market_offers` WHERE `id` = " << offerId;
-	Database::getInstance().executeQuery(query.str());
+	g_databaseTasks.addTask(query.str());
 }
 
 void IOMarket::appendHistory(uint32_t playerId, MarketAction_t type, uint16_t itemId, uint16_t amount, uint32_t price, time_t timestamp, MarketOfferState_t state)
 {
+	IOMarket& market = getInstance();
+
+	auto it = market.playerHistory.find(playerId);
+	if (it != market.playerHistory.end()) {
+		HistoryMarketOffer offer;
+		offer.itemId = itemId;
+		offer.amount = amount;
+		offer.price = price;
+		offer.timestamp = timestamp;
+		offer.state = (state == OFFERSTATE_ACCEPTEDEX ? OFFERSTATE_ACCEPTED : state);
+		it->second.offers[type].push_back(offer);
+	}
+
+	if (state == OFFERSTATE_ACCEPTED) {
+		MarketStatistics& statistics = (type == MARKETACTION_BUY ? market.purchaseStatistics[itemId] : market.saleStatistics[itemId]);
+		if (statistics.numTransactions == 0 || price < statistics.lowestPrice) {
+			statistics.lowestPrice = price;
+		}
+		if (price > statistics.highestPrice) {
+			statistics.highestPrice = price;
+		}
+		statistics.totalPrice += price;
+		++statistics.numTransactions;
+	}
+
 	std::ostringstream query;
 	query << "INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`) VALUES ("
 		<< playerId << ',' << type << ',' << itemId << ',' << amount << ',' << price << ','
@@ -283,25 +468,25 @@ void IOMarket::appendHistory(uint32_t playerId, MarketAction_t type, uint16_t it
 
 bool IOMarket::moveOfferToHistory(uint32_t offerId, MarketOfferState_t state)
 {
-	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
-
-	Database& db = Database::getInstance();
-
-	std::ostringstream query;
-	query << "SELECT `player_id`, `sale`, `itemtype`, `amount`, `price`, `created` FROM `market_offers` WHERE `id` = " << offerId;
-
-	DBResult_ptr result = db.storeQuery(query.str());
-	if (!result) {
+	IOMarket& market = getInstance();
+	const Offer* offer = market.getOffer(offerId);
+	if (!offer) {
 		return false;
 	}
 
-	query.str(std::string());
+	const uint32_t playerId = offer->playerId;
+	const MarketAction_t type = offer->type;
+	const uint16_t itemId = offer->itemId;
+	const uint16_t amount = offer->amount;
+	const uint32_t price = offer->price;
+	const uint32_t created = offer->created;
+	market.removeOffer(*offer);
+
+	std::ostringstream query;
 	query << "DELETE FROM `market_offers` WHERE `id` = " << offerId;
-	if (!db.executeQuery(query.str())) {
-		return false;
-	}
+	g_databaseTasks.addTask(query.str());
 
-	appendHistory(result->getNumber<uint32_t>("player_id"), static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale")), result->getNumber<uint16_t>("itemtype"), result->getNumber<uint16_t>("amount"), result->getNumber<uint32_t>("price"), result->getNumber<uint32_t>("created") + marketOfferDuration, state);
+	appendHistory(playerId, type, itemId, amount, price, created + g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION), state);
 	return true;
 }
 
@@ -23,6 +23,10 @@
 #include "enums.h"
 #include "database.h"
 
+// Active offers live in memory, indexed per item and side and per player.
+// Browsing never touches the database, every change is written through
+// g_databaseTasks in the order it happened. Offer ids are handed out here
+// instead of by AUTO_INCREMENT so the write can be deferred.
 class IOMarket
 {
 	public:
@@ -31,17 +35,23 @@ class IOMarket
 			return instance;
 		}
 
+		// reads market_offers, call once at startup before the first browse
+		void loadOffers();
+
 		static MarketOfferList getActiveOffers(MarketAction_t action, uint16_t itemId);
 		static MarketOfferList getOwnOffers(MarketAction_t action, uint32_t playerId);
-		static HistoryMarketOfferList getOwnHistory(MarketAction_t action, uint32_t playerId);
+		// false while the history is read from the database, it is sent to the
+		// player once it arrives
+		static bool getOwnHistory(uint32_t playerId, HistoryMarketOfferList& buyOffers, HistoryMarketOfferList& sellOffers);
+		// drops the cached history of a player, it is read again on the next browse
+		static void unloadHistory(uint32_t playerId);
 
-		static void processExpiredOffers(DBResult_ptr result, bool);
 		static void checkExpiredOffers();
 
 		static uint32_t getPlayerOfferCount(uint32_t playerId);
 		static MarketOfferEx getOfferByCounter(uint32_t timestamp, uint16_t counter);
 
-		static void createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous);
+		static void createOffer(uint32_t playerId, const std::string& playerName, MarketAction_t action, uint32_t itemId, uint16_t amount, uint32_t price, bool anonymous);
 		static void acceptOffer(uint32_t offerId, uint16_t amount);
 		static void deleteOffer(uint32_t offerId);
 
@@ -56,6 +66,44 @@ class IOMarket
 	private:
 		IOMarket() = default;
 
+		struct Offer {
+			std::string playerName;
+			uint32_t id;
+			uint32_t playerId;
+			uint32_t created;
+			uint32_t price;
+			uint16_t itemId;
+			uint16_t amount;
+			MarketAction_t type;
+			bool anonymous;
+		};
+
+		using OfferVector = std::vector<const Offer*>;
+
+		struct PlayerHistory {
+			// indexed by MarketAction_t
+			HistoryMarketOfferList offers[2];
+			// non-zero while the database read is queued
+			uint32_t loadId = 0;
+		};
+
+		void addOffer(Offer&& offer);
+		void removeOffer(const Offer& offer);
+		Offer* getOffer(uint32_t offerId);
+
+		void loadHistory(uint32_t playerId, PlayerHistory& history);
+		void onHistoryLoaded(uint32_t playerId, uint32_t loadId, DBResult_ptr result);
+
+		static void expireOffer(const Offer& offer);
+
+		std::unordered_map<uint32_t, Offer> offers;
+		// indexed by MarketAction_t
+		std::unordered_map<uint16_t, OfferVector> itemOffers[2];
+		std::unordered_map<uint32_t, OfferVector> playerOffers;
+		std::unordered_map<uint32_t, PlayerHistory> playerHistory;
+		uint32_t nextOfferId = 1;
+		uint32_t historyLoads = 0;
+
 		std::map<uint16_t, MarketStatistics> purchaseStatistics;
 		std::map<uint16_t, MarketStatistics> saleStatistics;
 };
@@ -37,6 +37,8 @@ extern Vocations g_vocations;
 
 Items Item::items;
 
+static thread_local bool deferRegistration = false;
+
 Item* Item::CreateItem(const uint16_t type, uint16_t count /*= 0*/)
 {
 	Item* newItem = nullptr;
@@ -162,6 +164,11 @@ Item::Item(const uint16_t type, uint16_t count /*= 0*/) :
 	setDefaultDuration();
 }
 
+Item::~Item()
+{
+	LuaScriptInterface::invalidateUserdata(this);
+}
+
 Item::Item(const Item& i) :
 	Thing(), id(i.id), count(i.count), loadedFromMap(i.loadedFromMap)
 {
@@ -201,21 +208,24 @@ bool Item::equals(const Item* otherItem) const
 		return false;
 	}
 
-	const auto& attributeList = attributes->attributes;
-	const auto& otherAttributeList = otherAttributes->attributes;
-	for (const auto& attribute : attributeList) {
-		if (ItemAttributes::isStrAttrType(attribute.type)) {
-			for (const auto& otherAttribute : otherAttributeList) {
-				if (attribute.type == otherAttribute.type && *attribute.value.string != *otherAttribute.value.string) {
-					return false;
-				}
-			}
-		} else {
-			for (const auto& otherAttribute : otherAttributeList) {
-				if (attribute.type == otherAttribute.type && attribute.value.integer != otherAttribute.value.integer) {
-					return false;
-				}
+	// custom attribute maps are never compared
+	if (attributes->hasAttribute(ITEM_ATTRIBUTE_CUSTOM)) {
+		return false;
+	}
+
+	// both have the same attributes, so the same slots
+	const ItemAttributes::Value* values = attributes->getValues();
+	const ItemAttributes::Value* otherValues = otherAttributes->getValues();
+	size_t slot = 0;
+	for (uint32_t bits = attributes->attributeBits; bits != 0; bits &= bits - 1, ++slot) {
+		itemAttrTypes type = static_cast<itemAttrTypes>(bits & ~(bits - 1));
+		if (ItemAttributes::isStrAttrType(type)) {
+			// interned, equal strings share one copy
+			if (values[slot].string != otherValues[slot].string) {
+				return false;
 			}
+		} else if (values[slot].integer != otherValues[slot].integer) {
+			return false;
 		}
 	}
 	return true;
@@ -700,6 +710,23 @@ bool Item::unserializeItemNode(OTB::Loader&, const OTB::Node&, PropStream& propS
 	return unserializeAttr(propStream);
 }
 
+void Item::setDeferRegistration(bool defer)
+{
+	deferRegistration = defer;
+}
+
+bool Item::isRegistrationDeferred()
+{
+	return deferRegistration;
+}
+
+void Item::registerDeferred()
+{
+	if (hasAttribute(ITEM_ATTRIBUTE_UNIQUEID) && !g_game.addUniqueItem(getUniqueId(), this)) {
+		removeAttribute(ITEM_ATTRIBUTE_UNIQUEID);
+	}
+}
+
 void Item::serializeAttr(PropWriteStream& propWriteStream) const
 {
 	const ItemType& it = items[id];
@@ -838,20 +865,20 @@ void Item::serializeAttr(PropWriteStream& propWriteStream) const
 
 bool Item::hasProperty(ITEMPROPERTY prop) const
 {
-	const ItemType& it = items[id];
+	const uint32_t flags = items.getFlags(id);
 	switch (prop) {
-		case CONST_PROP_BLOCKSOLID: return it.blockSolid;
-		case CONST_PROP_MOVEABLE: return it.moveable && !hasAttribute(ITEM_ATTRIBUTE_UNIQUEID);
-		case CONST_PROP_HASHEIGHT: return it.hasHeight;
-		case CONST_PROP_BLOCKPROJECTILE: return it.blockProjectile;
-		case CONST_PROP_BLOCKPATH: return it.blockPathFind;
-		case CONST_PROP_ISVERTICAL: return it.isVertical;
-		case CONST_PROP_ISHORIZONTAL: return it.isHorizontal;
-		case CONST_PROP_IMMOVABLEBLOCKSOLID: return it.blockSolid && (!it.moveable || hasAttribute(ITEM_ATTRIBUTE_UNIQUEID));
-		case CONST_PROP_IMMOVABLEBLOCKPATH: return it.blockPathFind && (!it.moveable || hasAttribute(ITEM_ATTRIBUTE_UNIQUEID));
-		case CONST_PROP_IMMOVABLENOFIELDBLOCKPATH: return !it.isMagicField() && it.blockPathFind && (!it.moveable || hasAttribute(ITEM_ATTRIBUTE_UNIQUEID));
-		case CONST_PROP_NOFIELDBLOCKPATH: return !it.isMagicField() && it.blockPathFind;
-		case CONST_PROP_SUPPORTHANGABLE: return it.isHorizontal || it.isVertical;
+		case CONST_PROP_BLOCKSOLID: return hasBitSet(ITEMTYPEFLAG_BLOCKSOLID, flags);
+		case CONST_PROP_MOVEABLE: return hasBitSet(ITEMTYPEFLAG_MOVEABLE, flags) && !hasAttribute(ITEM_ATTRIBUTE_UNIQUEID);
+		case CONST_PROP_HASHEIGHT: return hasBitSet(ITEMTYPEFLAG_HASHEIGHT, flags);
+		case CONST_PROP_BLOCKPROJECTILE: return hasBitSet(ITEMTYPEFLAG_BLOCKPROJECTILE, flags);
+		case CONST_PROP_BLOCKPATH: return hasBitSet(ITEMTYPEFLAG_BLOCKPATHFIND, flags);
+		case CONST_PROP_ISVERTICAL: return hasBitSet(ITEMTYPEFLAG_VERTICAL, flags);
+		case CONST_PROP_ISHORIZONTAL: return hasBitSet(ITEMTYPEFLAG_HORIZONTAL, flags);
+		case CONST_PROP_IMMOVABLEBLOCKSOLID: return hasBitSet(ITEMTYPEFLAG_BLOCKSOLID, flags) && (!hasBitSet(ITEMTYPEFLAG_MOVEABLE, flags) || hasAttribute(ITEM_ATTRIBUTE_UNIQUEID));
+		case CONST_PROP_IMMOVABLEBLOCKPATH: return hasBitSet(ITEMTYPEFLAG_BLOCKPATHFIND, flags) && (!hasBitSet(ITEMTYPEFLAG_MOVEABLE, flags) || hasAttribute(ITEM_ATTRIBUTE_UNIQUEID));
+		case CONST_PROP_IMMOVABLENOFIELDBLOCKPATH: return !hasBitSet(ITEMTYPEFLAG_MAGICFIELD, flags) && hasBitSet(ITEMTYPEFLAG_BLOCKPATHFIND, flags) && (!hasBitSet(ITEMTYPEFLAG_MOVEABLE, flags) || hasAttribute(ITEM_ATTRIBUTE_UNIQUEID));
+		case CONST_PROP_NOFIELDBLOCKPATH: return !hasBitSet(ITEMTYPEFLAG_MAGICFIELD, flags) && hasBitSet(ITEMTYPEFLAG_BLOCKPATHFIND, flags);
+		case CONST_PROP_SUPPORTHANGABLE: return (flags & (ITEMTYPEFLAG_HORIZONTAL | ITEMTYPEFLAG_VERTICAL)) != 0;
 		default: return false;
 	}
 }
@@ -1564,7 +1591,7 @@ void Item::setUniqueId(uint16_t n)
 		return;
 	}
 
-	if (g_game.addUniqueItem(n, this)) {
+	if (deferRegistration || g_game.addUniqueItem(n, this)) {
 		getAttributes()->setUniqueId(n);
 	}
 }
@@ -1615,17 +1642,104 @@ int64_t ItemAttributes::emptyInt;
 double ItemAttributes::emptyDouble;
 bool ItemAttributes::emptyBool;
 
+ItemAttributes::ItemAttributes(const ItemAttributes& other) : attributeBits(other.attributeBits)
+{
+	size_t size = std::bitset<32>(attributeBits).count();
+	if (size > INLINE_VALUES) {
+		capacity = static_cast<uint8_t>(size);
+		values = new Value[size];
+	}
+
+	const Value* otherValues = other.getValues();
+	Value* ownValues = getValues();
+	size_t slot = 0;
+	for (uint32_t bits = attributeBits; bits != 0; bits &= bits - 1, ++slot) {
+		itemAttrTypes type = static_cast<itemAttrTypes>(bits & ~(bits - 1));
+		if (isStrAttrType(type)) {
+			ownValues[slot].string = acquireString(*otherValues[slot].string);
+		} else if (isCustomAttrType(type)) {
+			ownValues[slot].custom = new CustomAttributeMap(*otherValues[slot].custom);
+		} else {
+			ownValues[slot].integer = otherValues[slot].integer;
+		}
+	}
+}
+
+ItemAttributes::~ItemAttributes()
+{
+	Value* ownValues = getValues();
+	size_t slot = 0;
+	for (uint32_t bits = attributeBits; bits != 0; bits &= bits - 1, ++slot) {
+		releaseValue(static_cast<itemAttrTypes>(bits & ~(bits - 1)), ownValues[slot]);
+	}
+
+	if (capacity > INLINE_VALUES) {
+		delete[] values;
+	}
+}
+
+namespace {
+
+// The interned attribute strings with the number of attributes using them.
+// Items are created on the map loader threads too, hence the lock. Never
+// destroyed, items may still be released while statics are torn down.
+struct StringPool {
+	std::mutex lock;
+	std::unordered_map<std::string, uint32_t> strings;
+};
+
+StringPool& getStringPool()
+{
+	static StringPool* pool = new StringPool;
+	return *pool;
+}
+
+}
+
+const std::string* ItemAttributes::acquireString(const std::string& value)
+{
+	StringPool& pool = getStringPool();
+	std::lock_guard<std::mutex> lockGuard(pool.lock);
+	auto it = pool.strings.find(value);
+	if (it == pool.strings.end()) {
+		it = pool.strings.emplace(value, 0).first;
+	}
+	++it->second;
+	return &it->first;
+}
+
+void ItemAttributes::releaseString(const std::string* value)
+{
+	StringPool& pool = getStringPool();
+	std::lock_guard<std::mutex> lockGuard(pool.lock);
+	auto it = pool.strings.find(*value);
+	if (it != pool.strings.end() && --it->second == 0) {
+		pool.strings.erase(it);
+	}
+}
+
+void ItemAttributes::releaseValue(itemAttrTypes type, Value& value)
+{
+	if (isStrAttrType(type)) {
+		if (value.string) {
+			releaseString(value.string);
+		}
+	} else if (isCustomAttrType(type)) {
+		delete value.custom;
+	}
+}
+
 const std::string& ItemAttributes::getStrAttr(itemAttrTypes type) const
 {
 	if (!isStrAttrType(type)) {
 		return emptyString;
 	}
 
-	const Attribute* attr = getExistingAttr(type);
-	if (!attr) {
+	const Value* value = getExistingValue(type);
+	if (!value) {
 		return emptyString;
 	}
-	return *attr->value.string;
+	return *value->string;
 }
 
 void ItemAttributes::setStrAttr(itemAttrTypes type, const std::string& value)
@@ -1638,9 +1752,13 @@ void ItemAttributes::setStrAttr(itemAttrTypes type, const std::string& value)
 		return;
 	}
 
-	Attribute& attr = getAttr(type);
-	delete attr.value.string;
-	attr.value.string = new std::string(value);
+	const std::string* string = acquireString(value);
+
+	Value& attr = getValue(type);
+	if (attr.string) {
+		releaseString(attr.string);
+	}
+	attr.string = string;
 }
 
 void ItemAttributes::removeAttribute(itemAttrTypes type)
@@ -1649,20 +1767,12 @@ void ItemAttributes::removeAttribute(itemAttrTypes type)
 		return;
 	}
 
-	auto prev_it = attributes.rbegin();
-	if ((*prev_it).type == type) {
-		attributes.pop_back();
-	} else {
-		auto it = prev_it, end = attributes.rend();
-		while (++it != end) {
-			if ((*it).type == type) {
-				(*it) = attributes.back();
-				attributes.pop_back();
-				break;
-			}
-			prev_it = it;
-		}
-	}
+	size_t size = std::bitset<32>(attributeBits).count();
+	size_t slot = getSlot(type);
+
+	Value* ownValues = getValues();
+	releaseValue(type, ownValues[slot]);
+	std::move(ownValues + slot + 1, ownValues + size, ownValues + slot);
 	attributeBits &= ~type;
 }
 
@@ -1672,11 +1782,11 @@ int64_t ItemAttributes::getIntAttr(itemAttrTypes type) const
 		return 0;
 	}
 
-	const Attribute* attr = getExistingAttr(type);
-	if (!attr) {
+	const Value* value = getExistingValue(type);
+	if (!value) {
 		return 0;
 	}
-	return attr->value.integer;
+	return value->integer;
 }
 
 void ItemAttributes::setIntAttr(itemAttrTypes type, int64_t value)
@@ -1685,7 +1795,7 @@ void ItemAttributes::setIntAttr(itemAttrTypes type, int64_t value)
 		return;
 	}
 
-	getAttr(type).value.integer = value;
+	getValue(type).integer = value;
 }
 
 void ItemAttributes::increaseIntAttr(itemAttrTypes type, int64_t value)
@@ -1694,34 +1804,41 @@ void ItemAttributes::increaseIntAttr(itemAttrTypes type, int64_t value)
 		return;
 	}
 
-	getAttr(type).value.integer += value;
+	getValue(type).integer += value;
 }
 
-const ItemAttributes::Attribute* ItemAttributes::getExistingAttr(itemAttrTypes type) const
+const ItemAttributes::Value* ItemAttributes::getExistingValue(itemAttrTypes type) const
 {
-	if (hasAttribute(type)) {
-		for (const Attribute& attribute : attributes) {
-			if (attribute.type == type) {
-				return &attribute;
-			}
-		}
+	if (!hasAttribute(type)) {
+		return nullptr;
 	}
-	return nullptr;
+	return getValues() + getSlot(type);
 }
 
-ItemAttributes::Attribute& ItemAttributes::getAttr(itemAttrTypes type)
+ItemAttributes::Value& ItemAttributes::getValue(itemAttrTypes type)
 {
+	size_t slot = getSlot(type);
 	if (hasAttribute(type)) {
-		for (Attribute& attribute : attributes) {
-			if (attribute.type == type) {
-				return attribute;
-			}
+		return getValues()[slot];
+	}
+
+	size_t size = std::bitset<32>(attributeBits).count();
+	if (size == capacity) {
+		// attributes are rarely added after an item is set up, grow by one slot
+		Value* newValues = new Value[size + 1];
+		std::copy(getValues(), getValues() + size, newValues);
+		if (capacity > INLINE_VALUES) {
+			delete[] values;
 		}
+		values = newValues;
+		capacity = static_cast<uint8_t>(size + 1);
 	}
 
+	Value* ownValues = getValues();
+	std::move_backward(ownValues + slot, ownValues + size, ownValues + size + 1);
+	ownValues[slot].integer = 0;
 	attributeBits |= type;
-	attributes.emplace_back(type);
-	return attributes.back();
+	return ownValues[slot];
 }
 
 void Item::startDecaying()
@@ -1735,20 +1852,16 @@ bool Item::hasMarketAttributes() const
 		return true;
 	}
 
-	for (const auto& attr : attributes->getList()) {
-		if (attr.type == ITEM_ATTRIBUTE_CHARGES) {
-			uint16_t charges = static_cast<uint16_t>(attr.value.integer);
-			if (charges != items[id].charges) {
-				return false;
-			}
-		} else if (attr.type == ITEM_ATTRIBUTE_DURATION) {
-			uint32_t duration = static_cast<uint32_t>(attr.value.integer);
-			if (duration != getDefaultDuration()) {
-				return false;
-			}
-		} else {
-			return false;
-		}
+	if ((attributes->attributeBits & ~(ITEM_ATTRIBUTE_CHARGES | ITEM_ATTRIBUTE_DURATION)) != 0) {
+		return false;
+	}
+
+	if (hasAttribute(ITEM_ATTRIBUTE_CHARGES) && static_cast<uint16_t>(getIntAttr(ITEM_ATTRIBUTE_CHARGES)) != items[id].charges) {
+		return false;
+	}
+
+	if (hasAttribute(ITEM_ATTRIBUTE_DURATION) && static_cast<uint32_t>(getIntAttr(ITEM_ATTRIBUTE_DURATION)) != getDefaultDuration()) {
+		return false;
 	}
 	return true;
 }
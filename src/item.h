@@ -24,11 +24,13 @@
 #include "thing.h"
 #include "items.h"
 #include "luascript.h"
+#include "slaballocator.h"
 #include "tools.h"
 #include <typeinfo>
 
 #include <boost/variant.hpp>
 #include <boost/lexical_cast.hpp>
+#include <bitset>
 #include <deque>
 
 class Creature;
@@ -118,6 +120,11 @@ class ItemAttributes
 {
 	public:
 		ItemAttributes() = default;
+		ItemAttributes(const ItemAttributes& other);
+		~ItemAttributes();
+
+		// non-assignable
+		ItemAttributes& operator=(const ItemAttributes&) = delete;
 
 		void setSpecialDescription(const std::string& desc) {
 			setStrAttr(ITEM_ATTRIBUTE_DESCRIPTION, desc);
@@ -353,70 +360,39 @@ class ItemAttributes
 
 		typedef std::unordered_map<std::string, CustomAttribute> CustomAttributeMap;
 
-		struct Attribute
-		{
-			union {
-				int64_t integer;
-				std::string* string;
-				CustomAttributeMap* custom;
-			} value;
-			itemAttrTypes type;
-
-			explicit Attribute(itemAttrTypes type) : type(type) {
-				memset(&value, 0, sizeof(value));
-			}
-			Attribute(const Attribute& i) {
-				type = i.type;
-				if (ItemAttributes::isIntAttrType(type)) {
-					value.integer = i.value.integer;
-				} else if (ItemAttributes::isStrAttrType(type)) {
-					value.string = new std::string(*i.value.string);
-				} else if (ItemAttributes::isCustomAttrType(type)) {
-					value.custom = new CustomAttributeMap(*i.value.custom);
-				} else {
-					memset(&value, 0, sizeof(value));
-				}
-			}
-			Attribute(Attribute&& attribute) : value(attribute.value), type(attribute.type) {
-				memset(&attribute.value, 0, sizeof(value));
-				attribute.type = ITEM_ATTRIBUTE_NONE;
-			}
-			~Attribute() {
-				if (ItemAttributes::isStrAttrType(type)) {
-					delete value.string;
-				} else if (ItemAttributes::isCustomAttrType(type)) {
-					delete value.custom;
-				}
-			}
-			Attribute& operator=(Attribute other) {
-				Attribute::swap(*this, other);
-				return *this;
-			}
-			Attribute& operator=(Attribute&& other) {
-				if (this != &other) {
-					if (ItemAttributes::isStrAttrType(type)) {
-						delete value.string;
-					} else if (ItemAttributes::isCustomAttrType(type)) {
-						delete value.custom;
-					}
-
-					value = other.value;
-					type = other.type;
+		// Every attribute takes one 8 byte slot, the slots are ordered by
+		// attribute bit so the slot of an attribute is the number of lower bits
+		// set in attributeBits. Up to INLINE_VALUES slots live in the object
+		// itself, so an item with one or two attributes costs one small
+		// allocation. Strings are interned and shared between items.
+		union Value {
+			int64_t integer;
+			const std::string* string;
+			CustomAttributeMap* custom;
+		};
 
-					memset(&other.value, 0, sizeof(value));
-					other.type = ITEM_ATTRIBUTE_NONE;
-				}
-				return *this;
-			}
+		static constexpr uint8_t INLINE_VALUES = 2;
 
-			static void swap(Attribute& first, Attribute& second) {
-				std::swap(first.value, second.value);
-				std::swap(first.type, second.type);
-			}
+		uint32_t attributeBits = 0;
+		uint8_t capacity = INLINE_VALUES;
+		union {
+			Value inlineValues[INLINE_VALUES];
+			Value* values;
 		};
 
-		std::vector<Attribute> attributes;
-		uint32_t attributeBits = 0;
+		Value* getValues() {
+			return capacity > INLINE_VALUES ? values : inlineValues;
+		}
+		const Value* getValues() const {
+			return capacity > INLINE_VALUES ? values : inlineValues;
+		}
+		size_t getSlot(itemAttrTypes type) const {
+			return std::bitset<32>(attributeBits & (type - 1)).count();
+		}
+
+		static const std::string* acquireString(const std::string& value);
+		static void releaseString(const std::string* value);
+		static void releaseValue(itemAttrTypes type, Value& value);
 
 		const std::string& getStrAttr(itemAttrTypes type) const;
 		void setStrAttr(itemAttrTypes type, const std::string& value);
@@ -425,15 +401,15 @@ class ItemAttributes
 		void setIntAttr(itemAttrTypes type, int64_t value);
 		void increaseIntAttr(itemAttrTypes type, int64_t value);
 
-		const Attribute* getExistingAttr(itemAttrTypes type) const;
-		Attribute& getAttr(itemAttrTypes type);
+		const Value* getExistingValue(itemAttrTypes type) const;
+		Value& getValue(itemAttrTypes type);
 
 		CustomAttributeMap* getCustomAttributeMap() {
 			if (!hasAttribute(ITEM_ATTRIBUTE_CUSTOM)) {
 				return nullptr;
 			}
 
-			return getAttr(ITEM_ATTRIBUTE_CUSTOM).value.custom;
+			return getValue(ITEM_ATTRIBUTE_CUSTOM).custom;
 		}
 
 		template<typename R>
@@ -453,9 +429,9 @@ class ItemAttributes
 			if (hasAttribute(ITEM_ATTRIBUTE_CUSTOM)) {
 				removeCustomAttribute(key);
 			} else {
-				getAttr(ITEM_ATTRIBUTE_CUSTOM).value.custom = new CustomAttributeMap();
+				getValue(ITEM_ATTRIBUTE_CUSTOM).custom = new CustomAttributeMap();
 			}
-			getAttr(ITEM_ATTRIBUTE_CUSTOM).value.custom->emplace(key, value);
+			getValue(ITEM_ATTRIBUTE_CUSTOM).custom->emplace(key, value);
 		}
 
 		void setCustomAttribute(std::string& key, CustomAttribute& value) {
@@ -463,9 +439,9 @@ class ItemAttributes
 			if (hasAttribute(ITEM_ATTRIBUTE_CUSTOM)) {
 				removeCustomAttribute(key);
 			} else {
-				getAttr(ITEM_ATTRIBUTE_CUSTOM).value.custom = new CustomAttributeMap();
+				getValue(ITEM_ATTRIBUTE_CUSTOM).custom = new CustomAttributeMap();
 			}
-			getAttr(ITEM_ATTRIBUTE_CUSTOM).value.custom->insert(std::make_pair(std::move(key), std::move(value)));
+			getValue(ITEM_ATTRIBUTE_CUSTOM).custom->insert(std::make_pair(std::move(key), std::move(value)));
 		}
 
 		const CustomAttribute* getCustomAttribute(int64_t key) {
@@ -518,14 +494,10 @@ class ItemAttributes
 			return (type & ITEM_ATTRIBUTE_CUSTOM) == type;
 		}
 
-		const std::vector<Attribute>& getList() const {
-			return attributes;
-		}
-
 	friend class Item;
 };
 
-class Item : virtual public Thing
+class Item : virtual public Thing, public SlabAllocated
 {
 	public:
 		//Factory member to create item of right type based on type
@@ -539,7 +511,7 @@ class Item : virtual public Thing
 		Item(const Item& i);
 		virtual Item* clone() const;
 
-		virtual ~Item() = default;
+		virtual ~Item();
 
 		// non-assignable
 		Item& operator=(const Item&) = delete;
@@ -805,6 +777,13 @@ class Item : virtual public Thing
 		bool unserializeAttr(PropStream& propStream);
 		virtual bool unserializeItemNode(OTB::Loader&, const OTB::Node&, PropStream& propStream);
 
+		// The map loader unserializes items on worker threads. While deferred,
+		// readAttr keeps unique ids and bed sleepers on the item only and
+		// registerDeferred has to be called from the dispatcher thread later.
+		static void setDeferRegistration(bool defer);
+		static bool isRegistrationDeferred();
+		virtual void registerDeferred();
+
 		virtual void serializeAttr(PropWriteStream& propWriteStream) const;
 
 		bool isPushable() const override final {
@@ -843,7 +822,7 @@ class Item : virtual public Thing
 			if (hasAttribute(ITEM_ATTRIBUTE_WEIGHT)) {
 				return getIntAttr(ITEM_ATTRIBUTE_WEIGHT);
 			}
-			return items[id].weight;
+			return items.getWeight(id);
 		}
 		int32_t getAttack() const {
 			if (hasAttribute(ITEM_ATTRIBUTE_ATTACK)) {
@@ -884,38 +863,38 @@ class Item : virtual public Thing
 
 		bool hasProperty(ITEMPROPERTY prop) const;
 		bool isBlocking() const {
-			return items[id].blockSolid;
+			return items.hasFlag(id, ITEMTYPEFLAG_BLOCKSOLID);
 		}
 		bool isStackable() const {
-			return items[id].stackable;
+			return items.hasFlag(id, ITEMTYPEFLAG_STACKABLE);
 		}
 		bool isAlwaysOnTop() const {
-			return items[id].alwaysOnTop;
+			return items.hasFlag(id, ITEMTYPEFLAG_ALWAYSONTOP);
 		}
 		bool isGroundTile() const {
-			return items[id].isGroundTile();
+			return items.hasFlag(id, ITEMTYPEFLAG_GROUND);
 		}
 		bool isMagicField() const {
-			return items[id].isMagicField();
+			return items.hasFlag(id, ITEMTYPEFLAG_MAGICFIELD);
 		}
 		bool isMoveable() const {
-			return items[id].moveable;
+			return items.hasFlag(id, ITEMTYPEFLAG_MOVEABLE);
 		}
 		bool isPickupable() const {
-			return items[id].pickupable;
+			return items.hasFlag(id, ITEMTYPEFLAG_PICKUPABLE);
 		}
 		bool isUseable() const {
-			return items[id].useable;
+			return items.hasFlag(id, ITEMTYPEFLAG_USEABLE);
 		}
 		bool isHangable() const {
-			return items[id].isHangable;
+			return items.hasFlag(id, ITEMTYPEFLAG_HANGABLE);
 		}
 		bool isRotatable() const {
 			const ItemType& it = items[id];
 			return it.rotatable && it.rotateTo;
 		}
 		bool hasWalkStack() const {
-			return items[id].walkStack;
+			return items.hasFlag(id, ITEMTYPEFLAG_WALKSTACK);
 		}
 
 		const std::string& getName() const {
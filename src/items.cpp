@@ -208,6 +208,9 @@ void Items::clear()
 	items.clear();
 	clientIdToServerIdMap.clear();
 	nameToItems.clear();
+	typeFlags.clear();
+	typeWeights.clear();
+	typeFloorChanges.clear();
 }
 
 bool Items::reload()
@@ -231,7 +234,7 @@ bool Items::loadFromOtb(const std::string& file)
 {
 	OTB::Loader loader{file, OTBI};
 
-	auto& root = loader.parseTree();
+	const OTB::Node& root = loader.getRoot();
 
 	PropStream props;
 	if (loader.getProps(root, props)) {
@@ -279,7 +282,7 @@ bool Items::loadFromOtb(const std::string& file)
 		return false;
 	}
 
-	for (auto& itemNode : root.children) {
+	for (const OTB::Node& itemNode : loader.getChildren(root)) {
 		PropStream stream;
 		if (!loader.getProps(itemNode, stream)) {
 			return false;
@@ -457,6 +460,7 @@ bool Items::loadFromOtb(const std::string& file)
 	}
 
 	items.shrink_to_fit();
+	buildHotFields();
 	return true;
 }
 
@@ -496,9 +500,78 @@ bool Items::loadFromXml()
 	}
 
 	buildInventoryList();
+	buildHotFields();
 	return true;
 }
 
+void Items::buildHotFields()
+{
+	typeFlags.assign(items.size(), 0);
+	typeWeights.assign(items.size(), 0);
+	typeFloorChanges.assign(items.size(), 0);
+
+	for (size_t id = 0, size = items.size(); id < size; ++id) {
+		const ItemType& it = items[id];
+
+		uint32_t flags = 0;
+		if (it.blockSolid) {
+			flags |= ITEMTYPEFLAG_BLOCKSOLID;
+		}
+		if (it.blockProjectile) {
+			flags |= ITEMTYPEFLAG_BLOCKPROJECTILE;
+		}
+		if (it.blockPathFind) {
+			flags |= ITEMTYPEFLAG_BLOCKPATHFIND;
+		}
+		if (it.hasHeight) {
+			flags |= ITEMTYPEFLAG_HASHEIGHT;
+		}
+		if (it.moveable) {
+			flags |= ITEMTYPEFLAG_MOVEABLE;
+		}
+		if (it.pickupable) {
+			flags |= ITEMTYPEFLAG_PICKUPABLE;
+		}
+		if (it.allowPickupable) {
+			flags |= ITEMTYPEFLAG_ALLOWPICKUPABLE;
+		}
+		if (it.stackable) {
+			flags |= ITEMTYPEFLAG_STACKABLE;
+		}
+		if (it.alwaysOnTop) {
+			flags |= ITEMTYPEFLAG_ALWAYSONTOP;
+		}
+		if (it.isGroundTile()) {
+			flags |= ITEMTYPEFLAG_GROUND;
+		}
+		if (it.isMagicField()) {
+			flags |= ITEMTYPEFLAG_MAGICFIELD;
+		}
+		if (it.isBed()) {
+			flags |= ITEMTYPEFLAG_BED;
+		}
+		if (it.isVertical) {
+			flags |= ITEMTYPEFLAG_VERTICAL;
+		}
+		if (it.isHorizontal) {
+			flags |= ITEMTYPEFLAG_HORIZONTAL;
+		}
+		if (it.isHangable) {
+			flags |= ITEMTYPEFLAG_HANGABLE;
+		}
+		if (it.useable) {
+			flags |= ITEMTYPEFLAG_USEABLE;
+		}
+		if (it.walkStack) {
+			flags |= ITEMTYPEFLAG_WALKSTACK;
+		}
+
+		typeFlags[id] = flags;
+		typeWeights[id] = it.weight;
+		typeFloorChanges[id] = it.floorChange;
+	}
+}
+
 void Items::buildInventoryList()
 {
 	inventory.reserve(items.size());
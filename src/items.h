@@ -153,6 +153,27 @@ enum ItemParseAttributes_t {
 	ITEM_PARSE_ALLOWDISTREAD,
 };
 
+// ItemType fields kept in the packed hot field table of Items
+enum ItemTypeFlags_t : uint32_t {
+	ITEMTYPEFLAG_BLOCKSOLID = 1 << 0,
+	ITEMTYPEFLAG_BLOCKPROJECTILE = 1 << 1,
+	ITEMTYPEFLAG_BLOCKPATHFIND = 1 << 2,
+	ITEMTYPEFLAG_HASHEIGHT = 1 << 3,
+	ITEMTYPEFLAG_MOVEABLE = 1 << 4,
+	ITEMTYPEFLAG_PICKUPABLE = 1 << 5,
+	ITEMTYPEFLAG_ALLOWPICKUPABLE = 1 << 6,
+	ITEMTYPEFLAG_STACKABLE = 1 << 7,
+	ITEMTYPEFLAG_ALWAYSONTOP = 1 << 8,
+	ITEMTYPEFLAG_GROUND = 1 << 9,
+	ITEMTYPEFLAG_MAGICFIELD = 1 << 10,
+	ITEMTYPEFLAG_BED = 1 << 11,
+	ITEMTYPEFLAG_VERTICAL = 1 << 12,
+	ITEMTYPEFLAG_HORIZONTAL = 1 << 13,
+	ITEMTYPEFLAG_HANGABLE = 1 << 14,
+	ITEMTYPEFLAG_USEABLE = 1 << 15,
+	ITEMTYPEFLAG_WALKSTACK = 1 << 16,
+};
+
 struct Abilities {
 	uint32_t healthGain = 0;
 	uint32_t healthTicks = 0;
@@ -407,10 +428,32 @@ class Items
 			return items.size();
 		}
 
+		// The ItemType fields tile, pathfinding and combat code test for every
+		// item they look at, one packed array per field indexed by item id so
+		// a test touches a few bytes instead of a whole ItemType. Rebuilt
+		// whenever the item types are loaded, ItemType stays the source.
+		uint32_t getFlags(size_t id) const {
+			return id < typeFlags.size() ? typeFlags[id] : 0;
+		}
+		bool hasFlag(size_t id, ItemTypeFlags_t flag) const {
+			return (getFlags(id) & flag) != 0;
+		}
+		uint32_t getWeight(size_t id) const {
+			return id < typeWeights.size() ? typeWeights[id] : 0;
+		}
+		uint8_t getFloorChange(size_t id) const {
+			return id < typeFloorChanges.size() ? typeFloorChanges[id] : 0;
+		}
+
 		NameMap nameToItems;
 
 	private:
+		void buildHotFields();
+
 		std::vector<ItemType> items;
+		std::vector<uint32_t> typeFlags;
+		std::vector<uint32_t> typeWeights;
+		std::vector<uint8_t> typeFloorChanges;
 		InventoryVector inventory;
 		class ClientIdToServerIdMap
 		{
@@ -0,0 +1,250 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "otpch.h"
+
+#include "luaprofiler.h"
+
+#include <fstream>
+
+extern LuaEnvironment g_luaEnvironment;
+
+LuaProfiler g_luaProfiler;
+
+namespace {
+
+// folded stacks use ';' between frames and the last space before the value
+std::string foldedFrameName(std::string name)
+{
+	std::replace(name.begin(), name.end(), ';', ',');
+	return name;
+}
+
+}
+
+void LuaProfiler::start(uint32_t sampleInterval /*= 0*/)
+{
+	enabled = true;
+
+	lua_State* L = g_luaEnvironment.getLuaState();
+	if (!L) {
+		this->sampleInterval = 0;
+		return;
+	}
+
+	this->sampleInterval = sampleInterval;
+	if (sampleInterval != 0) {
+		lua_sethook(L, sampleHook, LUA_MASKCOUNT, sampleInterval);
+	} else {
+		lua_sethook(L, nullptr, 0, 0);
+	}
+}
+
+void LuaProfiler::stop()
+{
+	enabled = false;
+
+	if (sampleInterval != 0) {
+		if (lua_State* L = g_luaEnvironment.getLuaState()) {
+			lua_sethook(L, nullptr, 0, 0);
+		}
+		sampleInterval = 0;
+	}
+}
+
+void LuaProfiler::reset()
+{
+	// frames stay registered, entry points may still be running
+	for (FrameStats& frame : frames) {
+		frame.calls = 0;
+		frame.totalTime = 0;
+		frame.selfTime = 0;
+	}
+	stackTimes.clear();
+	stackSamples.clear();
+}
+
+bool LuaProfiler::dump(const std::string& prefix) const
+{
+	std::ofstream folded(prefix + ".folded");
+	if (!folded.is_open()) {
+		return false;
+	}
+
+	for (const auto& it : stackTimes) {
+		const std::vector<size_t>& stack = it.first;
+		for (size_t i = 0, size = stack.size(); i < size; ++i) {
+			if (i != 0) {
+				folded << ';';
+			}
+			folded << frames[stack[i]].name;
+		}
+		folded << ' ' << it.second << '\n';
+	}
+
+	if (!stackSamples.empty()) {
+		std::ofstream samples(prefix + ".samples.folded");
+		if (!samples.is_open()) {
+			return false;
+		}
+
+		for (const auto& it : stackSamples) {
+			samples << it.first << ' ' << it.second << '\n';
+		}
+	}
+
+	std::ofstream summary(prefix + ".txt");
+	if (!summary.is_open()) {
+		return false;
+	}
+
+	std::vector<const FrameStats*> sorted;
+	sorted.reserve(frames.size());
+	for (const FrameStats& frame : frames) {
+		if (frame.calls != 0) {
+			sorted.push_back(&frame);
+		}
+	}
+
+	std::sort(sorted.begin(), sorted.end(), [](const FrameStats* lhs, const FrameStats* rhs) {
+		return lhs->totalTime > rhs->totalTime;
+	});
+
+	summary << std::setw(12) << "calls" << std::setw(16) << "total (us)" << std::setw(16) << "self (us)" << std::setw(12) << "avg (us)" << "  entry point" << '\n';
+	for (const FrameStats* frame : sorted) {
+		summary << std::setw(12) << frame->calls << std::setw(16) << frame->totalTime << std::setw(16) << frame->selfTime << std::setw(12) << (frame->totalTime / frame->calls) << "  " << frame->name << '\n';
+	}
+	return true;
+}
+
+void LuaProfiler::enter(const ScriptEnvironment& env)
+{
+	activeFrames.emplace_back(getFrameIndex(env), Clock::now());
+}
+
+void LuaProfiler::leave()
+{
+	if (activeFrames.empty()) {
+		return;
+	}
+
+	const ActiveFrame& active = activeFrames.back();
+	uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - active.startTime).count();
+	uint64_t self = elapsed > active.childTime ? elapsed - active.childTime : 0;
+
+	FrameStats& frame = frames[active.frameIndex];
+	++frame.calls;
+	frame.totalTime += elapsed;
+	frame.selfTime += self;
+
+	std::vector<size_t> stack;
+	stack.reserve(activeFrames.size());
+	for (const ActiveFrame& it : activeFrames) {
+		stack.push_back(it.frameIndex);
+	}
+	stackTimes[stack] += self;
+
+	activeFrames.pop_back();
+	if (!activeFrames.empty()) {
+		activeFrames.back().childTime += elapsed;
+	}
+}
+
+void LuaProfiler::sampleHook(lua_State* L, lua_Debug*)
+{
+	LuaProfiler& profiler = g_luaProfiler;
+	if (profiler.activeFrames.empty()) {
+		return;
+	}
+
+	std::vector<std::string> luaFrames;
+
+	lua_Debug ar;
+	for (int level = 0; level < 64 && lua_getstack(L, level, &ar) != 0; ++level) {
+		if (lua_getinfo(L, "Sn", &ar) == 0) {
+			break;
+		}
+
+		std::ostringstream ss;
+		ss << ar.short_src << ':' << ar.linedefined;
+		if (ar.name) {
+			ss << ' ' << ar.name;
+		}
+		luaFrames.push_back(foldedFrameName(ss.str()));
+	}
+
+	std::string stack = profiler.frames[profiler.activeFrames.front().frameIndex].name;
+	for (auto it = luaFrames.rbegin(), end = luaFrames.rend(); it != end; ++it) {
+		stack.push_back(';');
+		stack.append(*it);
+	}
+	++profiler.stackSamples[stack];
+}
+
+size_t LuaProfiler::getFrameIndex(const ScriptEnvironment& env)
+{
+	int32_t scriptId;
+	int32_t callbackId;
+	bool timerEvent;
+	LuaScriptInterface* scriptInterface;
+	env.getEventInfo(scriptId, scriptInterface, callbackId, timerEvent);
+
+	int32_t id = callbackId != 0 ? callbackId : scriptId;
+
+	// the loading id resolves to whatever file is being loaded, so it is never cached
+	auto key = std::make_tuple(static_cast<const LuaScriptInterface*>(scriptInterface), id, timerEvent);
+	if (id != EVENT_ID_LOADING) {
+		auto it = frameIndexes.find(key);
+		if (it != frameIndexes.end()) {
+			return it->second;
+		}
+	}
+
+	std::ostringstream ss;
+	if (scriptInterface) {
+		ss << '[' << scriptInterface->getInterfaceName() << "] " << scriptInterface->getFileById(id);
+	} else {
+		ss << "(Unknown script interface)";
+	}
+
+	if (id == EVENT_ID_LOADING) {
+		ss << " (load)";
+	} else if (timerEvent) {
+		ss << " (timer)";
+	}
+
+	const std::string& name = foldedFrameName(ss.str());
+	for (size_t i = 0, size = frames.size(); i < size; ++i) {
+		if (frames[i].name == name) {
+			if (id != EVENT_ID_LOADING) {
+				frameIndexes[key] = i;
+			}
+			return i;
+		}
+	}
+
+	frames.emplace_back();
+	frames.back().name = name;
+
+	size_t index = frames.size() - 1;
+	if (id != EVENT_ID_LOADING) {
+		frameIndexes[key] = index;
+	}
+	return index;
+}
@@ -0,0 +1,88 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef FS_LUAPROFILER_H_2E4C1F0B7A6D4B8E9C3A5D7F1B2E4C6A
+#define FS_LUAPROFILER_H_2E4C1F0B7A6D4B8E9C3A5D7F1B2E4C6A
+
+#include "luascript.h"
+
+#include <tuple>
+
+// Records wall time and call counts of every Lua entry point (events,
+// callbacks, timers, file loads) while enabled. Each entry point is named
+// after its interface and its cacheFiles entry, nested entry points form
+// a stack that is dumped in flamegraph folded format. Optionally samples
+// the Lua call stack through a count hook.
+class LuaProfiler
+{
+	public:
+		LuaProfiler() = default;
+
+		// non-copyable
+		LuaProfiler(const LuaProfiler&) = delete;
+		LuaProfiler& operator=(const LuaProfiler&) = delete;
+
+		void start(uint32_t sampleInterval = 0);
+		void stop();
+		void reset();
+		bool dump(const std::string& prefix) const;
+
+		bool isEnabled() const {
+			return enabled;
+		}
+
+		void enter(const ScriptEnvironment& env);
+		void leave();
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		struct FrameStats {
+			std::string name;
+			uint64_t calls = 0;
+			uint64_t totalTime = 0; // microseconds
+			uint64_t selfTime = 0; // microseconds
+		};
+
+		struct ActiveFrame {
+			ActiveFrame(size_t frameIndex, Clock::time_point startTime) : frameIndex(frameIndex), startTime(startTime) {}
+
+			size_t frameIndex;
+			Clock::time_point startTime;
+			uint64_t childTime = 0;
+		};
+
+		static void sampleHook(lua_State* L, lua_Debug* ar);
+
+		size_t getFrameIndex(const ScriptEnvironment& env);
+
+		std::map<std::tuple<const LuaScriptInterface*, int32_t, bool>, size_t> frameIndexes;
+		std::vector<FrameStats> frames;
+		std::vector<ActiveFrame> activeFrames;
+
+		std::map<std::vector<size_t>, uint64_t> stackTimes;
+		std::map<std::string, uint64_t> stackSamples;
+
+		uint32_t sampleInterval = 0;
+		bool enabled = false;
+};
+
+extern LuaProfiler g_luaProfiler;
+
+#endif
@@ -40,6 +40,8 @@
 #include "globalevent.h"
 #include "script.h"
 #include "weapons.h"
+#include "luaprofiler.h"
+#include "dispatchertrace.h"
 
 extern Chat* g_chat;
 extern Game g_game;
@@ -269,6 +271,9 @@ std::string LuaScriptInterface::getErrorDesc(ErrorCode_t code)
 ScriptEnvironment LuaScriptInterface::scriptEnv[16];
 int32_t LuaScriptInterface::scriptEnvIndex = -1;
 
+lua_State* LuaScriptInterface::userdataCacheState = nullptr;
+int32_t LuaScriptInterface::userdataCacheRef = LUA_NOREF;
+
 LuaScriptInterface::LuaScriptInterface(std::string interfaceName) : interfaceName(std::move(interfaceName))
 {
 	if (!g_luaEnvironment.getLuaState()) {
@@ -297,7 +302,17 @@ int LuaScriptInterface::protectedCall(lua_State* L, int nargs, int nresults)
 	lua_pushcfunction(L, luaErrorHandler);
 	lua_insert(L, error_index);
 
+	bool profiling = g_luaProfiler.isEnabled();
+	if (profiling) {
+		g_luaProfiler.enter(*getScriptEnv());
+	}
+
 	int ret = lua_pcall(L, nargs, nresults, error_index);
+
+	if (profiling) {
+		g_luaProfiler.leave();
+	}
+
 	lua_remove(L, error_index);
 	return ret;
 }
@@ -636,6 +651,69 @@ void LuaScriptInterface::pushCylinder(lua_State* L, Cylinder* cylinder)
 	}
 }
 
+bool LuaScriptInterface::pushCachedUserdata(lua_State* L, const void* value)
+{
+	if (!g_config.getBoolean(ConfigManager::LUA_USERDATA_CACHE)) {
+		return false;
+	}
+
+	if (!userdataCacheState) {
+		// registry[userdataCacheRef] = setmetatable({}, {__mode = "v"})
+		lua_newtable(L);
+		lua_createtable(L, 0, 1);
+		pushString(L, "v");
+		lua_setfield(L, -2, "__mode");
+		lua_setmetatable(L, -2);
+		userdataCacheRef = luaL_ref(L, LUA_REGISTRYINDEX);
+		userdataCacheState = g_luaEnvironment.getLuaState();
+	}
+
+	void* key = const_cast<void*>(value);
+	lua_rawgeti(L, LUA_REGISTRYINDEX, userdataCacheRef);
+	lua_pushlightuserdata(L, key);
+	lua_rawget(L, -2);
+	if (lua_type(L, -1) == LUA_TUSERDATA) {
+		lua_remove(L, -2);
+		return true;
+	}
+	lua_pop(L, 1);
+
+	void** userdata = static_cast<void**>(lua_newuserdata(L, sizeof(void*)));
+	*userdata = key;
+
+	lua_pushlightuserdata(L, key);
+	lua_pushvalue(L, -2);
+	lua_rawset(L, -4);
+	lua_remove(L, -2);
+	return true;
+}
+
+void LuaScriptInterface::invalidateUserdata(const void* value)
+{
+	lua_State* L = userdataCacheState;
+	if (!L) {
+		return;
+	}
+
+	// items, tiles and creatures are only destroyed by the dispatcher while it
+	// runs, the Lua state is not safe to touch from another thread
+	assert(g_dispatcher.getThreadId() == std::thread::id() || g_dispatcher.getThreadId() == std::this_thread::get_id());
+
+	void* key = const_cast<void*>(value);
+	lua_rawgeti(L, LUA_REGISTRYINDEX, userdataCacheRef);
+	lua_pushlightuserdata(L, key);
+	lua_rawget(L, -2);
+	if (lua_type(L, -1) == LUA_TUSERDATA) {
+		// scripts still holding this userdata will now get nil from getUserdata
+		*static_cast<void**>(lua_touserdata(L, -1)) = nullptr;
+
+		lua_pushlightuserdata(L, key);
+		lua_pushnil(L);
+		lua_rawset(L, -4);
+	}
+	lua_pop(L, 2);
+}
+
 void LuaScriptInterface::pushString(lua_State* L, const std::string& value)
 {
 	lua_pushlstring(L, value.c_str(), value.length());
@@ -1834,6 +1912,16 @@ void LuaScriptInterface::registerFunctions()
 
 	registerMethod("Game", "reload", LuaScriptInterface::luaGameReload);
 
+	registerMethod("Game", "startLuaProfiler", LuaScriptInterface::luaGameStartLuaProfiler);
+	registerMethod("Game", "stopLuaProfiler", LuaScriptInterface::luaGameStopLuaProfiler);
+	registerMethod("Game", "resetLuaProfiler", LuaScriptInterface::luaGameResetLuaProfiler);
+	registerMethod("Game", "dumpLuaProfiler", LuaScriptInterface::luaGameDumpLuaProfiler);
+
+	registerMethod("Game", "startDispatcherTrace", LuaScriptInterface::luaGameStartDispatcherTrace);
+	registerMethod("Game", "stopDispatcherTrace", LuaScriptInterface::luaGameStopDispatcherTrace);
+	registerMethod("Game", "resetDispatcherTrace", LuaScriptInterface::luaGameResetDispatcherTrace);
+	registerMethod("Game", "dumpDispatcherTrace", LuaScriptInterface::luaGameDumpDispatcherTrace);
+
 	// Variant
 	registerClass("Variant", "", LuaScriptInterface::luaVariantCreate);
 
@@ -2039,6 +2127,7 @@ void LuaScriptInterface::registerFunctions()
 	registerMethod("Creature", "isCreature", LuaScriptInterface::luaCreatureIsCreature);
 	registerMethod("Creature", "isInGhostMode", LuaScriptInterface::luaCreatureIsInGhostMode);
 	registerMethod("Creature", "isHealthHidden", LuaScriptInterface::luaCreatureIsHealthHidden);
+	registerMethod("Creature", "isHearListener", LuaScriptInterface::luaCreatureIsHearListener);
 	registerMethod("Creature", "isImmune", LuaScriptInterface::luaCreatureIsImmune);
 
 	registerMethod("Creature", "canSee", LuaScriptInterface::luaCreatureCanSee);
@@ -2079,6 +2168,7 @@ void LuaScriptInterface::registerFunctions()
 	registerMethod("Creature", "getMaxHealth", LuaScriptInterface::luaCreatureGetMaxHealth);
 	registerMethod("Creature", "setMaxHealth", LuaScriptInterface::luaCreatureSetMaxHealth);
 	registerMethod("Creature", "setHiddenHealth", LuaScriptInterface::luaCreatureSetHiddenHealth);
+	registerMethod("Creature", "setHearListener", LuaScriptInterface::luaCreatureSetHearListener);
 
 	registerMethod("Creature", "getSkull", LuaScriptInterface::luaCreatureGetSkull);
 	registerMethod("Creature", "setSkull", LuaScriptInterface::luaCreatureSetSkull);
@@ -3420,7 +3510,7 @@ int LuaScriptInterface::luaAddEvent(lua_State* L)
 	auto& lastTimerEventId = g_luaEnvironment.lastEventTimerId;
 	eventDesc.eventId = g_scheduler.addEvent(createSchedulerTask(
 		delay, std::bind(&LuaEnvironment::executeTimerEvent, &g_luaEnvironment, lastTimerEventId)
-	));
+	, "LuaEnvironment::executeTimerEvent"));
 
 	g_luaEnvironment.timerEvents.emplace(lastTimerEventId, std::move(eventDesc));
 	lua_pushnumber(L, lastTimerEventId++);
@@ -3902,8 +3992,8 @@ int LuaScriptInterface::luaGameGetPlayers(lua_State* L)
 	lua_createtable(L, g_game.getPlayersOnline(), 0);
 
 	int index = 0;
-	for (const auto& playerEntry : g_game.getPlayers()) {
-		pushUserdata<Player>(L, playerEntry.second);
+	for (Player* player : g_game.getPlayers()) {
+		pushUserdata<Player>(L, player);
 		setMetatable(L, -1, "Player");
 		lua_rawseti(L, -2, ++index);
 	}
@@ -3922,7 +4012,7 @@ int LuaScriptInterface::luaGameLoadMap(lua_State* L)
 			std::cout << "[Error - LuaScriptInterface::luaGameLoadMap] Failed to load map: "
 				<< e.what() << std::endl;
 		}
-	}));
+	}, "Game::loadMap"));
 	return 0;
 }
 
@@ -4284,6 +4374,70 @@ int LuaScriptInterface::luaGameReload(lua_State* L)
 	return 1;
 }
 
+int LuaScriptInterface::luaGameStartLuaProfiler(lua_State* L)
+{
+	// Game.startLuaProfiler([sampleInterval = 0])
+	g_luaProfiler.start(getNumber<uint32_t>(L, 1, 0));
+	pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameStopLuaProfiler(lua_State* L)
+{
+	// Game.stopLuaProfiler()
+	g_luaProfiler.stop();
+	pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameResetLuaProfiler(lua_State* L)
+{
+	// Game.resetLuaProfiler()
+	g_luaProfiler.reset();
+	pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameDumpLuaProfiler(lua_State* L)
+{
+	// Game.dumpLuaProfiler([prefix = "data/logs/luaprofile"])
+	const std::string& prefix = isString(L, 1) ? getString(L, 1) : "data/logs/luaprofile";
+	pushBoolean(L, g_luaProfiler.dump(prefix));
+	return 1;
+}
+
+int LuaScriptInterface::luaGameStartDispatcherTrace(lua_State* L)
+{
+	// Game.startDispatcherTrace([longTaskThreshold = 50[, dumpInterval = 0]])
+	g_dispatcherTrace.start(getNumber<uint32_t>(L, 1, 50), getNumber<uint32_t>(L, 2, 0));
+	pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameStopDispatcherTrace(lua_State* L)
+{
+	// Game.stopDispatcherTrace()
+	g_dispatcherTrace.stop();
+	pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameResetDispatcherTrace(lua_State* L)
+{
+	// Game.resetDispatcherTrace()
+	g_dispatcherTrace.reset();
+	pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameDumpDispatcherTrace(lua_State* L)
+{
+	// Game.dumpDispatcherTrace([path = "data/logs/dispatcher.log"])
+	const std::string& path = isString(L, 1) ? getString(L, 1) : "data/logs/dispatcher.log";
+	pushBoolean(L, g_dispatcherTrace.dump(path));
+	return 1;
+}
+
 // Variant
 int LuaScriptInterface::luaVariantCreate(lua_State* L)
 {
@@ -6764,6 +6918,18 @@ int LuaScriptInterface::luaCreatureIsHealthHidden(lua_State* L)
 	return 1;
 }
 
+int LuaScriptInterface::luaCreatureIsHearListener(lua_State* L)
+{
+	// creature:isHearListener()
+	const Creature* creature = getUserdata<const Creature>(L, 1);
+	if (creature) {
+		pushBoolean(L, creature->isHearListener());
+	} else {
+		lua_pushnil(L);
+	}
+	return 1;
+}
+
 int LuaScriptInterface::luaCreatureCanSee(lua_State* L)
 {
 	// creature:canSee(position)
@@ -7183,6 +7349,19 @@ int LuaScriptInterface::luaCreatureSetHiddenHealth(lua_State* L)
 	return 1;
 }
 
+int LuaScriptInterface::luaCreatureSetHearListener(lua_State* L)
+{
+	// creature:setHearListener(listener)
+	Creature* creature = getUserdata<Creature>(L, 1);
+	if (creature) {
+		creature->setHearListener(getBoolean(L, 2));
+		pushBoolean(L, true);
+	} else {
+		lua_pushnil(L);
+	}
+	return 1;
+}
+
 int LuaScriptInterface::luaCreatureGetSkull(lua_State* L)
 {
 	// creature:getSkull()
@@ -7582,7 +7761,7 @@ int LuaScriptInterface::luaPlayerCreate(lua_State* L)
 	Player* player;
 	if (isNumber(L, 2)) {
 		uint32_t id = getNumber<uint32_t>(L, 2);
-		if (id >= 0x10000000 && id <= Player::playerAutoID) {
+		if (id >= PLAYER_ID_FIRST && id <= PLAYER_ID_LAST) {
 			player = g_game.getPlayerByID(id);
 		} else {
 			player = g_game.getPlayerByGUID(id);
@@ -9310,18 +9489,18 @@ int LuaScriptInterface::luaPlayerSetGhostMode(lua_State* L)
 	}
 
 	if (player->isInGhostMode()) {
-		for (const auto& it : g_game.getPlayers()) {
-			if (!it.second->isAccessPlayer()) {
-				it.second->notifyStatusChange(player, VIPSTATUS_OFFLINE);
+		for (Player* tmpPlayer : g_game.getPlayers()) {
+			if (!tmpPlayer->isAccessPlayer()) {
+				tmpPlayer->notifyStatusChange(player, VIPSTATUS_OFFLINE);
 			}
 		}
 
 		player->stopLiveCasting();
 		IOLoginData::updateOnlineStatus(player->getGUID(), false);
 	} else {
-		for (const auto& it : g_game.getPlayers()) {
-			if (!it.second->isAccessPlayer()) {
-				it.second->notifyStatusChange(player, VIPSTATUS_ONLINE);
+		for (Player* tmpPlayer : g_game.getPlayers()) {
+			if (!tmpPlayer->isAccessPlayer()) {
+				tmpPlayer->notifyStatusChange(player, VIPSTATUS_ONLINE);
 			}
 		}
 		IOLoginData::updateOnlineStatus(player->getGUID(), true);
@@ -15708,6 +15887,12 @@ bool LuaEnvironment::closeState()
 	timerEvents.clear();
 	cacheFiles.clear();
 
+	if (userdataCacheState) {
+		luaL_unref(luaState, LUA_REGISTRYINDEX, userdataCacheRef);
+		userdataCacheRef = LUA_NOREF;
+		userdataCacheState = nullptr;
+	}
+
 	lua_close(luaState);
 	luaState = nullptr;
 	return true;
@@ -57,6 +57,8 @@ class Condition;
 class Npc;
 class Monster;
 class InstantSpell;
+class Teleport;
+class Tile;
 
 enum {
 	EVENT_ID_LOADING = 1,
@@ -105,6 +107,17 @@ class LuaScriptInterface;
 class Cylinder;
 class Game;
 
+// game objects whose userdata may be shared between pushes (luaUserdataCache)
+template<class T> struct LuaCachedUserdata : std::false_type {};
+template<> struct LuaCachedUserdata<Creature> : std::true_type {};
+template<> struct LuaCachedUserdata<Player> : std::true_type {};
+template<> struct LuaCachedUserdata<Monster> : std::true_type {};
+template<> struct LuaCachedUserdata<Npc> : std::true_type {};
+template<> struct LuaCachedUserdata<Item> : std::true_type {};
+template<> struct LuaCachedUserdata<Container> : std::true_type {};
+template<> struct LuaCachedUserdata<Teleport> : std::true_type {};
+template<> struct LuaCachedUserdata<Tile> : std::true_type {};
+
 struct LootBlock;
 
 class ScriptEnvironment
@@ -271,10 +284,17 @@ class LuaScriptInterface
 		template<class T>
 		static void pushUserdata(lua_State* L, T* value)
 		{
+			if (LuaCachedUserdata<typename std::remove_const<T>::type>::value && pushCachedUserdata(L, value)) {
+				return;
+			}
+
 			T** userdata = static_cast<T**>(lua_newuserdata(L, sizeof(T*)));
 			*userdata = value;
 		}
 
+		static bool pushCachedUserdata(lua_State* L, const void* value);
+		static void invalidateUserdata(const void* value);
+
 		// Metatables
 		static void setMetatable(lua_State* L, int32_t index, const std::string& name);
 		static void setWeakMetatable(lua_State* L, int32_t index, const std::string& name);
@@ -413,6 +433,10 @@ class LuaScriptInterface
 		static int protectedCall(lua_State* L, int nargs, int nresults);
 
 	protected:
+		//weak-valued identity cache of game object userdata
+		static lua_State* userdataCacheState;
+		static int32_t userdataCacheRef;
+
 		virtual bool closeState();
 
 		void registerFunctions();
@@ -560,6 +584,16 @@ class LuaScriptInterface
 
 		static int luaGameReload(lua_State* L);
 
+		static int luaGameStartLuaProfiler(lua_State* L);
+		static int luaGameStopLuaProfiler(lua_State* L);
+		static int luaGameResetLuaProfiler(lua_State* L);
+		static int luaGameDumpLuaProfiler(lua_State* L);
+
+		static int luaGameStartDispatcherTrace(lua_State* L);
+		static int luaGameStopDispatcherTrace(lua_State* L);
+		static int luaGameResetDispatcherTrace(lua_State* L);
+		static int luaGameDumpDispatcherTrace(lua_State* L);
+
 		// Variant
 		static int luaVariantCreate(lua_State* L);
 
@@ -756,6 +790,7 @@ class LuaScriptInterface
 		static int luaCreatureIsCreature(lua_State* L);
 		static int luaCreatureIsInGhostMode(lua_State* L);
 		static int luaCreatureIsHealthHidden(lua_State* L);
+		static int luaCreatureIsHearListener(lua_State* L);
 		static int luaCreatureIsImmune(lua_State* L);
 
 		static int luaCreatureCanSee(lua_State* L);
@@ -796,6 +831,7 @@ class LuaScriptInterface
 		static int luaCreatureGetMaxHealth(lua_State* L);
 		static int luaCreatureSetMaxHealth(lua_State* L);
 		static int luaCreatureSetHiddenHealth(lua_State* L);
+		static int luaCreatureSetHearListener(lua_State* L);
 
 		static int luaCreatureGetSkull(lua_State* L);
 		static int luaCreatureSetSkull(lua_State* L);
@@ -31,13 +31,21 @@ extern Game g_game;
 bool Map::loadMap(const std::string& identifier, bool loadHouses)
 {
 	IOMap loader;
-	if (!loader.loadMap(this, identifier)) {
-		std::cout << "[Fatal - Map::loadMap] " << loader.getLastErrorString() << std::endl;
-		return false;
-	}
+	loader.setLoaderThreads(std::max<int32_t>(0, g_config.getNumber(ConfigManager::MAP_LOADER_THREADS)));
+
+	bool useSnapshot = g_config.getBoolean(ConfigManager::WORLD_SNAPSHOT);
+	if (!useSnapshot || !loader.loadSnapshot(this, identifier)) {
+		loader.setSnapshotRecording(useSnapshot);
+		if (!loader.loadMap(this, identifier)) {
+			std::cout << "[Fatal - Map::loadMap] " << loader.getLastErrorString() << std::endl;
+			return false;
+		}
 
-	if (!IOMap::loadSpawns(this)) {
-		std::cout << "[Warning - Map::loadMap] Failed to load spawn data." << std::endl;
+		if (!IOMap::loadSpawns(this)) {
+			std::cout << "[Warning - Map::loadMap] Failed to load spawn data." << std::endl;
+		} else if (useSnapshot) {
+			loader.saveSnapshot(this, identifier);
+		}
 	}
 
 	if (loadHouses) {
@@ -77,20 +85,24 @@ bool Map::save()
 
 Tile* Map::getTile(uint16_t x, uint16_t y, uint8_t z) const
 {
-	if (z >= MAP_MAX_LAYERS) {
+	const Floor* floor = getFloor(x, y, z);
+	if (!floor) {
 		return nullptr;
 	}
+	return floor->tiles[x & FLOOR_MASK][y & FLOOR_MASK];
+}
 
-	const QTreeLeafNode* leaf = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, x, y);
-	if (!leaf) {
+const Floor* Map::getFloor(uint16_t x, uint16_t y, uint8_t z) const
+{
+	if (z >= MAP_MAX_LAYERS) {
 		return nullptr;
 	}
 
-	const Floor* floor = leaf->getFloor(z);
-	if (!floor) {
+	const QTreeLeafNode* leaf = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, x, y);
+	if (!leaf) {
 		return nullptr;
 	}
-	return floor->tiles[x & FLOOR_MASK][y & FLOOR_MASK];
+	return leaf->getFloor(z);
 }
 
 void Map::setTile(uint16_t x, uint16_t y, uint8_t z, Tile* newTile)
@@ -152,6 +164,28 @@ void Map::setTile(uint16_t x, uint16_t y, uint8_t z, Tile* newTile)
 	} else {
 		tile = newTile;
 	}
+
+	floor->updateTileBits(offsetX, offsetY, tile);
+}
+
+void Map::refreshTileFlags(const Tile& tile)
+{
+	const Position& pos = tile.getPosition();
+	if (pos.z >= MAP_MAX_LAYERS) {
+		return;
+	}
+
+	QTreeLeafNode* leaf = root.getLeaf(pos.x, pos.y);
+	if (!leaf) {
+		return;
+	}
+
+	Floor* floor = leaf->getFloor(pos.z);
+	if (!floor || floor->tiles[pos.x & FLOOR_MASK][pos.y & FLOOR_MASK] != &tile) {
+		return;
+	}
+
+	floor->updateTileBits(pos.x, pos.y, &tile);
 }
 
 bool Map::placeCreature(const Position& centerPos, Creature* creature, bool extendedPos/* = false*/, bool forceLogin/* = false*/)
@@ -266,6 +300,10 @@ void Map::moveCreature(Creature& creature, Tile& newTile, bool forceTeleport/* =
 	//add the creature
 	newTile.addThing(&creature);
 
+	if (const Player* player = creature.getPlayer()) {
+		spawns.movePlayer(player);
+	}
+
 	if (!teleport) {
 		if (oldPos.y > newPos.y) {
 			creature.setDirection(DIRECTION_NORTH);
@@ -301,7 +339,32 @@ void Map::moveCreature(Creature& creature, Tile& newTile, bool forceTeleport/* =
 	newTile.postAddNotification(&creature, &oldTile, 0);
 }
 
-void Map::getSpectatorsInternal(SpectatorVec& spectators, const Position& centerPos, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, int32_t minRangeZ, int32_t maxRangeZ, bool onlyPlayers) const
+void Map::getSpectatorFloors(const Position& centerPos, bool multifloor, int32_t& minRangeZ, int32_t& maxRangeZ)
+{
+	if (multifloor) {
+		if (centerPos.z > 7) {
+			//underground
+
+			//8->15
+			minRangeZ = std::max<int32_t>(centerPos.getZ() - 2, 0);
+			maxRangeZ = std::min<int32_t>(centerPos.getZ() + 2, MAP_MAX_LAYERS - 1);
+		} else if (centerPos.z == 6) {
+			minRangeZ = 0;
+			maxRangeZ = 8;
+		} else if (centerPos.z == 7) {
+			minRangeZ = 0;
+			maxRangeZ = 9;
+		} else {
+			minRangeZ = 0;
+			maxRangeZ = 7;
+		}
+	} else {
+		minRangeZ = centerPos.z;
+		maxRangeZ = centerPos.z;
+	}
+}
+
+void Map::getSpectatorsInternal(SpectatorVec& spectators, const Position& centerPos, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, int32_t minRangeZ, int32_t maxRangeZ, CreatureVector QTreeLeafNode::* nodeList) const
 {
 	int_fast16_t min_y = centerPos.y + minRangeY;
 	int_fast16_t min_x = centerPos.x + minRangeX;
@@ -329,7 +392,7 @@ void Map::getSpectatorsInternal(SpectatorVec& spectators, const Position& center
 		leafE = leafS;
 		for (int_fast32_t nx = startx1; nx <= endx2; nx += FLOOR_SIZE) {
 			if (leafE) {
-				const CreatureVector& node_list = (onlyPlayers ? leafE->player_list : leafE->creature_list);
+				const CreatureVector& node_list = leafE->*nodeList;
 				for (Creature* creature : node_list) {
 					const Position& cpos = creature->getPosition();
 					if (minRangeZ > cpos.z || maxRangeZ < cpos.z) {
@@ -415,30 +478,10 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, boo
 	if (!foundCache) {
 		int32_t minRangeZ;
 		int32_t maxRangeZ;
+		getSpectatorFloors(centerPos, multifloor, minRangeZ, maxRangeZ);
 
-		if (multifloor) {
-			if (centerPos.z > 7) {
-				//underground
-
-				//8->15
-				minRangeZ = std::max<int32_t>(centerPos.getZ() - 2, 0);
-				maxRangeZ = std::min<int32_t>(centerPos.getZ() + 2, MAP_MAX_LAYERS - 1);
-			} else if (centerPos.z == 6) {
-				minRangeZ = 0;
-				maxRangeZ = 8;
-			} else if (centerPos.z == 7) {
-				minRangeZ = 0;
-				maxRangeZ = 9;
-			} else {
-				minRangeZ = 0;
-				maxRangeZ = 7;
-			}
-		} else {
-			minRangeZ = centerPos.z;
-			maxRangeZ = centerPos.z;
-		}
-
-		getSpectatorsInternal(spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ, onlyPlayers);
+		getSpectatorsInternal(spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ,
+		                      onlyPlayers ? &QTreeLeafNode::player_list : &QTreeLeafNode::creature_list);
 
 		if (cacheResult) {
 			if (onlyPlayers) {
@@ -450,6 +493,19 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, boo
 	}
 }
 
+void Map::getHearListeners(SpectatorVec& listeners, const Position& centerPos, bool multifloor, int32_t maxRangeX, int32_t maxRangeY) const
+{
+	if (centerPos.z >= MAP_MAX_LAYERS) {
+		return;
+	}
+
+	// not cached, the listener lists are short and speech is rarer than movement
+	int32_t minRangeZ;
+	int32_t maxRangeZ;
+	getSpectatorFloors(centerPos, multifloor, minRangeZ, maxRangeZ);
+	getSpectatorsInternal(listeners, centerPos, -maxRangeX, maxRangeX, -maxRangeY, maxRangeY, minRangeZ, maxRangeZ, &QTreeLeafNode::listener_list);
+}
+
 void Map::clearSpectatorCache()
 {
 	spectatorCache.clear();
@@ -506,6 +562,11 @@ bool Map::checkSightLine(const Position& fromPos, const Position& toPos) const
 	int32_t B = Position::getOffsetX(start, destination);
 	int32_t C = -(A * destination.x + B * destination.y);
 
+	// consecutive steps mostly stay inside the same floor block
+	const Floor* floor = nullptr;
+	int32_t floorX = -1;
+	int32_t floorY = -1;
+
 	while (start.x != destination.x || start.y != destination.y) {
 		int32_t move_hor = std::abs(A * (start.x + mx) + B * (start.y) + C);
 		int32_t move_ver = std::abs(A * (start.x) + B * (start.y + my) + C);
@@ -519,8 +580,13 @@ bool Map::checkSightLine(const Position& fromPos, const Position& toPos) const
 			start.x += mx;
 		}
 
-		const Tile* tile = getTile(start.x, start.y, start.z);
-		if (tile && tile->hasProperty(CONST_PROP_BLOCKPROJECTILE)) {
+		if ((start.x & ~FLOOR_MASK) != floorX || (start.y & ~FLOOR_MASK) != floorY) {
+			floorX = start.x & ~FLOOR_MASK;
+			floorY = start.y & ~FLOOR_MASK;
+			floor = getFloor(start.x, start.y, start.z);
+		}
+
+		if (floor && (floor->blockProjectile & Floor::getTileBit(start.x, start.y)) != 0) {
 			return false;
 		}
 	}
@@ -558,8 +624,18 @@ const Tile* Map::canWalkTo(const Creature& creature, const Position& pos) const
 	}
 
 	//used for non-cached tiles
-	Tile* tile = getTile(pos.x, pos.y, pos.z);
+	const Floor* floor = getFloor(pos.x, pos.y, pos.z);
+	if (!floor) {
+		return nullptr;
+	}
+
+	Tile* tile = floor->tiles[pos.x & FLOOR_MASK][pos.y & FLOOR_MASK];
 	if (creature.getTile() != tile) {
+		// nothing can be pushed out of the way of an immovable wall
+		if ((floor->immovableBlockSolid & Floor::getTileBit(pos.x, pos.y)) != 0) {
+			return nullptr;
+		}
+
 		if (!tile || tile->queryAdd(0, creature, 1, FLAG_PATHFINDING | FLAG_IGNOREFIELDDAMAGE) != RETURNVALUE_NOERROR) {
 			return nullptr;
 		}
@@ -857,6 +933,21 @@ int_fast32_t AStarNodes::getTileWalkCost(const Creature& creature, const Tile* t
 }
 
 // Floor
+void Floor::updateTileBits(uint32_t x, uint32_t y, const Tile* tile)
+{
+	const uint64_t bit = getTileBit(x, y);
+	auto update = [bit](uint64_t& bits, bool set) {
+		if (set) {
+			bits |= bit;
+		} else {
+			bits &= ~bit;
+		}
+	};
+
+	update(immovableBlockSolid, tile && tile->hasFlag(TILESTATE_IMMOVABLEBLOCKSOLID));
+	update(blockProjectile, tile && tile->hasFlag(TILESTATE_BLOCKPROJECTILE));
+}
+
 Floor::~Floor()
 {
 	for (auto& row : tiles) {
@@ -929,6 +1020,10 @@ void QTreeLeafNode::addCreature(Creature* c)
 	if (c->getPlayer()) {
 		player_list.push_back(c);
 	}
+
+	if (c->isHearListener()) {
+		listener_list.push_back(c);
+	}
 }
 
 void QTreeLeafNode::removeCreature(Creature* c)
@@ -944,6 +1039,13 @@ void QTreeLeafNode::removeCreature(Creature* c)
 		*iter = player_list.back();
 		player_list.pop_back();
 	}
+
+	if (c->isHearListener()) {
+		iter = std::find(listener_list.begin(), listener_list.end(), c);
+		assert(iter != listener_list.end());
+		*iter = listener_list.back();
+		listener_list.pop_back();
+	}
 }
 
 uint32_t Map::clean() const
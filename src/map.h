@@ -87,7 +87,18 @@ struct Floor {
 	Floor(const Floor&) = delete;
 	Floor& operator=(const Floor&) = delete;
 
+	static uint64_t getTileBit(uint32_t x, uint32_t y) {
+		return uint64_t(1) << (((x & FLOOR_MASK) << FLOOR_BITS) | (y & FLOOR_MASK));
+	}
+
+	void updateTileBits(uint32_t x, uint32_t y, const Tile* tile);
+
 	Tile* tiles[FLOOR_SIZE][FLOOR_SIZE] = {};
+
+	// one bit per tile (getTileBit) mirroring the tile flags that pathfinding
+	// and line of sight test, so a probe does not have to touch the tile
+	uint64_t immovableBlockSolid = 0;
+	uint64_t blockProjectile = 0;
 };
 
 class FrozenPathingConditionCall;
@@ -160,6 +171,7 @@ class QTreeLeafNode final : public QTreeNode
 		Floor* array[MAP_MAX_LAYERS] = {};
 		CreatureVector creature_list;
 		CreatureVector player_list;
+		CreatureVector listener_list;
 
 		friend class Map;
 		friend class QTreeNode;
@@ -209,6 +221,10 @@ class Map
 			setTile(pos.x, pos.y, pos.z, newTile);
 		}
 
+		// copies the tile flags into the floor bits, called by the tile
+		// whenever they change, tiles that are not on the map are ignored
+		void refreshTileFlags(const Tile& tile);
+
 		/**
 		  * Place a creature on the map
 		  * \param centerPos The position to place the creature
@@ -224,6 +240,10 @@ class Map
 		                   int32_t minRangeX = 0, int32_t maxRangeX = 0,
 		                   int32_t minRangeY = 0, int32_t maxRangeY = 0);
 
+		// same area as getSpectators, only creatures that react to speech
+		void getHearListeners(SpectatorVec& listeners, const Position& centerPos, bool multifloor,
+		                      int32_t maxRangeX, int32_t maxRangeY) const;
+
 		void clearSpectatorCache();
 		void clearPlayersSpectatorCache();
 
@@ -277,11 +297,16 @@ class Map
 		uint32_t width = 0;
 		uint32_t height = 0;
 
-		// Actually scans the map for spectators
+		const Floor* getFloor(uint16_t x, uint16_t y, uint8_t z) const;
+
+		static void getSpectatorFloors(const Position& centerPos, bool multifloor, int32_t& minRangeZ, int32_t& maxRangeZ);
+
+		// Actually scans the map for spectators, nodeList picks the leaf list
 		void getSpectatorsInternal(SpectatorVec& spectators, const Position& centerPos,
 		                           int32_t minRangeX, int32_t maxRangeX,
 		                           int32_t minRangeY, int32_t maxRangeY,
-		                           int32_t minRangeZ, int32_t maxRangeZ, bool onlyPlayers) const;
+		                           int32_t minRangeZ, int32_t maxRangeZ,
+		                           CreatureVector QTreeLeafNode::* nodeList) const;
 
 		friend class Game;
 		friend class IOMap;
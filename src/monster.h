@@ -37,7 +37,7 @@ enum TargetSearchType_t {
 	TARGETSEARCH_NEAREST,
 };
 
-class Monster final : public Creature
+class Monster final : public Creature, public SlabAllocated
 {
 	public:
 		static Monster* createMonster(const std::string& name);
@@ -58,12 +58,6 @@ class Monster final : public Creature
 			return this;
 		}
 
-		void setID() override {
-			if (id == 0) {
-				id = monsterAutoID++;
-			}
-		}
-
 		void removeList() override;
 		void addList() override;
 
@@ -169,8 +163,6 @@ class Monster final : public Creature
 		BlockType_t blockHit(Creature* attacker, CombatType_t combatType, int32_t& damage,
 		                     bool checkDefense = false, bool checkArmor = false, bool field = false) override;
 
-		static uint32_t monsterAutoID;
-
 	private:
 		CreatureHashSet friendList;
 		CreatureList targetList;
@@ -26,6 +26,7 @@
 #include "weapons.h"
 #include "configmanager.h"
 #include "game.h"
+#include "tasks.h"
 
 #include "pugicast.h"
 
@@ -56,8 +57,14 @@ void MonsterType::loadLoot(MonsterType* monsterType, LootBlock lootBlock)
 	}
 }
 
+Monsters::~Monsters()
+{
+	stopPreload();
+}
+
 bool Monsters::loadFromXml(bool reloading /*= false*/)
 {
+	stopPreload();
 	unloadedMonsters = {};
 	pugi::xml_document doc;
 	pugi::xml_parse_result result = doc.load_file("data/monster/monsters.xml");
@@ -92,7 +99,205 @@ bool Monsters::reload()
 
 	scriptInterface.reset();
 
-	return loadFromXml(true);
+	if (!loadFromXml(true)) {
+		return false;
+	}
+
+	startPreload(std::max<int32_t>(0, g_config.getNumber(ConfigManager::MONSTER_PRELOAD_THREADS)));
+	return true;
+}
+
+void Monsters::startPreload(uint32_t threads)
+{
+	stopPreload();
+	if (threads == 0) {
+		return;
+	}
+
+	for (const auto& it : unloadedMonsters) {
+		if (monsters.find(it.first) == monsters.end()) {
+			preloadEntries.emplace_back(new PreloadEntry(it.first, it.second));
+			preloadIndex[it.first] = preloadEntries.back().get();
+		}
+	}
+
+	if (preloadEntries.empty()) {
+		return;
+	}
+
+	preloadStart = OTSYS_TIME();
+	stopPreloading = false;
+
+	threads = std::min<uint32_t>(threads, preloadEntries.size());
+	for (uint32_t i = 0; i < threads; ++i) {
+		preloadThreads.emplace_back([this]() {
+			while (true) {
+				PreloadEntry* entry;
+				{
+					std::lock_guard<std::mutex> lockGuard(preloadLock);
+					// entries a dispatcher lookup got to first are skipped
+					while (nextPreload < preloadEntries.size() && preloadEntries[nextPreload]->state != PreloadEntry::QUEUED) {
+						++nextPreload;
+					}
+
+					if (stopPreloading || nextPreload == preloadEntries.size()) {
+						break;
+					}
+
+					entry = preloadEntries[nextPreload++].get();
+					entry->state = PreloadEntry::PARSING;
+				}
+
+				parsePreloadEntry(*entry);
+
+				{
+					std::lock_guard<std::mutex> lockGuard(preloadLock);
+					entry->state = PreloadEntry::PARSED;
+				}
+				preloadSignal.notify_all();
+
+				g_dispatcher.addTask(createTask(std::bind(&Monsters::buildPreloaded, this), "Monsters::buildPreloaded"));
+			}
+		});
+	}
+}
+
+void Monsters::stopPreload()
+{
+	{
+		std::lock_guard<std::mutex> lockGuard(preloadLock);
+		stopPreloading = true;
+	}
+
+	for (std::thread& thread : preloadThreads) {
+		thread.join();
+	}
+	preloadThreads.clear();
+
+	// build tasks still queued find nothing left to do
+	preloadIndex.clear();
+	preloadEntries.clear();
+	nextPreload = 0;
+	nextBuild = 0;
+	preloadBuilt = 0;
+}
+
+void Monsters::parsePreloadEntry(PreloadEntry& entry)
+{
+	auto start = std::chrono::steady_clock::now();
+	entry.result = entry.doc.load_file(entry.file.c_str());
+	entry.parseTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Monsters::buildPreloaded()
+{
+	// one task is added per parsed file and each builds one type, the
+	// dispatcher never spends more than a single monster file at a time
+	PreloadEntry* entry = nullptr;
+	{
+		std::lock_guard<std::mutex> lockGuard(preloadLock);
+		while (nextBuild < preloadEntries.size() && preloadEntries[nextBuild]->state == PreloadEntry::BUILT) {
+			++nextBuild;
+		}
+
+		for (size_t i = nextBuild; i < preloadEntries.size(); ++i) {
+			if (preloadEntries[i]->state == PreloadEntry::PARSED) {
+				entry = preloadEntries[i].get();
+				break;
+			}
+		}
+	}
+
+	if (entry) {
+		buildPreloadEntry(*entry);
+	}
+}
+
+MonsterType* Monsters::loadPreloaded(PreloadEntry& entry)
+{
+	bool parse = false;
+	{
+		std::unique_lock<std::mutex> lock(preloadLock);
+		if (entry.state == PreloadEntry::BUILT) {
+			// failed to build, buildPreloadEntry took it out of the index
+			lock.unlock();
+			return loadMonster(entry.file, entry.name);
+		}
+
+		if (entry.state == PreloadEntry::QUEUED) {
+			// not picked up yet, reading it here is faster than waiting for the queue
+			entry.state = PreloadEntry::PARSING;
+			parse = true;
+		} else if (entry.state == PreloadEntry::PARSING) {
+			int64_t start = OTSYS_TIME();
+			preloadSignal.wait(lock, [&entry]() { return entry.state != PreloadEntry::PARSING; });
+			std::cout << "[Info - Monsters::getMonsterType] Waited " << (OTSYS_TIME() - start) << " ms for " << entry.file << '.' << std::endl;
+		}
+	}
+
+	if (parse) {
+		parsePreloadEntry(entry);
+
+		std::lock_guard<std::mutex> lockGuard(preloadLock);
+		entry.state = PreloadEntry::PARSED;
+	}
+	return buildPreloadEntry(entry);
+}
+
+MonsterType* Monsters::buildPreloadEntry(PreloadEntry& entry)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	MonsterType* mType = nullptr;
+	if (!entry.result) {
+		printXMLError("Error - Monsters::loadMonster", entry.file, entry.result);
+	} else {
+		auto it = monsters.find(entry.name);
+		if (it != monsters.end()) {
+			// registered by a script in the meantime
+			mType = &it->second;
+		} else {
+			mType = loadMonster(entry.doc, entry.file, entry.name, false);
+		}
+	}
+
+	entry.buildTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	entry.doc.reset();
+
+	if (!mType) {
+		// later lookups read the file again instead of the preloaded document
+		std::cout << "[Warning - Monsters::buildPreloadEntry] Could not preload " << entry.file << ", it is loaded again on the next lookup." << std::endl;
+		preloadIndex.erase(entry.name);
+	}
+
+	{
+		std::lock_guard<std::mutex> lockGuard(preloadLock);
+		entry.state = PreloadEntry::BUILT;
+	}
+
+	if (++preloadBuilt != preloadEntries.size()) {
+		return mType;
+	}
+
+	std::vector<const PreloadEntry*> slowest;
+	for (const auto& preloadEntry : preloadEntries) {
+		slowest.push_back(preloadEntry.get());
+	}
+
+	size_t reported = std::min<size_t>(5, slowest.size());
+	std::partial_sort(slowest.begin(), slowest.begin() + reported, slowest.end(), [](const PreloadEntry* lhs, const PreloadEntry* rhs) {
+		return lhs->parseTime + lhs->buildTime > rhs->parseTime + rhs->buildTime;
+	});
+
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(1);
+	for (size_t i = 0; i < reported; ++i) {
+		const PreloadEntry* slowEntry = slowest[i];
+		ss << (i == 0 ? "" : ", ") << slowEntry->file << " (parse " << (slowEntry->parseTime / 1000.) << " ms, build " << (slowEntry->buildTime / 1000.) << " ms)";
+	}
+
+	std::cout << "> Preloaded " << preloadEntries.size() << " monster types in " << (OTSYS_TIME() - preloadStart) / (1000.) << " seconds, slowest: " << ss.str() << std::endl;
+	return mType;
 }
 
 ConditionDamage* Monsters::getDamageCondition(ConditionType_t conditionType,
@@ -723,14 +928,18 @@ bool Monsters::deserializeSpell(MonsterSpell* spell, spellBlock_t& sb, const std
 
 MonsterType* Monsters::loadMonster(const std::string& file, const std::string& monsterName, bool reloading /*= false*/)
 {
-	MonsterType* mType = nullptr;
-
 	pugi::xml_document doc;
 	pugi::xml_parse_result result = doc.load_file(file.c_str());
 	if (!result) {
 		printXMLError("Error - Monsters::loadMonster", file, result);
 		return nullptr;
 	}
+	return loadMonster(doc, file, monsterName, reloading);
+}
+
+MonsterType* Monsters::loadMonster(const pugi::xml_document& doc, const std::string& file, const std::string& monsterName, bool reloading)
+{
+	MonsterType* mType = nullptr;
 
 	pugi::xml_node monsterNode = doc.child("monster");
 	if (!monsterNode) {
@@ -1291,6 +1500,10 @@ MonsterType* Monsters::getMonsterType(const std::string& name, bool loadFromFile
 			return nullptr;
 		}
 
+		auto preloadIt = preloadIndex.find(lowerCaseName);
+		if (preloadIt != preloadIndex.end()) {
+			return loadPreloaded(*preloadIt->second);
+		}
 		return loadMonster(it2->second, name);
 	}
 	return &it->second;
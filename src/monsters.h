@@ -22,6 +22,8 @@
 
 #include "creature.h"
 
+#include <condition_variable>
+
 
 const uint32_t MAX_LOOTCHANCE = 100000;
 
@@ -227,6 +229,8 @@ class Monsters
 {
 	public:
 		Monsters() = default;
+		~Monsters();
+
 		// non-copyable
 		Monsters(const Monsters&) = delete;
 		Monsters& operator=(const Monsters&) = delete;
@@ -237,6 +241,11 @@ class Monsters
 		}
 		bool reload();
 
+		// Parses the monster files loadFromXml left for their first use on
+		// background threads. Only the XML is read off the dispatcher, the
+		// types are built by dispatcher tasks as the files become ready.
+		void startPreload(uint32_t threads);
+
 		MonsterType* getMonsterType(const std::string& name, bool loadFromFile = true);
 		bool deserializeSpell(MonsterSpell* spell, spellBlock_t& sb, const std::string& description = "");
 
@@ -249,12 +258,51 @@ class Monsters
 		bool deserializeSpell(const pugi::xml_node& node, spellBlock_t& sb, const std::string& description = "");
 
 		MonsterType* loadMonster(const std::string& file, const std::string& monsterName, bool reloading = false);
+		MonsterType* loadMonster(const pugi::xml_document& doc, const std::string& file, const std::string& monsterName, bool reloading);
 
 		void loadLootContainer(const pugi::xml_node& node, LootBlock&);
 		bool loadLootItem(const pugi::xml_node& node, LootBlock&);
 
+		struct PreloadEntry {
+			enum State_t {
+				QUEUED,
+				PARSING,
+				PARSED,
+				BUILT,
+			};
+
+			PreloadEntry(std::string name, std::string file) : name(std::move(name)), file(std::move(file)) {}
+
+			std::string name;
+			std::string file;
+			pugi::xml_document doc;
+			pugi::xml_parse_result result;
+			int64_t parseTime = 0; // microseconds
+			int64_t buildTime = 0; // microseconds
+			State_t state = QUEUED;
+		};
+
+		static void parsePreloadEntry(PreloadEntry& entry);
+		MonsterType* buildPreloadEntry(PreloadEntry& entry);
+		MonsterType* loadPreloaded(PreloadEntry& entry);
+		void buildPreloaded();
+		void stopPreload();
+
 		std::map<std::string, std::string> unloadedMonsters;
 
+		// entries are in alphabetical order of the monster names, the state
+		// of an entry and nextPreload are guarded by preloadLock
+		std::vector<std::unique_ptr<PreloadEntry>> preloadEntries;
+		std::map<std::string, PreloadEntry*> preloadIndex;
+		std::vector<std::thread> preloadThreads;
+		std::mutex preloadLock;
+		std::condition_variable preloadSignal;
+		size_t nextPreload = 0;
+		size_t nextBuild = 0;
+		size_t preloadBuilt = 0;
+		int64_t preloadStart = 0;
+		bool stopPreloading = false;
+
 		bool loaded = false;
 };
 
@@ -27,7 +27,6 @@
 extern Game g_game;
 extern LuaEnvironment g_luaEnvironment;
 
-uint32_t Npc::npcAutoID = 0x80000000;
 NpcScriptInterface* Npc::scriptInterface = nullptr;
 
 void Npcs::reload()
@@ -35,9 +34,8 @@ void Npcs::reload()
 	delete Npc::scriptInterface;
 	Npc::scriptInterface = nullptr;
 	
-	const std::map<uint32_t, Npc*>& npcs = g_game.getNpcs();
-	for (const auto& it : npcs) {
-		it.second->reload();
+	for (Npc* npc : g_game.getNpcs()) {
+		npc->reload();
 	}
 }
 
@@ -57,6 +55,7 @@ Npc::Npc(const std::string& name) :
 	masterRadius(-1),
 	loaded(false)
 {
+	hearListener = true;
 	reset();
 }
 
@@ -111,12 +111,6 @@ class Npc final : public Creature
 			return pushable && walkTicks != 0;
 		}
 
-		void setID() override {
-			if (id == 0) {
-				id = npcAutoID++;
-			}
-		}
-
 		void removeList() override;
 		void addList() override;
 
@@ -157,8 +151,6 @@ class Npc final : public Creature
 
 		NpcScriptInterface* getScriptInterface();
 
-		static uint32_t npcAutoID;
-
 	private:
 		explicit Npc(const std::string& name);
 
@@ -35,6 +35,8 @@
 #include "scheduler.h"
 #include "databasetasks.h"
 #include "script.h"
+#include "luaprofiler.h"
+#include "dispatchertrace.h"
 #include <fstream>
 #if __has_include("gitmetadata.h")
 	#include "gitmetadata.h"
@@ -81,7 +83,7 @@ int main(int argc, char* argv[])
 	g_dispatcher.start();
 	g_scheduler.start();
 
-	g_dispatcher.addTask(createTask(std::bind(mainLoader, argc, argv, &serviceManager)));
+	g_dispatcher.addTask(createTask(std::bind(mainLoader, argc, argv, &serviceManager), "mainLoader"));
 
 	g_loaderSignal.wait(g_loaderUniqueLock);
 
@@ -231,6 +233,14 @@ void mainLoader(int, char*[], ServiceManager* services)
 		return;
 	}
 
+	if (g_config.getBoolean(ConfigManager::LUA_PROFILER)) {
+		g_luaProfiler.start(g_config.getNumber(ConfigManager::LUA_PROFILER_SAMPLE_INTERVAL));
+	}
+
+	if (g_config.getBoolean(ConfigManager::DISPATCHER_TRACE)) {
+		g_dispatcherTrace.start(g_config.getNumber(ConfigManager::DISPATCHER_TRACE_LONG_TASK_THRESHOLD), g_config.getNumber(ConfigManager::DISPATCHER_TRACE_DUMP_INTERVAL));
+	}
+
 	std::cout << ">> Loading lua scripts" << std::endl;
 	if (!g_scripts->loadScripts("scripts", false, false)) {
 		startupErrorMessage("Failed to load lua scripts");
@@ -255,6 +265,8 @@ void mainLoader(int, char*[], ServiceManager* services)
 		return;
 	}
 
+	g_game.setCombatBatching(g_config.getBoolean(ConfigManager::COMBAT_BATCHING));
+
 	std::cout << ">> Checking world type... " << std::flush;
 	std::string worldType = asLowerCaseString(g_config.getString(ConfigManager::WORLD_TYPE));
 	if (worldType == "pvp") {
@@ -311,6 +323,7 @@ void mainLoader(int, char*[], ServiceManager* services)
 
 	g_game.map.houses.payHouses(rentPeriod);
 
+	IOMarket::getInstance().loadOffers();
 	IOMarket::checkExpiredOffers();
 	IOMarket::getInstance().updateStatistics();
 
@@ -324,5 +337,6 @@ void mainLoader(int, char*[], ServiceManager* services)
 
 	g_game.start(services);
 	g_game.setGameState(GAME_STATE_NORMAL);
+	g_monsters.startPreload(std::max<int32_t>(0, g_config.getNumber(ConfigManager::MONSTER_PRELOAD_THREADS)));
 	g_loaderSignal.notify_all();
 }
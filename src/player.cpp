@@ -45,8 +45,6 @@ extern Events* g_events;
 
 MuteCountMap Player::muteCountMap;
 
-uint32_t Player::playerAutoID = 0x10000000;
-
 Player::Player(ProtocolGame_ptr p) :
 	Creature(), lastPing(OTSYS_TIME()), lastPong(lastPing), client(std::move(p)) {}
 
@@ -1108,7 +1106,7 @@ void Player::onCreatureMove(Creature* creature, const Tile* newTile, const Posit
 
 	if (hasFollowPath && (creature == followCreature || (creature == this && followCreature))) {
 		isUpdatingPath = false;
-		g_dispatcher.addTask(createTask(std::bind(&Game::updateCreatureWalk, &g_game, getID())));
+		g_game.addCreatureWalkUpdate(this);
 	}
 
 	if (creature != this) {
@@ -1879,33 +1877,35 @@ void Player::death(Creature*)
 		health = healthMax;
 		mana = manaMax;
 
-		auto it = conditions.begin(), end = conditions.end();
-		while (it != end) {
-			Condition* condition = *it;
+		size_t i = 0;
+		while (i < conditions.size()) {
+			Condition* condition = conditions[i];
 			if (condition->isPersistent()) {
-				it = conditions.erase(it);
+				conditions.erase(conditions.begin() + i);
+				updateConditions();
 
 				condition->endCondition(this);
 				onEndCondition(condition->getType());
 				delete condition;
 			} else {
-				++it;
+				++i;
 			}
 		}
 	} else {
 		setSkillLoss(true);
 
-		auto it = conditions.begin(), end = conditions.end();
-		while (it != end) {
-			Condition* condition = *it;
+		size_t i = 0;
+		while (i < conditions.size()) {
+			Condition* condition = conditions[i];
 			if (condition->isPersistent()) {
-				it = conditions.erase(it);
+				conditions.erase(conditions.begin() + i);
+				updateConditions();
 
 				condition->endCondition(this);
 				onEndCondition(condition->getType());
 				delete condition;
 			} else {
-				++it;
+				++i;
 			}
 		}
 
@@ -1962,15 +1962,15 @@ void Player::removeList()
 {
 	g_game.removePlayer(this);
 
-	for (const auto& it : g_game.getPlayers()) {
-		it.second->notifyStatusChange(this, VIPSTATUS_OFFLINE);
+	for (Player* player : g_game.getPlayers()) {
+		player->notifyStatusChange(this, VIPSTATUS_OFFLINE);
 	}
 }
 
 void Player::addList()
 {
-	for (const auto& it : g_game.getPlayers()) {
-		it.second->notifyStatusChange(this, VIPSTATUS_ONLINE);
+	for (Player* player : g_game.getPlayers()) {
+		player->notifyStatusChange(this, VIPSTATUS_ONLINE);
 	}
 
 	g_game.addPlayer(this);
@@ -2664,24 +2664,14 @@ size_t Player::getLastIndex() const
 
 uint32_t Player::getItemTypeCount(uint16_t itemId, int32_t subType /*= -1*/) const
 {
-	uint32_t count = 0;
-	for (int32_t i = CONST_SLOT_FIRST; i <= CONST_SLOT_LAST; i++) {
-		Item* item = inventory[i];
-		if (!item) {
-			continue;
-		}
-
-		if (item->getID() == itemId) {
-			count += Item::countByType(item, subType);
-		}
+	const std::vector<Item*>* items = getIndexedItems(itemId);
+	if (!items) {
+		return 0;
+	}
 
-		if (Container* container = item->getContainer()) {
-			for (ContainerIterator it = container->iterator(); it.hasNext(); it.advance()) {
-				if ((*it)->getID() == itemId) {
-					count += Item::countByType(*it, subType);
-				}
-			}
-		}
+	uint32_t count = 0;
+	for (const Item* item : *items) {
+		count += Item::countByType(item, subType);
 	}
 	return count;
 }
@@ -2692,46 +2682,30 @@ bool Player::removeItemOfType(uint16_t itemId, uint32_t amount, int32_t subType,
 		return true;
 	}
 
+	const std::vector<Item*>* items = getIndexedItems(itemId);
+	if (!items) {
+		return false;
+	}
+
 	std::vector<Item*> itemList;
 
 	uint32_t count = 0;
-	for (int32_t i = CONST_SLOT_FIRST; i <= CONST_SLOT_LAST; i++) {
-		Item* item = inventory[i];
-		if (!item) {
+	for (Item* item : *items) {
+		if (ignoreEquipped && item->getParent() == this) {
 			continue;
 		}
 
-		if (!ignoreEquipped && item->getID() == itemId) {
-			uint32_t itemCount = Item::countByType(item, subType);
-			if (itemCount == 0) {
-				continue;
-			}
-
-			itemList.push_back(item);
-
-			count += itemCount;
-			if (count >= amount) {
-				g_game.internalRemoveItems(std::move(itemList), amount, Item::items[itemId].stackable);
-				return true;
-			}
-		} else if (Container* container = item->getContainer()) {
-			for (ContainerIterator it = container->iterator(); it.hasNext(); it.advance()) {
-				Item* containerItem = *it;
-				if (containerItem->getID() == itemId) {
-					uint32_t itemCount = Item::countByType(containerItem, subType);
-					if (itemCount == 0) {
-						continue;
-					}
+		uint32_t itemCount = Item::countByType(item, subType);
+		if (itemCount == 0) {
+			continue;
+		}
 
-					itemList.push_back(containerItem);
+		itemList.push_back(item);
 
-					count += itemCount;
-					if (count >= amount) {
-						g_game.internalRemoveItems(std::move(itemList), amount, Item::items[itemId].stackable);
-						return true;
-					}
-				}
-			}
+		count += itemCount;
+		if (count >= amount) {
+			g_game.internalRemoveItems(std::move(itemList), amount, Item::items[itemId].stackable);
+			return true;
 		}
 	}
 	return false;
@@ -2739,21 +2713,99 @@ bool Player::removeItemOfType(uint16_t itemId, uint32_t amount, int32_t subType,
 
 std::map<uint32_t, uint32_t>& Player::getAllItemTypeCount(std::map<uint32_t, uint32_t>& countMap) const
 {
+	if (!itemIndexBuilt) {
+		buildItemIndex();
+	}
+
+	for (const auto& it : itemIndex) {
+		uint32_t& count = countMap[it.first];
+		for (const Item* item : it.second) {
+			count += Item::countByType(item, -1);
+		}
+	}
+	return countMap;
+}
+
+const std::vector<Item*>* Player::getIndexedItems(uint16_t itemId) const
+{
+	if (!itemIndexBuilt) {
+		buildItemIndex();
+	}
+
+	auto it = itemIndex.find(itemId);
+	if (it == itemIndex.end()) {
+		return nullptr;
+	}
+	return &it->second;
+}
+
+void Player::buildItemIndex() const
+{
+	// items loaded with the player are added without notifications
+	itemIndex.clear();
+	itemIndexIds.clear();
+	itemIndexBuilt = true;
+
 	for (int32_t i = CONST_SLOT_FIRST; i <= CONST_SLOT_LAST; i++) {
-		Item* item = inventory[i];
-		if (!item) {
-			continue;
+		if (Item* item = inventory[i]) {
+			indexItem(item);
 		}
+	}
+}
 
-		countMap[item->getID()] += Item::countByType(item, -1);
+void Player::indexItem(Item* item) const
+{
+	// a stack that grew is notified again, a transformed item under its new id
+	auto it = itemIndexIds.find(item);
+	if (it != itemIndexIds.end()) {
+		if (it->second != item->getID()) {
+			removeIndexEntry(item, it->second);
+			it->second = item->getID();
+			itemIndex[item->getID()].push_back(item);
+		}
+	} else {
+		itemIndexIds.emplace(item, item->getID());
+		itemIndex[item->getID()].push_back(item);
+	}
 
-		if (Container* container = item->getContainer()) {
-			for (ContainerIterator it = container->iterator(); it.hasNext(); it.advance()) {
-				countMap[(*it)->getID()] += Item::countByType(*it, -1);
-			}
+	if (Container* container = item->getContainer()) {
+		for (Item* containerItem : container->getItemList()) {
+			indexItem(containerItem);
+		}
+	}
+}
+
+void Player::unindexItem(Item* item) const
+{
+	// the id it was indexed under, transformItem changes it in place
+	auto it = itemIndexIds.find(item);
+	if (it != itemIndexIds.end()) {
+		removeIndexEntry(item, it->second);
+		itemIndexIds.erase(it);
+	}
+
+	if (Container* container = item->getContainer()) {
+		for (Item* containerItem : container->getItemList()) {
+			unindexItem(containerItem);
+		}
+	}
+}
+
+void Player::removeIndexEntry(Item* item, uint16_t itemId) const
+{
+	auto it = itemIndex.find(itemId);
+	if (it == itemIndex.end()) {
+		return;
+	}
+
+	std::vector<Item*>& items = it->second;
+	auto itemIt = std::find(items.begin(), items.end(), item);
+	if (itemIt != items.end()) {
+		items.erase(itemIt);
+		if (items.empty()) {
+			itemIndex.erase(it);
 		}
 	}
-	return countMap;
 }
 
 Thing* Player::getThing(size_t index) const
@@ -2786,6 +2838,12 @@ void Player::postAddNotification(Thing* thing, const Cylinder* oldParent, int32_
 			requireListUpdate = oldParent != this;
 		}
 
+		if (itemIndexBuilt) {
+			if (Item* item = thing->getItem()) {
+				indexItem(item);
+			}
+		}
+
 		updateInventoryWeight();
 		updateItemsLight();
 		sendStats();
@@ -2836,6 +2894,14 @@ void Player::postRemoveNotification(Thing* thing, const Cylinder* newParent, int
 			requireListUpdate = newParent != this;
 		}
 
+		// a partly removed stack and an item moved within the inventory stay
+		if (itemIndexBuilt) {
+			Item* item = thing->getItem();
+			if (item && (item->isRemoved() || item->getHoldingPlayer() != this)) {
+				unindexItem(item);
+			}
+		}
+
 		updateInventoryWeight();
 		updateItemsLight();
 		sendStats();
@@ -2925,7 +2991,7 @@ bool Player::setAttackedCreature(Creature* creature)
 	}
 
 	if (creature) {
-		g_dispatcher.addTask(createTask(std::bind(&Game::checkCreatureAttack, &g_game, getID())));
+		g_dispatcher.addTask(createTask(std::bind(&Game::checkCreatureAttack, &g_game, getID()), "Game::checkCreatureAttack"));
 	}
 	return true;
 }
@@ -2981,11 +3047,10 @@ void Player::doAttacking(uint32_t)
 			result = Weapon::useFist(this, attackedCreature);
 		}
 
-		SchedulerTask* task = createSchedulerTask(std::max<uint32_t>(SCHEDULER_MINTICKS, delay), std::bind(&Game::checkCreatureAttack, &g_game, getID()));
 		if (!classicSpeed) {
-			setNextActionTask(task, false);
+			setNextActionTask(createSchedulerTask(std::max<uint32_t>(SCHEDULER_MINTICKS, delay), std::bind(&Game::checkCreatureAttack, &g_game, getID()), "Game::checkCreatureAttack"), false);
 		} else {
-			g_scheduler.addEvent(task);
+			g_game.addCreatureAttack(this, std::max<uint32_t>(SCHEDULER_MINTICKS, delay));
 		}
 
 		if (result) {
@@ -119,12 +119,6 @@ class Player final : public Creature, public Cylinder
 			return this;
 		}
 
-		void setID() override {
-			if (id == 0) {
-				id = playerAutoID++;
-			}
-		}
-
 		static MuteCountMap muteCountMap;
 
 		const std::string& getName() const override {
@@ -1000,6 +994,22 @@ class Player final : public Creature, public Cylinder
 				client->writeToOutputBuffer(message);
 			}
 		}
+		// shared packets from the ProtocolGameBase encoders, see Game::addMagicEffect
+		void sendBroadcast(const NetworkMessage& message) const {
+			if (client) {
+				client->sendBroadcast(message);
+			}
+		}
+		void sendBroadcast(const NetworkMessage& message, const Position& pos) const {
+			if (client) {
+				client->sendBroadcast(message, pos);
+			}
+		}
+		void sendBroadcast(const NetworkMessage& message, const Creature* creature) const {
+			if (client) {
+				client->sendBroadcast(message, creature);
+			}
+		}
 		//Live Cast
 		bool isLiveCasting() {
 			return client && client->castinfo.enabled;
@@ -1111,6 +1121,13 @@ class Player final : public Creature, public Cylinder
 
 		void updateInventoryWeight();
 
+		// the indexed items of that id, nullptr if there are none
+		const std::vector<Item*>* getIndexedItems(uint16_t itemId) const;
+		void buildItemIndex() const;
+		void indexItem(Item* item) const;
+		void unindexItem(Item* item) const;
+		void removeIndexEntry(Item* item, uint16_t itemId) const;
+
 		void setNextWalkActionTask(SchedulerTask* task);
 		void setNextWalkTask(SchedulerTask* task);
 		void setNextActionTask(SchedulerTask* task, bool resetIdleTime = true);
@@ -1154,7 +1171,17 @@ class Player final : public Creature, public Cylinder
 		std::map<uint32_t, DepotChest*> depotChests;
 		std::map<uint32_t, int32_t> storageMap;
 
+		// every item in the inventory and its containers by id, built on first
+		// use and kept in sync by postAddNotification and postRemoveNotification.
+		// Counts are summed from the items on lookup since stack sizes and
+		// charges change without a notification.
+		mutable std::unordered_map<uint16_t, std::vector<Item*>> itemIndex;
+		// the id each item is indexed under, transformItem changes it in place
+		mutable std::unordered_map<const Item*, uint16_t> itemIndexIds;
+
 		std::vector<OutfitEntry> outfits;
+		// player_deliveries applied by loadPlayer, deleted by the next save
+		std::vector<uint32_t> deliveryIds;
 		GuildWarVector guildWarVector;
 
 		std::forward_list<Party*> invitePartyList;
@@ -1254,10 +1281,9 @@ class Player final : public Creature, public Cylinder
 		bool pzLocked = false;
 		bool isConnecting = false;
 		bool addAttackSkillPoint = false;
+		mutable bool itemIndexBuilt = false;
 		bool inventoryAbilities[CONST_SLOT_LAST + 1] = {};
 
-		static uint32_t playerAutoID;
-
 		void updateItemsLight(bool internal = false);
 		int32_t getStepSpeed() const override {
 			return std::max<int32_t>(PLAYER_MIN_SPEED, std::min<int32_t>(PLAYER_MAX_SPEED, getSpeed()));
@@ -88,7 +88,6 @@ void ProtocolGame::login(const std::string& name, uint32_t accountId, OperatingS
 		player->setName(name);
 
 		player->incrementReferenceCounter();
-		player->setID();
 
 		if (!IOLoginData::preloadPlayer(player, name)) {
 			disconnectClient("Your character could not be loaded.");
@@ -183,7 +182,7 @@ void ProtocolGame::login(const std::string& name, uint32_t accountId, OperatingS
 			foundPlayer->disconnect();
 			foundPlayer->isConnecting = true;
 
-			eventConnect = g_scheduler.addEvent(createSchedulerTask(1000, std::bind(&ProtocolGame::connect, getThis(), foundPlayer->getID(), operatingSystem)));
+			eventConnect = g_scheduler.addEvent(createSchedulerTask(1000, std::bind(&ProtocolGame::connect, getThis(), foundPlayer->getID(), operatingSystem), "ProtocolGame::connect"));
 		} else {
 			connect(foundPlayer->getID(), operatingSystem);
 		}
@@ -347,7 +346,7 @@ void ProtocolGame::onRecvFirstMessage(NetworkMessage& msg)
 		return;
 	}
 
-	g_dispatcher.addTask(createTask(std::bind(&ProtocolGame::login, getThis(), characterName, accountId, operatingSystem)));
+	g_dispatcher.addTask(createTask(std::bind(&ProtocolGame::login, getThis(), characterName, accountId, operatingSystem), "ProtocolGame::login"));
 }
 
 void ProtocolGame::writeToSpectatorsOutputBuffer(const NetworkMessage& msg)
@@ -364,8 +363,10 @@ void ProtocolGame::writeToSpectatorsOutputBuffer(const NetworkMessage& msg)
 
 void ProtocolGame::writeToOutputBuffer(const NetworkMessage& msg, bool broadcast/* = true*/)
 {
-		if (broadcast) {
-		g_dispatcher.addTask(createTask(std::bind(&ProtocolGame::writeToSpectatorsOutputBuffer, this, msg)));
+	// the task carries a copy of the whole message buffer, only pay for it
+	// while someone is watching the cast
+	if (broadcast && !castinfo.spectators.empty()) {
+		g_dispatcher.addTask(createTask(std::bind(&ProtocolGame::writeToSpectatorsOutputBuffer, this, msg), "ProtocolGame::writeToSpectatorsOutputBuffer"));
 	}
 
 	auto out = getOutputBuffer(msg.getLength());
@@ -379,6 +380,7 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 	}
 
 	uint8_t recvbyte = msg.getByte();
+	packetOrigin = getPacketOrigin(recvbyte);
 
 	if (!player) {
 		if (recvbyte == 0x0F) {
@@ -401,7 +403,7 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 	}
 
 	switch (recvbyte) {
-		case 0x14: g_dispatcher.addTask(createTask(std::bind(&ProtocolGame::logout, getThis(), true, false))); break;
+		case 0x14: g_dispatcher.addTask(createTask(std::bind(&ProtocolGame::logout, getThis(), true, false), "ProtocolGame::logout")); break;
 		case 0x1E: addGameTask(&Game::playerReceivePing, player->getID()); break;
 		case 0x32: parseExtendedOpcode(msg); break; //otclient extended opcode
 		case 0x40: parseNewPing(msg); break;
@@ -87,6 +87,21 @@ void ProtocolGameBase::connect(uint32_t playerId, OperatingSystem_t operatingSys
 	acceptPackets = true;
 }
 
+const char* ProtocolGameBase::getPacketOrigin(uint8_t recvbyte)
+{
+	static const std::vector<std::string> origins = []() {
+		std::vector<std::string> names;
+		names.reserve(256);
+		for (int opcode = 0; opcode < 256; ++opcode) {
+			std::ostringstream ss;
+			ss << "packet 0x" << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << opcode;
+			names.push_back(ss.str());
+		}
+		return names;
+	}();
+	return origins[recvbyte].c_str();
+}
+
 void ProtocolGameBase::parsePacket(NetworkMessage& msg)
 {
 	if (!acceptPackets || g_game.getGameState() == GAME_STATE_SHUTDOWN || msg.getLength() <= 0) {
@@ -94,6 +109,7 @@ void ProtocolGameBase::parsePacket(NetworkMessage& msg)
 	}
 
 	uint8_t recvbyte = msg.getByte();
+	packetOrigin = getPacketOrigin(recvbyte);
 
 	if (!player) {
 		if (recvbyte == 0x0F) {
@@ -116,7 +132,7 @@ void ProtocolGameBase::parsePacket(NetworkMessage& msg)
 	}
 
 	switch (recvbyte) {
-	case 0x14: g_dispatcher.addTask(createTask(std::bind(&ProtocolGame::logout, getThis(), true, false))); break;
+	case 0x14: g_dispatcher.addTask(createTask(std::bind(&ProtocolGame::logout, getThis(), true, false), "ProtocolGame::logout")); break;
 	case 0x1E: addGameTask(&Game::playerReceivePing, player->getID()); break;
 	case 0x32: parseExtendedOpcode(msg); break; //otclient extended opcode
 	case 0x40: parseNewPing(msg); break;
@@ -408,9 +424,7 @@ void ProtocolGameBase::sendCreatureOutfit(const Creature* creature, const Outfit
 	}
 
 	NetworkMessage msg;
-	msg.addByte(0x8E);
-	msg.add<uint32_t>(creature->getID());
-	AddOutfit(msg, outfit);
+	AddCreatureOutfit(msg, creature, outfit);
 	writeToOutputBuffer(msg);
 }
 
@@ -637,13 +651,7 @@ void ProtocolGameBase::sendChannel(uint16_t channelId, const std::string& channe
 void ProtocolGameBase::sendChannelMessage(const std::string& author, const std::string& text, SpeakClasses type, uint16_t channel)
 {
 	NetworkMessage msg;
-	msg.addByte(0xAA);
-	msg.add<uint32_t>(0x00);
-	msg.addString(author);
-	msg.add<uint16_t>(0x00);
-	msg.addByte(type);
-	msg.add<uint16_t>(channel);
-	msg.addString(text);
+	AddChannelMessage(msg, author, text, type, channel);
 	writeToOutputBuffer(msg);
 }
 
@@ -720,64 +728,23 @@ void ProtocolGameBase::sendSaleItemList(const std::list<ShopInfo>& shop)
 
 	std::map<uint16_t, uint32_t> saleMap;
 
-	if (shop.size() <= 5) {
-		// For very small shops it's not worth it to create the complete map
-		for (const ShopInfo& shopInfo : shop) {
-			if (shopInfo.sellPrice == 0) {
-				continue;
-			}
-
-			int8_t subtype = -1;
-
-			const ItemType& itemType = Item::items[shopInfo.itemId];
-			if (itemType.hasSubType() && !itemType.stackable) {
-				subtype = (shopInfo.subType == 0 ? -1 : shopInfo.subType);
-			}
-
-			uint32_t count = player->getItemTypeCount(shopInfo.itemId, subtype);
-			if (count > 0) {
-				saleMap[shopInfo.itemId] = count;
-			}
+	// the player's item index answers each count directly, there is no need
+	// to count the whole inventory up front for large shops
+	for (const ShopInfo& shopInfo : shop) {
+		if (shopInfo.sellPrice == 0) {
+			continue;
 		}
-	} else {
-		// Large shop, it's better to get a cached map of all item counts and use it
-		// We need a temporary map since the finished map should only contain items
-		// available in the shop
-		std::map<uint32_t, uint32_t> tempSaleMap;
-		player->getAllItemTypeCount(tempSaleMap);
-
-		// We must still check manually for the special items that require subtype matches
-		// (That is, fluids such as potions etc., actually these items are very few since
-		// health potions now use their own ID)
-		for (const ShopInfo& shopInfo : shop) {
-			if (shopInfo.sellPrice == 0) {
-				continue;
-			}
-
-			int8_t subtype = -1;
 
-			const ItemType& itemType = Item::items[shopInfo.itemId];
-			if (itemType.hasSubType() && !itemType.stackable) {
-				subtype = (shopInfo.subType == 0 ? -1 : shopInfo.subType);
-			}
+		int8_t subtype = -1;
 
-			if (subtype != -1) {
-				uint32_t count;
-				if (!itemType.isFluidContainer() && !itemType.isSplash()) {
-					count = player->getItemTypeCount(shopInfo.itemId, subtype); // This shop item requires extra checks
-				} else {
-					count = subtype;
-				}
+		const ItemType& itemType = Item::items[shopInfo.itemId];
+		if (itemType.hasSubType() && !itemType.stackable) {
+			subtype = (shopInfo.subType == 0 ? -1 : shopInfo.subType);
+		}
 
-				if (count > 0) {
-					saleMap[shopInfo.itemId] = count;
-				}
-			} else {
-				std::map<uint32_t, uint32_t>::const_iterator findIt = tempSaleMap.find(shopInfo.itemId);
-				if (findIt != tempSaleMap.end() && findIt->second > 0) {
-					saleMap[shopInfo.itemId] = findIt->second;
-				}
-			}
+		uint32_t count = player->getItemTypeCount(shopInfo.itemId, subtype);
+		if (count > 0) {
+			saleMap[shopInfo.itemId] = count;
 		}
 	}
 
@@ -1318,56 +1285,14 @@ void ProtocolGameBase::sendCreatureTurn(const Creature* creature, uint32_t stack
 void ProtocolGameBase::sendCreatureSay(const Creature* creature, SpeakClasses type, const std::string& text, const Position* pos/* = nullptr*/)
 {
 	NetworkMessage msg;
-	msg.addByte(0xAA);
-
-	static uint32_t statementId = 0;
-	msg.add<uint32_t>(++statementId);
-
-	msg.addString(creature->getName());
-
-	//Add level only for players
-	if (const Player* speaker = creature->getPlayer()) {
-		msg.add<uint16_t>(speaker->getLevel());
-	} else {
-		msg.add<uint16_t>(0x00);
-	}
-
-	msg.addByte(type);
-	if (pos) {
-		msg.addPosition(*pos);
-	} else {
-		msg.addPosition(creature->getPosition());
-	}
-
-	msg.addString(text);
+	AddCreatureSay(msg, creature, type, text, pos ? *pos : creature->getPosition());
 	writeToOutputBuffer(msg);
 }
 
 void ProtocolGameBase::sendToChannel(const Creature* creature, SpeakClasses type, const std::string& text, uint16_t channelId)
 {
 	NetworkMessage msg;
-	msg.addByte(0xAA);
-
-	static uint32_t statementId = 0;
-	msg.add<uint32_t>(++statementId);
-	if (!creature) {
-		msg.add<uint32_t>(0x00);
-	} else if (type == TALKTYPE_CHANNEL_R2) {
-		msg.add<uint32_t>(0x00);
-		type = TALKTYPE_CHANNEL_R1;
-	} else {
-		msg.addString(creature->getName());
-		//Add level only for players
-		if (const Player* speaker = creature->getPlayer()) {
-			msg.add<uint16_t>(speaker->getLevel());
-		} else {
-			msg.add<uint16_t>(0x00);
-		}
-	}
-
-	msg.addByte(type);
-	msg.add<uint16_t>(channelId);
-	msg.addString(text);
+	AddToChannel(msg, creature, type, text, channelId);
 	writeToOutputBuffer(msg);
 }
 
@@ -1399,10 +1324,7 @@ void ProtocolGameBase::sendCancelTarget()
 void ProtocolGameBase::sendChangeSpeed(const Creature* creature, uint32_t speed)
 {
 	NetworkMessage msg;
-	msg.addByte(0x8F);
-	msg.add<uint32_t>(creature->getID());
-	msg.add<uint16_t>(creature->getBaseSpeed() / 2);
-	msg.add<uint16_t>(speed / 2);
+	AddCreatureSpeed(msg, creature, speed);
 	writeToOutputBuffer(msg);
 }
 
@@ -1438,10 +1360,7 @@ void ProtocolGameBase::sendPingBack()
 void ProtocolGameBase::sendDistanceShoot(const Position& from, const Position& to, uint8_t type)
 {
 	NetworkMessage msg;
-	msg.addByte(0x85);
-	msg.addPosition(from);
-	msg.addPosition(to);
-	msg.addByte(type);
+	AddDistanceShoot(msg, from, to, type);
 	writeToOutputBuffer(msg);
 }
 
@@ -1452,23 +1371,14 @@ void ProtocolGameBase::sendMagicEffect(const Position& pos, uint8_t type)
 	}
 
 	NetworkMessage msg;
-	msg.addByte(0x83);
-	msg.addPosition(pos);
-	msg.addByte(type);
+	AddMagicEffect(msg, pos, type);
 	writeToOutputBuffer(msg);
 }
 
 void ProtocolGameBase::sendCreatureHealth(const Creature* creature)
 {
 	NetworkMessage msg;
-	msg.addByte(0x8C);
-	msg.add<uint32_t>(creature->getID());
-
-	if (creature->isHealthHidden()) {
-		msg.addByte(0x00);
-	} else {
-		msg.addByte(std::ceil((static_cast<double>(creature->getHealth()) / std::max<int32_t>(creature->getMaxHealth(), 1)) * 100));
-	}
+	AddCreatureHealth(msg, creature);
 	writeToOutputBuffer(msg);
 }
 
@@ -2066,6 +1976,106 @@ void ProtocolGameBase::AddPlayerSkills(NetworkMessage& msg)
 	}
 }
 
+void ProtocolGameBase::AddMagicEffect(NetworkMessage& msg, const Position& pos, uint8_t type)
+{
+	msg.addByte(0x83);
+	msg.addPosition(pos);
+	msg.addByte(type);
+}
+
+void ProtocolGameBase::AddDistanceShoot(NetworkMessage& msg, const Position& from, const Position& to, uint8_t type)
+{
+	msg.addByte(0x85);
+	msg.addPosition(from);
+	msg.addPosition(to);
+	msg.addByte(type);
+}
+
+void ProtocolGameBase::AddCreatureSay(NetworkMessage& msg, const Creature* creature, SpeakClasses type, const std::string& text, const Position& pos)
+{
+	msg.addByte(0xAA);
+
+	static uint32_t statementId = 0;
+	msg.add<uint32_t>(++statementId);
+
+	msg.addString(creature->getName());
+
+	//Add level only for players
+	if (const Player* speaker = creature->getPlayer()) {
+		msg.add<uint16_t>(speaker->getLevel());
+	} else {
+		msg.add<uint16_t>(0x00);
+	}
+
+	msg.addByte(type);
+	msg.addPosition(pos);
+	msg.addString(text);
+}
+
+void ProtocolGameBase::AddCreatureSpeed(NetworkMessage& msg, const Creature* creature, uint32_t speed)
+{
+	msg.addByte(0x8F);
+	msg.add<uint32_t>(creature->getID());
+	msg.add<uint16_t>(creature->getBaseSpeed() / 2);
+	msg.add<uint16_t>(speed / 2);
+}
+
+void ProtocolGameBase::AddCreatureHealth(NetworkMessage& msg, const Creature* creature)
+{
+	msg.addByte(0x8C);
+	msg.add<uint32_t>(creature->getID());
+
+	if (creature->isHealthHidden()) {
+		msg.addByte(0x00);
+	} else {
+		msg.addByte(std::ceil((static_cast<double>(creature->getHealth()) / std::max<int32_t>(creature->getMaxHealth(), 1)) * 100));
+	}
+}
+
+void ProtocolGameBase::AddCreatureOutfit(NetworkMessage& msg, const Creature* creature, const Outfit_t& outfit)
+{
+	msg.addByte(0x8E);
+	msg.add<uint32_t>(creature->getID());
+	AddOutfit(msg, outfit);
+}
+
+void ProtocolGameBase::AddChannelMessage(NetworkMessage& msg, const std::string& author, const std::string& text, SpeakClasses type, uint16_t channelId)
+{
+	msg.addByte(0xAA);
+	msg.add<uint32_t>(0x00);
+	msg.addString(author);
+	msg.add<uint16_t>(0x00);
+	msg.addByte(type);
+	msg.add<uint16_t>(channelId);
+	msg.addString(text);
+}
+
+void ProtocolGameBase::AddToChannel(NetworkMessage& msg, const Creature* creature, SpeakClasses type, const std::string& text, uint16_t channelId)
+{
+	msg.addByte(0xAA);
+
+	static uint32_t statementId = 0;
+	msg.add<uint32_t>(++statementId);
+	if (!creature) {
+		msg.add<uint32_t>(0x00);
+	} else if (type == TALKTYPE_CHANNEL_R2) {
+		msg.add<uint32_t>(0x00);
+		type = TALKTYPE_CHANNEL_R1;
+	} else {
+		msg.addString(creature->getName());
+		//Add level only for players
+		if (const Player* speaker = creature->getPlayer()) {
+			msg.add<uint16_t>(speaker->getLevel());
+		} else {
+			msg.add<uint16_t>(0x00);
+		}
+	}
+
+	msg.addByte(type);
+	msg.add<uint16_t>(channelId);
+	msg.addString(text);
+}
+
 void ProtocolGameBase::AddOutfit(NetworkMessage& msg, const Outfit_t& outfit)
 {
 	msg.add<uint16_t>(outfit.lookType);
@@ -2260,7 +2270,7 @@ void ProtocolGameBase::parseChangeAwareRange(NetworkMessage& msg)
 	uint8_t width = msg.get<uint8_t>();
 	uint8_t height = msg.get<uint8_t>();
 
-	g_dispatcher.addTask(createTask(std::bind(&ProtocolGameBase::updateAwareRange, getThis(), width, height)));
+	g_dispatcher.addTask(createTask(std::bind(&ProtocolGameBase::updateAwareRange, getThis(), width, height), "ProtocolGameBase::updateAwareRange"));
 }
 
 void ProtocolGameBase::updateAwareRange(int width, int height)
@@ -2340,7 +2350,7 @@ void ProtocolGameBase::parseNewWalking(NetworkMessage& msg)
 		}
 
 		g_game.playerNewWalk(playerId, playerPosition, flags, path);
-		}));
+		}, "Game::playerNewWalk"));
 }
 
 void ProtocolGameBase::checkPredictiveWalking(const Position& pos)
@@ -2397,7 +2407,7 @@ void ProtocolGameBase::parseNewPing(NetworkMessage& msg)
 	uint16_t fps = msg.get<uint16_t>();
 
 	addGameTask(&Game::playerReceiveNewPing, player->getID(), localPing, fps);
-	g_dispatcher.addTask(createTask(std::bind(&ProtocolGameBase::sendNewPing, getThis(), pingId)));
+	g_dispatcher.addTask(createTask(std::bind(&ProtocolGameBase::sendNewPing, getThis(), pingId), "ProtocolGameBase::sendNewPing"));
 }
 
 void ProtocolGameBase::sendNewPing(uint32_t pingId)
@@ -79,6 +79,18 @@ class ProtocolGameBase : public Protocol
 			return version;
 		}
 
+		// Packets that are the same for every viewer. The Game broadcasters
+		// encode them once and hand the message to each spectator through
+		// Player::sendBroadcast instead of every client encoding its own copy.
+		static void AddMagicEffect(NetworkMessage& msg, const Position& pos, uint8_t type);
+		static void AddDistanceShoot(NetworkMessage& msg, const Position& from, const Position& to, uint8_t type);
+		static void AddCreatureSay(NetworkMessage& msg, const Creature* creature, SpeakClasses type, const std::string& text, const Position& pos);
+		static void AddCreatureSpeed(NetworkMessage& msg, const Creature* creature, uint32_t speed);
+		static void AddCreatureHealth(NetworkMessage& msg, const Creature* creature);
+		static void AddCreatureOutfit(NetworkMessage& msg, const Creature* creature, const Outfit_t& outfit);
+		static void AddChannelMessage(NetworkMessage& msg, const std::string& author, const std::string& text, SpeakClasses type, uint16_t channelId);
+		static void AddToChannel(NetworkMessage& msg, const Creature* creature, SpeakClasses type, const std::string& text, uint16_t channelId);
+
 	private:
 		ProtocolGame_ptr getThis() {
 			return std::static_pointer_cast<ProtocolGame>(shared_from_this());
@@ -99,6 +111,22 @@ class ProtocolGameBase : public Protocol
 		void parsePacket(NetworkMessage& msg) override;
 		void onConnect() override;
 
+		// a shared packet from one of the encoders above, filtered by what
+		// this client can see
+		void sendBroadcast(const NetworkMessage& msg) {
+			writeToOutputBuffer(msg);
+		}
+		void sendBroadcast(const NetworkMessage& msg, const Position& pos) {
+			if (canSee(pos)) {
+				writeToOutputBuffer(msg);
+			}
+		}
+		void sendBroadcast(const NetworkMessage& msg, const Creature* creature) {
+			if (canSee(creature)) {
+				writeToOutputBuffer(msg);
+			}
+		}
+
 		//Send functions
 		void sendChannelMessage(const std::string& author, const std::string& text, SpeakClasses type, uint16_t channel);
 		void sendChannelEvent(uint16_t channelId, const std::string& playerName, ChannelEvent_t channelEvent, bool broadcast = true);
@@ -218,7 +246,7 @@ class ProtocolGameBase : public Protocol
 
 		void AddCreature(NetworkMessage& msg, const Creature* creature, bool known, uint32_t remove);
 		void AddPlayerStats(NetworkMessage& msg);
-		void AddOutfit(NetworkMessage& msg, const Outfit_t& outfit);
+		static void AddOutfit(NetworkMessage& msg, const Outfit_t& outfit);
 		void AddPlayerSkills(NetworkMessage& msg);
 		void AddWorldLight(NetworkMessage& msg, LightInfo lightInfo);
 		void AddCreatureLight(NetworkMessage& msg, const Creature* creature);
@@ -259,14 +287,18 @@ class ProtocolGameBase : public Protocol
 		// Helpers so we don't need to bind every time
 		template <typename Callable, typename... Args>
 		void addGameTask(Callable function, Args&&... args) {
-			g_dispatcher.addTask(createTask(std::bind(function, &g_game, std::forward<Args>(args)...)));
+			g_dispatcher.addTask(createTask(std::bind(function, &g_game, std::forward<Args>(args)...), packetOrigin));
 		}
 
 		template <typename Callable, typename... Args>
 		void addGameTaskTimed(uint32_t delay, Callable function, Args&&... args) {
-			g_dispatcher.addTask(createTask(delay, std::bind(function, &g_game, std::forward<Args>(args)...)));
+			g_dispatcher.addTask(createTask(delay, std::bind(function, &g_game, std::forward<Args>(args)...), packetOrigin));
 		}
 
+		// game tasks are tagged with the opcode of the packet that created them
+		static const char* getPacketOrigin(uint8_t recvbyte);
+		const char* packetOrigin = nullptr;
+
 		std::unordered_set<uint32_t> knownCreatureSet;
 		Player* player = nullptr;
 
@@ -231,17 +231,18 @@ void ProtocolLogin::onRecvFirstMessage(NetworkMessage& msg)
 				disconnectClient("There are no live casts right now.", version);
 			} else {
 				auto thisPtr = std::static_pointer_cast<ProtocolLogin>(shared_from_this());
-				g_dispatcher.addTask(createTask(std::bind(&ProtocolLogin::getCastList, thisPtr, password, version)));
+				g_dispatcher.addTask(createTask(std::bind(&ProtocolLogin::getCastList, thisPtr, password, version), "ProtocolLogin::getCastList"));
 			}
 		} else {
 			disconnectClient("Invalid account number.", version);
 		}
 		return;
 	}
-	
-		if (password.empty()) {
+
+	if (password.empty()) {
 		disconnectClient("Invalid password.", version);
 		return;
+	}
 
 	// OTCv8 version detection
 	uint16_t otclientV8 = 0;
@@ -251,6 +252,5 @@ void ProtocolLogin::onRecvFirstMessage(NetworkMessage& msg)
 	}
 
 	auto thisPtr = std::static_pointer_cast<ProtocolLogin>(shared_from_this());
-	g_dispatcher.addTask(createTask(std::bind(&ProtocolLogin::getCharacterList, thisPtr, accountNumber, password, version)));
-}
+	g_dispatcher.addTask(createTask(std::bind(&ProtocolLogin::getCharacterList, thisPtr, accountNumber, password, version), "ProtocolLogin::getCharacterList"));
 }
@@ -120,7 +120,7 @@ void ProtocolSpectator::onRecvFirstMessage(NetworkMessage& msg)
 		return;
 	}
 
-	g_dispatcher.addTask(createTask(std::bind(&ProtocolSpectator::login, getThis(), characterName, password)));
+	g_dispatcher.addTask(createTask(std::bind(&ProtocolSpectator::login, getThis(), characterName, password), "ProtocolSpectator::login"));
 }
 
 void ProtocolSpectator::login(const std::string& character, const std::string& password)
@@ -224,6 +224,7 @@ void ProtocolSpectator::parsePacket(NetworkMessage& msg)
 	}
 
 	uint8_t recvbyte = msg.getByte();
+	packetOrigin = getPacketOrigin(recvbyte);
 
 	if (!player) {
 		if (recvbyte == 0x0F) {
@@ -246,7 +247,7 @@ void ProtocolSpectator::parsePacket(NetworkMessage& msg)
 	}
 
 	switch (recvbyte) {
-		case 0x14: g_dispatcher.addTask(createTask(std::bind(&ProtocolSpectator::disconnect, getThis()))); break;
+		case 0x14: g_dispatcher.addTask(createTask(std::bind(&ProtocolSpectator::disconnect, getThis()), "ProtocolSpectator::disconnect")); break;
 		case 0x1E: addGameTask(&Game::playerReceivePing, player->getID()); break;
 		case 0x64: case 0x65: case 0x66: case 0x67: case 0x68: case 0x6A: case 0x6B: case 0x6C: case 0x6D: sendCancelWalk(); break;
 		case 0x96: parseSay(msg); break;
@@ -289,7 +290,7 @@ void ProtocolSpectator::parseCloseChannel(NetworkMessage& msg)
 {
 	uint16_t channelId = msg.get<uint16_t>();
 	if (channelId == CHANNEL_CAST) {
-		g_dispatcher.addTask(createTask(std::bind(&ProtocolSpectator::reOpenCastChannel, getThis())));
+		g_dispatcher.addTask(createTask(std::bind(&ProtocolSpectator::reOpenCastChannel, getThis()), "ProtocolSpectator::reOpenCastChannel"));
 	}
 }
 
@@ -332,8 +333,7 @@ void ProtocolSpectator::syncChannels()
 {
 	const auto channels = g_chat->getChannelList(*player);
 	for (const auto channel : channels) {
-		const auto& channelUsers = channel->getUsers();
-		if (channelUsers.find(player->getID()) != channelUsers.end()) {
+		if (channel->hasUser(*player)) {
 			sendChannel(channel->getId(), channel->getName());
 		}
 	}
@@ -62,7 +62,7 @@ void ProtocolStatus::onRecvFirstMessage(NetworkMessage& msg)
 		case 0xFF: {
 			if (msg.getString(4) == "info") {
 				g_dispatcher.addTask(createTask(std::bind(&ProtocolStatus::sendStatusString,
-									  std::static_pointer_cast<ProtocolStatus>(shared_from_this()))));
+									  std::static_pointer_cast<ProtocolStatus>(shared_from_this())), "ProtocolStatus::sendStatusString"));
 				return;
 			}
 			break;
@@ -76,7 +76,7 @@ void ProtocolStatus::onRecvFirstMessage(NetworkMessage& msg)
 				characterName = msg.getString();
 			}
 			g_dispatcher.addTask(createTask(std::bind(&ProtocolStatus::sendInfo, std::static_pointer_cast<ProtocolStatus>(shared_from_this()),
-								  requestedInfo, characterName)));
+								  requestedInfo, characterName), "ProtocolStatus::sendInfo"));
 			return;
 		}
 
@@ -202,9 +202,9 @@ void ProtocolStatus::sendInfo(uint16_t requestedInfo, const std::string& charact
 
 		const auto& players = g_game.getPlayers();
 		output->add<uint32_t>(players.size());
-		for (const auto& it : players) {
-			output->addString(it.second->getName());
-			output->add<uint32_t>(it.second->getLevel());
+		for (const Player* player : players) {
+			output->addString(player->getName());
+			output->add<uint32_t>(player->getLevel());
 		}
 	}
 
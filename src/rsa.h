@@ -36,6 +36,9 @@ class RSA
 		void loadPEM(const std::string& filename);
 		void decrypt(char* msg) const;
 
+		// public key operation, what the client does with the login block
+		void encrypt(char* msg) const;
+
 	private:
 		CryptoPP::RSA::PrivateKey pk;
 };
@@ -132,7 +132,7 @@ void Scheduler::shutdown()
 	eventSignal.notify_one();
 }
 
-SchedulerTask* createSchedulerTask(uint32_t delay, std::function<void (void)> f)
+SchedulerTask* createSchedulerTask(uint32_t delay, std::function<void (void)> f, const char* origin /*= nullptr*/)
 {
-	return new SchedulerTask(delay, std::move(f));
+	return new SchedulerTask(delay, std::move(f), origin);
 }
@@ -43,14 +43,14 @@ class SchedulerTask : public Task
 		}
 
 	private:
-		SchedulerTask(uint32_t delay, std::function<void (void)>&& f) : Task(delay, std::move(f)) {}
+		SchedulerTask(uint32_t delay, std::function<void (void)>&& f, const char* origin) : Task(delay, std::move(f), origin) {}
 
 		uint32_t eventId = 0;
 
-		friend SchedulerTask* createSchedulerTask(uint32_t, std::function<void (void)>);
+		friend SchedulerTask* createSchedulerTask(uint32_t, std::function<void (void)>, const char*);
 };
 
-SchedulerTask* createSchedulerTask(uint32_t delay, std::function<void (void)> f);
+SchedulerTask* createSchedulerTask(uint32_t delay, std::function<void (void)> f, const char* origin = nullptr);
 
 struct TaskComparator {
 	bool operator()(const SchedulerTask* lhs, const SchedulerTask* rhs) const {
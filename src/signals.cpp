@@ -95,21 +95,21 @@ void Signals::dispatchSignalHandler(int signal)
 {
 	switch(signal) {
 		case SIGINT: //Shuts the server down
-			g_dispatcher.addTask(createTask(sigintHandler));
+			g_dispatcher.addTask(createTask(sigintHandler, "Signals::sigintHandler"));
 			break;
 		case SIGTERM: //Shuts the server down
-			g_dispatcher.addTask(createTask(sigtermHandler));
+			g_dispatcher.addTask(createTask(sigtermHandler, "Signals::sigtermHandler"));
 			break;
 #ifndef _WIN32
 		case SIGHUP: //Reload config/data
-			g_dispatcher.addTask(createTask(sighupHandler));
+			g_dispatcher.addTask(createTask(sighupHandler, "Signals::sighupHandler"));
 			break;
 		case SIGUSR1: //Saves game state
-			g_dispatcher.addTask(createTask(sigusr1Handler));
+			g_dispatcher.addTask(createTask(sigusr1Handler, "Signals::sigusr1Handler"));
 			break;
 #else
 		case SIGBREAK: //Shuts the server down
-			g_dispatcher.addTask(createTask(sigbreakHandler));
+			g_dispatcher.addTask(createTask(sigbreakHandler, "Signals::sigbreakHandler"));
 			// hold the thread until other threads end
 			g_scheduler.join();
 			g_databaseTasks.join();
@@ -0,0 +1,168 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "otpch.h"
+
+#include "slaballocator.h"
+
+#include <deque>
+
+namespace {
+
+constexpr size_t SLAB_SIZE = 64 * 1024;
+constexpr size_t GRANULARITY = 16;
+constexpr size_t SIZE_CLASSES = SlabAllocator::MAX_BLOCK_SIZE / GRANULARITY;
+
+#ifdef SLAB_DEBUG
+constexpr uint8_t FREED_PATTERN = 0xDD;
+constexpr size_t QUARANTINE_SIZE = 1024;
+#endif
+
+struct FreeBlock {
+	FreeBlock* next;
+};
+
+// Items and tiles are also created on the map loader threads, every class
+// has its own lock
+struct SizeClass {
+	std::mutex lock;
+	FreeBlock* freeList = nullptr;
+	char* slabPos = nullptr;
+	char* slabEnd = nullptr;
+	size_t slabs = 0;
+	uint64_t allocations = 0;
+	uint64_t deallocations = 0;
+#ifdef SLAB_DEBUG
+	std::deque<char*> quarantine;
+#endif
+};
+
+// never destroyed, objects are still released while statics are torn down
+SizeClass* getSizeClasses()
+{
+	static SizeClass* sizeClasses = new SizeClass[SIZE_CLASSES];
+	return sizeClasses;
+}
+
+size_t getClassIndex(size_t size)
+{
+	return (size - 1) / GRANULARITY;
+}
+
+size_t getBlockSize(size_t index)
+{
+	return (index + 1) * GRANULARITY;
+}
+
+#ifdef SLAB_DEBUG
+void checkFreedBlock(const char* block, size_t blockSize)
+{
+	for (size_t i = 0; i < blockSize; ++i) {
+		if (static_cast<uint8_t>(block[i]) != FREED_PATTERN) {
+			std::cout << "[Error - SlabAllocator] Block " << static_cast<const void*>(block) << " of size " << blockSize << " was written at offset " << i << " after it was freed." << std::endl;
+			std::abort();
+		}
+	}
+}
+#endif
+
+}
+
+void* SlabAllocator::allocate(size_t size)
+{
+	if (size == 0 || size > MAX_BLOCK_SIZE) {
+		return ::operator new(size);
+	}
+
+	size_t index = getClassIndex(size);
+	size_t blockSize = getBlockSize(index);
+	SizeClass& sizeClass = getSizeClasses()[index];
+
+	std::lock_guard<std::mutex> lockGuard(sizeClass.lock);
+	++sizeClass.allocations;
+
+	if (FreeBlock* block = sizeClass.freeList) {
+		sizeClass.freeList = block->next;
+		return block;
+	}
+
+	if (sizeClass.slabPos == sizeClass.slabEnd) {
+		sizeClass.slabPos = static_cast<char*>(::operator new(SLAB_SIZE));
+		sizeClass.slabEnd = sizeClass.slabPos + (SLAB_SIZE / blockSize) * blockSize;
+		++sizeClass.slabs;
+	}
+
+	void* block = sizeClass.slabPos;
+	sizeClass.slabPos += blockSize;
+	return block;
+}
+
+void SlabAllocator::deallocate(void* p, size_t size)
+{
+	if (!p) {
+		return;
+	}
+
+	if (size == 0 || size > MAX_BLOCK_SIZE) {
+		::operator delete(p);
+		return;
+	}
+
+	size_t index = getClassIndex(size);
+	SizeClass& sizeClass = getSizeClasses()[index];
+
+	std::lock_guard<std::mutex> lockGuard(sizeClass.lock);
+	++sizeClass.deallocations;
+
+#ifdef SLAB_DEBUG
+	size_t blockSize = getBlockSize(index);
+	char* freed = static_cast<char*>(p);
+	std::fill(freed, freed + blockSize, static_cast<char>(FREED_PATTERN));
+	sizeClass.quarantine.push_back(freed);
+	if (sizeClass.quarantine.size() <= QUARANTINE_SIZE) {
+		return;
+	}
+
+	p = sizeClass.quarantine.front();
+	sizeClass.quarantine.pop_front();
+	checkFreedBlock(static_cast<char*>(p), blockSize);
+#endif
+
+	FreeBlock* block = static_cast<FreeBlock*>(p);
+	block->next = sizeClass.freeList;
+	sizeClass.freeList = block;
+}
+
+std::vector<SlabAllocator::Stats> SlabAllocator::getStats()
+{
+	std::vector<Stats> stats;
+
+	SizeClass* sizeClasses = getSizeClasses();
+	for (size_t index = 0; index < SIZE_CLASSES; ++index) {
+		SizeClass& sizeClass = sizeClasses[index];
+
+		std::lock_guard<std::mutex> lockGuard(sizeClass.lock);
+		if (sizeClass.slabs == 0) {
+			continue;
+		}
+
+		stats.push_back({getBlockSize(index), sizeClass.allocations, sizeClass.deallocations, sizeClass.slabs});
+	}
+	return stats;
+}
@@ -0,0 +1,75 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef FS_SLABALLOCATOR_H_7787CECAB5594465A0AE093BF8351369
+#define FS_SLABALLOCATOR_H_7787CECAB5594465A0AE093BF8351369
+
+// Size class allocator for the objects the world holds by the million.
+// Memory is taken in 64 KB slabs cut into blocks of one size class, freed
+// blocks go to the free list of their class and are handed to the next
+// object of that size. Slabs are never given back, short and long lived
+// objects of a class share them instead of scattering over the general heap,
+// so the memory in use stops growing once the peak population is reached.
+// Objects larger than MAX_BLOCK_SIZE use the global allocator.
+//
+// LockfreePoolingAllocator (lockfree.h) stays for the output messages: it
+// pools a bounded number of blocks of one type for std::allocate_shared and
+// hands them between the dispatcher and the network threads without a lock,
+// but every block still comes from the general heap and the overflow goes
+// back to it. Neither helps with fragmentation, which is what this one is
+// for: unbounded classes carved out of contiguous slabs and shared by all
+// types of a size, at the cost of a lock per class.
+//
+// Built with SLAB_DEBUG freed blocks are filled with a pattern and held in
+// a quarantine before they are reused, a block whose pattern changed in
+// the meantime was written after it was freed and aborts the server.
+class SlabAllocator
+{
+	public:
+		static constexpr size_t MAX_BLOCK_SIZE = 2048;
+
+		struct Stats {
+			size_t blockSize;
+			uint64_t allocations;
+			uint64_t deallocations;
+			size_t slabs;
+		};
+
+		static void* allocate(size_t size);
+		static void deallocate(void* p, size_t size);
+
+		// the size classes used so far
+		static std::vector<Stats> getStats();
+};
+
+// Base of the classes allocated from SlabAllocator, derived classes are
+// allocated from the size class of their own size.
+class SlabAllocated
+{
+	public:
+		static void* operator new(size_t size) {
+			return SlabAllocator::allocate(size);
+		}
+		// with a virtual destructor size is the size of the dynamic type
+		static void operator delete(void* p, size_t size) {
+			SlabAllocator::deallocate(p, size);
+		}
+};
+
+#endif
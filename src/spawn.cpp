@@ -35,90 +35,140 @@ extern Events* g_events;
 
 static constexpr int32_t MINSPAWN_INTERVAL = 1000;
 
-bool Spawns::loadFromXml(const std::string& filename)
+// monsters spawned per run of Spawns::checkSpawns, the rest are spawned by
+// the next run SPAWN_BATCH_DELAY later
+static constexpr uint32_t SPAWN_BATCH_SIZE = 50;
+static constexpr uint32_t SPAWN_BATCH_DELAY = 100;
+
+// side of the square map regions players are indexed by, a respawn looks
+// at no more than 2x2 of them
+static constexpr int32_t SPAWN_REGION_SIZE = 32;
+
+namespace {
+
+uint64_t getRegionKey(int32_t regionX, int32_t regionY, uint8_t z)
 {
-	if (loaded) {
-		return true;
-	}
+	return (static_cast<uint64_t>(z) << 32) | (static_cast<uint64_t>(regionX) << 16) | static_cast<uint64_t>(regionY);
+}
+
+uint64_t getRegionKey(const Position& pos)
+{
+	return getRegionKey(pos.x / SPAWN_REGION_SIZE, pos.y / SPAWN_REGION_SIZE, pos.z);
+}
+
+}
 
+bool Spawns::parseXml(const std::string& filename, std::vector<SpawnDefinition>& definitions)
+{
 	pugi::xml_document doc;
 	pugi::xml_parse_result result = doc.load_file(filename.c_str());
 	if (!result) {
-		printXMLError("Error - Spawns::loadFromXml", filename, result);
+		printXMLError("Error - Spawns::parseXml", filename, result);
 		return false;
 	}
 
-	this->filename = filename;
-	loaded = true;
-
 	for (auto spawnNode : doc.child("spawns").children()) {
-		Position centerPos(
+		definitions.emplace_back();
+		SpawnDefinition& definition = definitions.back();
+
+		Position& centerPos = definition.centerPos;
+		centerPos = Position(
 			pugi::cast<uint16_t>(spawnNode.attribute("centerx").value()),
 			pugi::cast<uint16_t>(spawnNode.attribute("centery").value()),
 			pugi::cast<uint16_t>(spawnNode.attribute("centerz").value())
 		);
 
-		int32_t radius;
 		pugi::xml_attribute radiusAttribute = spawnNode.attribute("radius");
 		if (radiusAttribute) {
-			radius = pugi::cast<int32_t>(radiusAttribute.value());
+			definition.radius = pugi::cast<int32_t>(radiusAttribute.value());
 		} else {
-			radius = -1;
+			definition.radius = -1;
 		}
 
-		spawnList.emplace_front(centerPos, radius);
-		Spawn& spawn = spawnList.front();
-
 		for (auto childNode : spawnNode.children()) {
+			std::vector<SpawnDefinition::Creature>* creatures;
 			if (strcasecmp(childNode.name(), "monster") == 0) {
-				pugi::xml_attribute nameAttribute = childNode.attribute("name");
-				if (!nameAttribute) {
-					continue;
-				}
+				creatures = &definition.monsters;
+			} else if (strcasecmp(childNode.name(), "npc") == 0) {
+				creatures = &definition.npcs;
+			} else {
+				continue;
+			}
 
-				Direction dir;
+			pugi::xml_attribute nameAttribute = childNode.attribute("name");
+			if (!nameAttribute) {
+				continue;
+			}
 
-				pugi::xml_attribute directionAttribute = childNode.attribute("direction");
-				if (directionAttribute) {
-					dir = static_cast<Direction>(pugi::cast<uint16_t>(directionAttribute.value()));
-				} else {
-					dir = DIRECTION_NORTH;
-				}
+			SpawnDefinition::Creature creature;
+			creature.name = nameAttribute.as_string();
 
-				Position pos(
-					centerPos.x + pugi::cast<uint16_t>(childNode.attribute("x").value()),
-					centerPos.y + pugi::cast<uint16_t>(childNode.attribute("y").value()),
-					centerPos.z
-				);
-				uint32_t interval = pugi::cast<uint32_t>(childNode.attribute("spawntime").value()) * 1000;
-				if (interval > MINSPAWN_INTERVAL) {
-					spawn.addMonster(nameAttribute.as_string(), pos, dir, interval);
-				} else {
-					std::cout << "[Warning - Spawns::loadFromXml] " << nameAttribute.as_string() << ' ' << pos << " spawntime can not be less than " << MINSPAWN_INTERVAL / 1000 << " seconds." << std::endl;
-				}
-			} else if (strcasecmp(childNode.name(), "npc") == 0) {
-				pugi::xml_attribute nameAttribute = childNode.attribute("name");
-				if (!nameAttribute) {
-					continue;
-				}
+			pugi::xml_attribute directionAttribute = childNode.attribute("direction");
+			if (directionAttribute) {
+				creature.direction = static_cast<Direction>(pugi::cast<uint16_t>(directionAttribute.value()));
+			} else if (creatures == &definition.monsters) {
+				creature.direction = DIRECTION_NORTH;
+			} else {
+				creature.direction = DIRECTION_NONE;
+			}
 
-				Npc* npc = Npc::createNpc(nameAttribute.as_string());
-				if (!npc) {
-					continue;
-				}
+			creature.pos = Position(
+				centerPos.x + pugi::cast<uint16_t>(childNode.attribute("x").value()),
+				centerPos.y + pugi::cast<uint16_t>(childNode.attribute("y").value()),
+				centerPos.z
+			);
+			creature.interval = pugi::cast<uint32_t>(childNode.attribute("spawntime").value()) * 1000;
+			creatures->push_back(std::move(creature));
+		}
+	}
+	return true;
+}
 
-				pugi::xml_attribute directionAttribute = childNode.attribute("direction");
-				if (directionAttribute) {
-					npc->setDirection(static_cast<Direction>(pugi::cast<uint16_t>(directionAttribute.value())));
-				}
+bool Spawns::loadFromXml(const std::string& filename)
+{
+	if (loaded) {
+		return true;
+	}
+
+	std::vector<SpawnDefinition> definitions;
+	if (!parseXml(filename, definitions)) {
+		return false;
+	}
+	return load(filename, definitions);
+}
+
+bool Spawns::load(const std::string& filename, const std::vector<SpawnDefinition>& definitions)
+{
+	if (loaded) {
+		return true;
+	}
+
+	this->filename = filename;
+	loaded = true;
+
+	for (const SpawnDefinition& definition : definitions) {
+		spawnList.emplace_front(definition.centerPos, definition.radius);
+		Spawn& spawn = spawnList.front();
+
+		for (const SpawnDefinition::Creature& monster : definition.monsters) {
+			if (monster.interval > MINSPAWN_INTERVAL) {
+				spawn.addMonster(monster.name, monster.pos, monster.direction, monster.interval);
+			} else {
+				std::cout << "[Warning - Spawns::load] " << monster.name << ' ' << monster.pos << " spawntime can not be less than " << MINSPAWN_INTERVAL / 1000 << " seconds." << std::endl;
+			}
+		}
+
+		for (const SpawnDefinition::Creature& npcDefinition : definition.npcs) {
+			Npc* npc = Npc::createNpc(npcDefinition.name);
+			if (!npc) {
+				continue;
+			}
 
-				npc->setMasterPos(Position(
-					centerPos.x + pugi::cast<uint16_t>(childNode.attribute("x").value()),
-					centerPos.y + pugi::cast<uint16_t>(childNode.attribute("y").value()),
-					centerPos.z
-				), radius);
-				npcList.push_front(npc);
+			if (npcDefinition.direction != DIRECTION_NONE) {
+				npc->setDirection(npcDefinition.direction);
 			}
+			npc->setMasterPos(npcDefinition.pos, definition.radius);
+			npcList.push_front(npc);
 		}
 	}
 	return true;
@@ -144,9 +194,13 @@ void Spawns::startup()
 
 void Spawns::clear()
 {
-	for (Spawn& spawn : spawnList) {
-		spawn.stopEvent();
+	if (checkEvent != 0) {
+		g_scheduler.stopEvent(checkEvent);
+		checkEvent = 0;
 	}
+
+	respawnQueue = decltype(respawnQueue)();
+	cleanupQueue.clear();
 	spawnList.clear();
 
 	loaded = false;
@@ -164,34 +218,220 @@ bool Spawns::isInZone(const Position& centerPos, int32_t radius, const Position&
 	        (pos.getY() >= centerPos.getY() - radius) && (pos.getY() <= centerPos.getY() + radius));
 }
 
-void Spawn::startSpawnCheck()
+void Spawns::queueBlock(Spawn& spawn, uint32_t spawnId, int64_t due)
 {
-	if (checkSpawnEvent == 0) {
-		checkSpawnEvent = g_scheduler.addEvent(createSchedulerTask(getInterval(), std::bind(&Spawn::checkSpawn, this)));
+	spawnBlock_t& sb = spawn.spawnMap[spawnId];
+	if (sb.queued) {
+		return;
 	}
+
+	sb.queued = true;
+	respawnQueue.emplace(due, &spawn, spawnId);
+	scheduleCheck(due);
 }
 
-Spawn::~Spawn()
+void Spawns::queueCleanup(Spawn& spawn)
 {
-	for (const auto& it : spawnedMap) {
-		Monster* monster = it.second;
-		monster->setSpawn(nullptr);
-		monster->decrementReferenceCounter();
+	if (spawn.cleanupQueued) {
+		return;
 	}
+
+	spawn.cleanupQueued = true;
+	cleanupQueue.push_back(&spawn);
+	scheduleCheck(OTSYS_TIME());
 }
 
-bool Spawn::findPlayer(const Position& pos)
+void Spawns::scheduleCheck(int64_t due)
 {
-	SpectatorVec spectators;
-	g_game.map.getSpectators(spectators, pos, false, true);
-	for (Creature* spectator : spectators) {
-		if (!spectator->getPlayer()->hasFlag(PlayerFlag_IgnoredByMonsters)) {
-			return true;
+	if (checkEvent != 0) {
+		if (checkTime <= due) {
+			return;
+		}
+		g_scheduler.stopEvent(checkEvent);
+	}
+
+	// never sooner than SPAWN_BATCH_DELAY so deaths close together are handled by one run
+	int64_t delay = std::max<int64_t>(SPAWN_BATCH_DELAY, due - OTSYS_TIME());
+	checkTime = OTSYS_TIME() + delay;
+	checkEvent = g_scheduler.addEvent(createSchedulerTask(delay, std::bind(&Spawns::checkSpawns, this), "Spawns::checkSpawns"));
+}
+
+void Spawns::checkSpawns()
+{
+	checkEvent = 0;
+	++batchId;
+
+	std::vector<Spawn*> spawns;
+	spawns.swap(cleanupQueue);
+	for (Spawn* spawn : spawns) {
+		spawn->cleanupQueued = false;
+		spawn->batchId = batchId;
+		spawn->batchSpawns = 0;
+		spawn->cleanup();
+	}
+
+	int64_t now = OTSYS_TIME();
+	uint32_t spawnRate = static_cast<uint32_t>(g_config.getNumber(ConfigManager::RATE_SPAWN));
+	uint32_t spawnCount = 0;
+
+	std::vector<QueuedBlock> requeued;
+	while (!respawnQueue.empty() && respawnQueue.top().due <= now && spawnCount < SPAWN_BATCH_SIZE) {
+		QueuedBlock block = respawnQueue.top();
+		respawnQueue.pop();
+
+		Spawn& spawn = *block.spawn;
+		if (spawn.batchId != batchId) {
+			// monsters that left the spawn zone free their block
+			spawn.batchId = batchId;
+			spawn.batchSpawns = 0;
+			spawn.cleanup();
+		}
+
+		spawnBlock_t& sb = spawn.spawnMap[block.spawnId];
+		sb.queued = false;
+
+		if (spawn.spawnedMap.find(block.spawnId) != spawn.spawnedMap.end()) {
+			continue;
+		}
+
+		if (now < sb.lastSpawn + sb.interval) {
+			requeued.emplace_back(sb.lastSpawn + sb.interval, &spawn, block.spawnId);
+			continue;
+		}
+
+		// rateSpawn is per check of a spawn, the rest waits for its next one
+		if (spawn.batchSpawns >= spawnRate) {
+			requeued.emplace_back(now + spawn.getInterval(), &spawn, block.spawnId);
+			continue;
+		}
+
+		if (isPlayerNearby(sb.pos)) {
+			sb.lastSpawn = now;
+			requeued.emplace_back(now + sb.interval, &spawn, block.spawnId);
+			continue;
+		}
+
+		++spawn.batchSpawns;
+		++spawnCount;
+		if (!spawn.spawnMonster(block.spawnId, sb.mType, sb.pos, sb.direction)) {
+			requeued.emplace_back(now + spawn.getInterval(), &spawn, block.spawnId);
+		}
+	}
+
+	for (const QueuedBlock& block : requeued) {
+		queueBlock(*block.spawn, block.spawnId, block.due);
+	}
+
+	if (!respawnQueue.empty()) {
+		scheduleCheck(respawnQueue.top().due);
+	}
+}
+
+void Spawns::addPlayer(const Player* player)
+{
+	uint64_t regionKey = getRegionKey(player->getPosition());
+	if (playerRegionKeys.emplace(player, regionKey).second) {
+		playerRegions[regionKey].push_back(player);
+	}
+}
+
+void Spawns::removePlayer(const Player* player)
+{
+	auto it = playerRegionKeys.find(player);
+	if (it == playerRegionKeys.end()) {
+		return;
+	}
+
+	removeRegionPlayer(player, it->second);
+	playerRegionKeys.erase(it);
+}
+
+void Spawns::movePlayer(const Player* player)
+{
+	auto it = playerRegionKeys.find(player);
+	if (it == playerRegionKeys.end()) {
+		return;
+	}
+
+	uint64_t regionKey = getRegionKey(player->getPosition());
+	if (regionKey == it->second) {
+		return;
+	}
+
+	removeRegionPlayer(player, it->second);
+	it->second = regionKey;
+	playerRegions[regionKey].push_back(player);
+}
+
+void Spawns::removeRegionPlayer(const Player* player, uint64_t regionKey)
+{
+	auto it = playerRegions.find(regionKey);
+	if (it == playerRegions.end()) {
+		return;
+	}
+
+	std::vector<const Player*>& regionPlayers = it->second;
+	auto playerIt = std::find(regionPlayers.begin(), regionPlayers.end(), player);
+	if (playerIt != regionPlayers.end()) {
+		*playerIt = regionPlayers.back();
+		regionPlayers.pop_back();
+	}
+
+	if (regionPlayers.empty()) {
+		playerRegions.erase(it);
+	}
+}
+
+bool Spawns::isPlayerNearby(const Position& pos) const
+{
+	// the area Map::getSpectators covers on a single floor
+	int32_t minX = std::max<int32_t>(0, pos.x - Map::maxViewportX);
+	int32_t maxX = pos.x + Map::maxViewportX;
+	int32_t minY = std::max<int32_t>(0, pos.y - Map::maxViewportY);
+	int32_t maxY = pos.y + Map::maxViewportY;
+
+	for (int32_t regionY = minY / SPAWN_REGION_SIZE; regionY <= maxY / SPAWN_REGION_SIZE; ++regionY) {
+		for (int32_t regionX = minX / SPAWN_REGION_SIZE; regionX <= maxX / SPAWN_REGION_SIZE; ++regionX) {
+			auto it = playerRegions.find(getRegionKey(regionX, regionY, pos.z));
+			if (it == playerRegions.end()) {
+				continue;
+			}
+
+			for (const Player* player : it->second) {
+				// the flag can change while the player is online
+				if (player->hasFlag(PlayerFlag_IgnoredByMonsters)) {
+					continue;
+				}
+
+				const Position& playerPos = player->getPosition();
+				if (playerPos.x >= minX && playerPos.x <= maxX && playerPos.y >= minY && playerPos.y <= maxY) {
+					return true;
+				}
+			}
 		}
 	}
 	return false;
 }
 
+void Spawn::startSpawnCheck()
+{
+	g_game.map.spawns.queueCleanup(*this);
+}
+
+void Spawn::queueBlock(uint32_t spawnId, int64_t due)
+{
+	g_game.map.spawns.queueBlock(*this, spawnId, due);
+}
+
+Spawn::~Spawn()
+{
+	for (const auto& it : spawnedMap) {
+		Monster* monster = it.second;
+		monster->setSpawn(nullptr);
+		monster->decrementReferenceCounter();
+	}
+}
+
 bool Spawn::isInSpawnZone(const Position& pos)
 {
 	return Spawns::isInZone(centerPos, radius, pos);
@@ -231,41 +471,10 @@ void Spawn::startup()
 	for (const auto& it : spawnMap) {
 		uint32_t spawnId = it.first;
 		const spawnBlock_t& sb = it.second;
-		spawnMonster(spawnId, sb.mType, sb.pos, sb.direction, true);
-	}
-}
-
-void Spawn::checkSpawn()
-{
-	checkSpawnEvent = 0;
-
-	cleanup();
-
-	uint32_t spawnCount = 0;
-
-	for (auto& it : spawnMap) {
-		uint32_t spawnId = it.first;
-		if (spawnedMap.find(spawnId) != spawnedMap.end()) {
-			continue;
-		}
-
-		spawnBlock_t& sb = it.second;
-		if (OTSYS_TIME() >= sb.lastSpawn + sb.interval) {
-			if (findPlayer(sb.pos)) {
-				sb.lastSpawn = OTSYS_TIME();
-				continue;
-			}
-
-			spawnMonster(spawnId, sb.mType, sb.pos, sb.direction);
-			if (++spawnCount >= static_cast<uint32_t>(g_config.getNumber(ConfigManager::RATE_SPAWN))) {
-				break;
-			}
+		if (!spawnMonster(spawnId, sb.mType, sb.pos, sb.direction, true)) {
+			queueBlock(spawnId, OTSYS_TIME() + sb.interval);
 		}
 	}
-
-	if (spawnedMap.size() < spawnMap.size()) {
-		checkSpawnEvent = g_scheduler.addEvent(createSchedulerTask(getInterval(), std::bind(&Spawn::checkSpawn, this)));
-	}
 }
 
 void Spawn::cleanup()
@@ -276,7 +485,9 @@ void Spawn::cleanup()
 		Monster* monster = it->second;
 		if (monster->isRemoved()) {
 			if (spawnId != 0) {
-				spawnMap[spawnId].lastSpawn = OTSYS_TIME();
+				spawnBlock_t& sb = spawnMap[spawnId];
+				sb.lastSpawn = OTSYS_TIME();
+				queueBlock(spawnId, sb.lastSpawn + sb.interval);
 			}
 
 			monster->decrementReferenceCounter();
@@ -284,6 +495,9 @@ void Spawn::cleanup()
 		} else if (!isInSpawnZone(monster->getPosition()) && spawnId != 0) {
 			spawnedMap.insert(spawned_pair(0, monster));
 			it = spawnedMap.erase(it);
+
+			const spawnBlock_t& sb = spawnMap[spawnId];
+			queueBlock(spawnId, sb.lastSpawn + sb.interval);
 		} else {
 			++it;
 		}
@@ -306,6 +520,7 @@ bool Spawn::addMonster(const std::string& name, const Position& pos, Direction d
 	sb.direction = dir;
 	sb.interval = interval;
 	sb.lastSpawn = 0;
+	sb.queued = false;
 
 	uint32_t spawnId = spawnMap.size() + 1;
 	spawnMap[spawnId] = sb;
@@ -316,17 +531,15 @@ void Spawn::removeMonster(Monster* monster)
 {
 	for (auto it = spawnedMap.begin(), end = spawnedMap.end(); it != end; ++it) {
 		if (it->second == monster) {
+			uint32_t spawnId = it->first;
 			monster->decrementReferenceCounter();
 			spawnedMap.erase(it);
+
+			if (spawnId != 0) {
+				const spawnBlock_t& sb = spawnMap[spawnId];
+				queueBlock(spawnId, sb.lastSpawn + sb.interval);
+			}
 			break;
 		}
 	}
 }
-
-void Spawn::stopEvent()
-{
-	if (checkSpawnEvent != 0) {
-		g_scheduler.stopEvent(checkSpawnEvent);
-		checkSpawnEvent = 0;
-	}
-}
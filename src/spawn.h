@@ -23,6 +23,8 @@
 #include "tile.h"
 #include "position.h"
 
+#include <queue>
+
 class Monster;
 class MonsterType;
 class Npc;
@@ -33,6 +35,22 @@ struct spawnBlock_t {
 	int64_t lastSpawn;
 	uint32_t interval;
 	Direction direction;
+	bool queued; // waiting in the respawn queue of Spawns
+};
+
+// what a spawn file describes, before any monster type is looked up
+struct SpawnDefinition {
+	struct Creature {
+		std::string name;
+		Position pos;
+		Direction direction; // DIRECTION_NONE keeps the npc's own direction
+		uint32_t interval; // milliseconds, npcs have none
+	};
+
+	Position centerPos;
+	int32_t radius;
+	std::vector<Creature> monsters;
+	std::vector<Creature> npcs;
 };
 
 class Spawn
@@ -53,8 +71,9 @@ class Spawn
 		}
 		void startup();
 
+		// a monster of this spawn disappeared, Spawns looks for free blocks
+		// with its next batch
 		void startSpawnCheck();
-		void stopEvent();
 
 		bool isInSpawnZone(const Position& pos);
 		void cleanup();
@@ -72,19 +91,33 @@ class Spawn
 		int32_t radius;
 
 		uint32_t interval = 60000;
-		uint32_t checkSpawnEvent = 0;
 
-		static bool findPlayer(const Position& pos);
+		// rateSpawn accounting of the current batch
+		uint32_t batchId = 0;
+		uint32_t batchSpawns = 0;
+		bool cleanupQueued = false;
+
+		void queueBlock(uint32_t spawnId, int64_t due);
 		bool spawnMonster(uint32_t spawnId, MonsterType* mType, const Position& pos, Direction dir, bool startup = false);
-		void checkSpawn();
+
+		friend class Spawns;
 };
 
+// Owns the spawns of the map and respawns their monsters. Free spawn blocks
+// wait in a queue ordered by the time they are due, a single scheduler event
+// is armed for the earliest one and spawns at most SPAWN_BATCH_SIZE monsters
+// per run. Whether a player blocks a respawn is looked up in an index of the
+// players by map region that is kept up to date as players log in, move and
+// log out.
 class Spawns
 {
 	public:
 		static bool isInZone(const Position& centerPos, int32_t radius, const Position& pos);
 
+		static bool parseXml(const std::string& filename, std::vector<SpawnDefinition>& definitions);
+
 		bool loadFromXml(const std::string& filename);
+		bool load(const std::string& filename, const std::vector<SpawnDefinition>& definitions);
 		void startup();
 		void clear();
 
@@ -92,12 +125,50 @@ class Spawns
 			return started;
 		}
 
+		// called by Game::addPlayer, Game::removePlayer and Map::moveCreature
+		void addPlayer(const Player* player);
+		void removePlayer(const Player* player);
+		void movePlayer(const Player* player);
+
 	private:
+		struct QueuedBlock {
+			QueuedBlock(int64_t due, Spawn* spawn, uint32_t spawnId) : due(due), spawn(spawn), spawnId(spawnId) {}
+
+			bool operator>(const QueuedBlock& other) const {
+				return due > other.due;
+			}
+
+			int64_t due;
+			Spawn* spawn;
+			uint32_t spawnId;
+		};
+
+		void queueBlock(Spawn& spawn, uint32_t spawnId, int64_t due);
+		void queueCleanup(Spawn& spawn);
+		void scheduleCheck(int64_t due);
+		void checkSpawns();
+
+		void removeRegionPlayer(const Player* player, uint64_t regionKey);
+		bool isPlayerNearby(const Position& pos) const;
+
+		std::priority_queue<QueuedBlock, std::vector<QueuedBlock>, std::greater<QueuedBlock>> respawnQueue;
+		std::vector<Spawn*> cleanupQueue;
+
+		// online players by (x / SPAWN_REGION_SIZE, y / SPAWN_REGION_SIZE, z)
+		// and the region each of them is in
+		std::unordered_map<uint64_t, std::vector<const Player*>> playerRegions;
+		std::unordered_map<const Player*, uint64_t> playerRegionKeys;
+
 		std::forward_list<Npc*> npcList;
 		std::forward_list<Spawn> spawnList;
 		std::string filename;
+		int64_t checkTime = 0;
+		uint32_t checkEvent = 0;
+		uint32_t batchId = 0;
 		bool loaded = false;
 		bool started = false;
+
+		friend class Spawn;
 };
 
 #endif
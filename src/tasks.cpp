@@ -21,17 +21,18 @@
 
 #include "tasks.h"
 #include "game.h"
+#include "dispatchertrace.h"
 
 extern Game g_game;
 
-Task* createTask(std::function<void (void)> f)
+Task* createTask(std::function<void (void)> f, const char* origin /*= nullptr*/)
 {
-	return new Task(std::move(f));
+	return new Task(std::move(f), origin);
 }
 
-Task* createTask(uint32_t expiration, std::function<void (void)> f)
+Task* createTask(uint32_t expiration, std::function<void (void)> f, const char* origin /*= nullptr*/)
 {
-	return new Task(expiration, std::move(f));
+	return new Task(expiration, std::move(f), origin);
 }
 
 void Dispatcher::threadMain()
@@ -57,7 +58,13 @@ void Dispatcher::threadMain()
 			if (!task->hasExpired()) {
 				++dispatcherCycle;
 				// execute it
-				(*task)();
+				if (g_dispatcherTrace.isEnabled()) {
+					auto startTime = std::chrono::steady_clock::now();
+					(*task)();
+					g_dispatcherTrace.record(*task, startTime, std::chrono::steady_clock::now());
+				} else {
+					(*task)();
+				}
 			}
 			delete task;
 		} else {
@@ -75,6 +82,10 @@ void Dispatcher::addTask(Task* task, bool push_front /*= false*/)
 	if (getState() == THREAD_STATE_RUNNING) {
 		do_signal = taskList.empty();
 
+		if (g_dispatcherTrace.isEnabled()) {
+			task->setQueuedTime(std::chrono::steady_clock::now());
+		}
+
 		if (push_front) {
 			taskList.push_front(task);
 		} else {
@@ -31,9 +31,9 @@ class Task
 {
 	public:
 		// DO NOT allocate this class on the stack
-		explicit Task(std::function<void (void)>&& f) : func(std::move(f)) {}
-		Task(uint32_t ms, std::function<void (void)>&& f) :
-			expiration(std::chrono::system_clock::now() + std::chrono::milliseconds(ms)), func(std::move(f)) {}
+		explicit Task(std::function<void (void)>&& f, const char* origin = nullptr) : func(std::move(f)), origin(origin) {}
+		Task(uint32_t ms, std::function<void (void)>&& f, const char* origin = nullptr) :
+			expiration(std::chrono::system_clock::now() + std::chrono::milliseconds(ms)), func(std::move(f)), origin(origin) {}
 
 		virtual ~Task() = default;
 		void operator()() {
@@ -51,6 +51,18 @@ class Task
 			return expiration < std::chrono::system_clock::now();
 		}
 
+		// static string naming what created the task, used by DispatcherTrace
+		const char* getOrigin() const {
+			return origin;
+		}
+
+		void setQueuedTime(std::chrono::steady_clock::time_point queuedTime) {
+			this->queuedTime = queuedTime;
+		}
+		std::chrono::steady_clock::time_point getQueuedTime() const {
+			return queuedTime;
+		}
+
 	protected:
 		std::chrono::system_clock::time_point expiration = SYSTEM_TIME_ZERO;
 
@@ -59,10 +71,13 @@ class Task
 		// then it is the time the task should be added to the
 		// dispatcher
 		std::function<void (void)> func;
+
+		const char* origin;
+		std::chrono::steady_clock::time_point queuedTime;
 };
 
-Task* createTask(std::function<void (void)> f);
-Task* createTask(uint32_t expiration, std::function<void (void)> f);
+Task* createTask(std::function<void (void)> f, const char* origin = nullptr);
+Task* createTask(uint32_t expiration, std::function<void (void)> f, const char* origin = nullptr);
 
 class Dispatcher : public ThreadHolder<Dispatcher> {
 	public:
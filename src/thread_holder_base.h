@@ -43,6 +43,11 @@ class ThreadHolder
 				thread.join();
 			}
 		}
+
+		// std::thread::id() before start and after join
+		std::thread::id getThreadId() const {
+			return thread.get_id();
+		}
 	protected:
 		void setState(ThreadState newState) {
 			threadState.store(newState, std::memory_order_relaxed);
@@ -40,6 +40,12 @@ extern ConfigManager g_config;
 StaticTile real_nullptr_tile(0xFFFF, 0xFFFF, 0xFF);
 Tile& Tile::nullptr_tile = real_nullptr_tile;
 
+Tile::~Tile()
+{
+	delete ground;
+	LuaScriptInterface::invalidateUserdata(this);
+}
+
 bool Tile::hasProperty(ITEMPROPERTY prop) const
 {
 	if (ground && ground->hasProperty(prop)) {
@@ -620,17 +626,13 @@ ReturnValue Tile::queryAdd(int32_t, const Thing& thing, uint32_t, uint32_t flags
 			}
 		} else {
 			//FLAG_IGNOREBLOCKITEM is set
-			if (ground) {
-				const ItemType& iiType = Item::items[ground->getID()];
-				if (iiType.blockSolid && (!iiType.moveable || ground->hasAttribute(ITEM_ATTRIBUTE_UNIQUEID))) {
-					return RETURNVALUE_NOTPOSSIBLE;
-				}
+			if (ground && ground->hasProperty(CONST_PROP_IMMOVABLEBLOCKSOLID)) {
+				return RETURNVALUE_NOTPOSSIBLE;
 			}
 
 			if (const auto items = getItemList()) {
 				for (const Item* item : *items) {
-					const ItemType& iiType = Item::items[item->getID()];
-					if (iiType.blockSolid && (!iiType.moveable || item->hasAttribute(ITEM_ATTRIBUTE_UNIQUEID))) {
+					if (item->hasProperty(CONST_PROP_IMMOVABLEBLOCKSOLID)) {
 						return RETURNVALUE_NOTPOSSIBLE;
 					}
 				}
@@ -669,15 +671,20 @@ ReturnValue Tile::queryAdd(int32_t, const Thing& thing, uint32_t, uint32_t flags
 				}
 			}
 		} else {
+			// the flags of the added item are looked up once for the whole stack
+			const uint32_t itemFlags = Item::items.getFlags(item->getID());
+			const bool itemCanStack = !hasBitSet(ITEMTYPEFLAG_MAGICFIELD, itemFlags) && !hasBitSet(ITEMTYPEFLAG_BLOCKSOLID, itemFlags);
+			const bool itemIsPickupable = hasBitSet(ITEMTYPEFLAG_PICKUPABLE, itemFlags);
+
 			if (ground) {
-				const ItemType& iiType = Item::items[ground->getID()];
-				if (iiType.blockSolid) {
-					if (!iiType.allowPickupable || item->isMagicField() || item->isBlocking()) {
-						if (!item->isPickupable()) {
+				const uint32_t groundFlags = Item::items.getFlags(ground->getID());
+				if (hasBitSet(ITEMTYPEFLAG_BLOCKSOLID, groundFlags)) {
+					if (!hasBitSet(ITEMTYPEFLAG_ALLOWPICKUPABLE, groundFlags) || !itemCanStack) {
+						if (!itemIsPickupable) {
 							return RETURNVALUE_NOTENOUGHROOM;
 						}
 
-						if (!iiType.hasHeight || iiType.pickupable || iiType.isBed()) {
+						if (!hasBitSet(ITEMTYPEFLAG_HASHEIGHT, groundFlags) || (groundFlags & (ITEMTYPEFLAG_PICKUPABLE | ITEMTYPEFLAG_BED)) != 0) {
 							return RETURNVALUE_NOTENOUGHROOM;
 						}
 					}
@@ -686,20 +693,20 @@ ReturnValue Tile::queryAdd(int32_t, const Thing& thing, uint32_t, uint32_t flags
 
 			if (items) {
 				for (const Item* tileItem : *items) {
-					const ItemType& iiType = Item::items[tileItem->getID()];
-					if (!iiType.blockSolid) {
+					const uint32_t tileItemFlags = Item::items.getFlags(tileItem->getID());
+					if (!hasBitSet(ITEMTYPEFLAG_BLOCKSOLID, tileItemFlags)) {
 						continue;
 					}
 
-					if (iiType.allowPickupable && !item->isMagicField() && !item->isBlocking()) {
+					if (hasBitSet(ITEMTYPEFLAG_ALLOWPICKUPABLE, tileItemFlags) && itemCanStack) {
 						continue;
 					}
 
-					if (!item->isPickupable()) {
+					if (!itemIsPickupable) {
 						return RETURNVALUE_NOTENOUGHROOM;
 					}
 
-					if (!iiType.hasHeight || iiType.pickupable || iiType.isBed()) {
+					if (!hasBitSet(ITEMTYPEFLAG_HASHEIGHT, tileItemFlags) || (tileItemFlags & (ITEMTYPEFLAG_PICKUPABLE | ITEMTYPEFLAG_BED)) != 0) {
 						return RETURNVALUE_NOTENOUGHROOM;
 					}
 				}
@@ -1505,10 +1512,12 @@ void Tile::internalAddThing(uint32_t, Thing* thing)
 
 void Tile::setTileFlags(const Item* item)
 {
+	const uint32_t oldFlags = flags;
+
 	if (!hasFlag(TILESTATE_FLOORCHANGE)) {
-		const ItemType& it = Item::items[item->getID()];
-		if (it.floorChange != 0) {
-			setFlag(it.floorChange);
+		uint8_t floorChange = Item::items.getFloorChange(item->getID());
+		if (floorChange != 0) {
+			setFlag(floorChange);
 		}
 	}
 
@@ -1560,10 +1569,20 @@ void Tile::setTileFlags(const Item* item)
 	if (item->hasProperty(CONST_PROP_SUPPORTHANGABLE)) {
 		setFlag(TILESTATE_SUPPORTS_HANGABLE);
 	}
+
+	if (item->hasProperty(CONST_PROP_BLOCKPROJECTILE)) {
+		setFlag(TILESTATE_BLOCKPROJECTILE);
+	}
+
+	if (flags != oldFlags) {
+		g_game.map.refreshTileFlags(*this);
+	}
 }
 
 void Tile::resetTileFlags(const Item* item)
 {
+	const uint32_t oldFlags = flags;
+
 	const ItemType& it = Item::items[item->getID()];
 	if (it.floorChange != 0) {
 		resetFlag(TILESTATE_FLOORCHANGE);
@@ -1621,6 +1640,14 @@ void Tile::resetTileFlags(const Item* item)
 	if (item->hasProperty(CONST_PROP_SUPPORTHANGABLE)) {
 		resetFlag(TILESTATE_SUPPORTS_HANGABLE);
 	}
+
+	if (item->hasProperty(CONST_PROP_BLOCKPROJECTILE) && !hasProperty(item, CONST_PROP_BLOCKPROJECTILE)) {
+		resetFlag(TILESTATE_BLOCKPROJECTILE);
+	}
+
+	if (flags != oldFlags) {
+		g_game.map.refreshTileFlags(*this);
+	}
 }
 
 bool Tile::isMoveableBlocking() const
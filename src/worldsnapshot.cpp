@@ -0,0 +1,204 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "otpch.h"
+
+#include "worldsnapshot.h"
+
+#include <fstream>
+#include <zlib.h>
+
+namespace {
+
+constexpr char SNAPSHOT_MAGIC[4] = {'T', 'F', 'S', 'W'};
+
+// bump whenever the payload layout or the item attribute serialization changes
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+// magic, version and checksum
+constexpr size_t HEADER_SIZE = sizeof(SNAPSHOT_MAGIC) + sizeof(uint32_t) + sizeof(uint32_t);
+
+uint32_t updateChecksum(uint32_t checksum, const char* data, size_t size)
+{
+	// zlib takes the length as uInt
+	while (size > 0) {
+		uInt chunk = static_cast<uInt>(std::min<size_t>(size, 1 << 30));
+		checksum = crc32(checksum, reinterpret_cast<const Bytef*>(data), chunk);
+		data += chunk;
+		size -= chunk;
+	}
+	return checksum;
+}
+
+}
+
+bool WorldSnapshot::open()
+{
+	try {
+		file.open(fileName);
+	} catch (const std::exception&) {
+		errorString = "No snapshot found.";
+		return false;
+	}
+
+	if (file.size() < HEADER_SIZE || !std::equal(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + sizeof(SNAPSHOT_MAGIC), file.data())) {
+		errorString = "Not a world snapshot.";
+		return false;
+	}
+
+	PropStream header;
+	header.init(file.data() + sizeof(SNAPSHOT_MAGIC), HEADER_SIZE - sizeof(SNAPSHOT_MAGIC));
+
+	uint32_t version;
+	uint32_t checksum;
+	if (!header.read<uint32_t>(version) || !header.read<uint32_t>(checksum)) {
+		errorString = "Not a world snapshot.";
+		return false;
+	}
+
+	if (version != SNAPSHOT_VERSION) {
+		errorString = "The snapshot was written by another server version.";
+		return false;
+	}
+
+	const char* body = file.data() + HEADER_SIZE;
+	size_t bodySize = file.size() - HEADER_SIZE;
+	if (updateChecksum(crc32(0, Z_NULL, 0), body, bodySize) != checksum) {
+		errorString = "The snapshot is damaged.";
+		return false;
+	}
+
+	payload.init(body, bodySize);
+
+	uint32_t sourceCount;
+	if (!payload.read<uint32_t>(sourceCount)) {
+		errorString = "The snapshot is damaged.";
+		return false;
+	}
+
+	std::vector<Source> storedSources;
+	for (uint32_t i = 0; i < sourceCount; ++i) {
+		Source stored;
+		if (!payload.readString(stored.fileName) || !payload.read<uint64_t>(stored.size) || !payload.read<uint32_t>(stored.checksum)) {
+			errorString = "The snapshot is damaged.";
+			return false;
+		}
+
+		Source current;
+		if (!readSource(stored.fileName, current) || current.size != stored.size || current.checksum != stored.checksum) {
+			errorString = stored.fileName + " changed since the snapshot was written.";
+			return false;
+		}
+		storedSources.push_back(std::move(stored));
+	}
+
+	sources = std::move(storedSources);
+	return true;
+}
+
+bool WorldSnapshot::hasSource(const std::string& sourceName) const
+{
+	for (const Source& source : sources) {
+		if (source.fileName == sourceName) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool WorldSnapshot::addSource(const std::string& sourceName)
+{
+	Source source;
+	if (!readSource(sourceName, source)) {
+		errorString = "Could not read " + sourceName + '.';
+		return false;
+	}
+
+	sources.push_back(std::move(source));
+	return true;
+}
+
+bool WorldSnapshot::save(const PropWriteStream& payloadStream)
+{
+	PropWriteStream sourceStream;
+	sourceStream.write<uint32_t>(sources.size());
+	for (const Source& source : sources) {
+		sourceStream.writeString(source.fileName);
+		sourceStream.write<uint64_t>(source.size);
+		sourceStream.write<uint32_t>(source.checksum);
+	}
+
+	size_t sourcesSize;
+	const char* sourceData = sourceStream.getStream(sourcesSize);
+
+	size_t payloadSize;
+	const char* payloadData = payloadStream.getStream(payloadSize);
+
+	uint32_t checksum = updateChecksum(crc32(0, Z_NULL, 0), sourceData, sourcesSize);
+	checksum = updateChecksum(checksum, payloadData, payloadSize);
+
+	// written next to the old snapshot and renamed, a crash while saving
+	// leaves either the old or the new one behind
+	std::string tmpName = fileName + ".tmp";
+	{
+		std::ofstream out(tmpName, std::ios::binary | std::ios::trunc);
+		if (!out.is_open()) {
+			errorString = "Could not write " + tmpName + '.';
+			return false;
+		}
+
+		out.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+		out.write(reinterpret_cast<const char*>(&SNAPSHOT_VERSION), sizeof(SNAPSHOT_VERSION));
+		out.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+		out.write(sourceData, sourcesSize);
+		out.write(payloadData, payloadSize);
+		if (!out.good()) {
+			errorString = "Could not write " + tmpName + '.';
+			std::remove(tmpName.c_str());
+			return false;
+		}
+	}
+
+	if (file.is_open()) {
+		file.close();
+	}
+
+	// rename does not replace an existing file on Windows
+	if (std::rename(tmpName.c_str(), fileName.c_str()) != 0 && (std::remove(fileName.c_str()) != 0 || std::rename(tmpName.c_str(), fileName.c_str()) != 0)) {
+		errorString = "Could not replace " + fileName + '.';
+		std::remove(tmpName.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool WorldSnapshot::readSource(const std::string& sourceName, Source& source)
+{
+	boost::iostreams::mapped_file_source sourceFile;
+	try {
+		sourceFile.open(sourceName);
+	} catch (const std::exception&) {
+		return false;
+	}
+
+	source.fileName = sourceName;
+	source.size = sourceFile.size();
+	source.checksum = updateChecksum(crc32(0, Z_NULL, 0), sourceFile.data(), sourceFile.size());
+	return true;
+}
@@ -0,0 +1,74 @@
+/**
+ * The Forgotten Server - a free and open-source MMORPG server emulator
+ * Copyright (C) 2019  Mark Samman <mark.samman@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef FS_WORLDSNAPSHOT_H_3C7A9E21F5B04D8E96A1D4F0B2E87C53
+#define FS_WORLDSNAPSHOT_H_3C7A9E21F5B04D8E96A1D4F0B2E87C53
+
+#include "fileloader.h"
+
+// Container of a cached startup payload. The header holds the size and
+// CRC-32 of every source file the payload was built from and a checksum of
+// the rest of the file, open() refuses the snapshot as soon as one of them
+// does not match. The payload is read straight from the mapped file.
+class WorldSnapshot
+{
+	public:
+		explicit WorldSnapshot(std::string fileName) : fileName(std::move(fileName)) {}
+
+		// non-copyable
+		WorldSnapshot(const WorldSnapshot&) = delete;
+		WorldSnapshot& operator=(const WorldSnapshot&) = delete;
+
+		// false if there is no usable snapshot, getLastErrorString() says why
+		bool open();
+		PropStream& getPayload() {
+			return payload;
+		}
+
+		// true if the snapshot was built from that file
+		bool hasSource(const std::string& sourceName) const;
+
+		bool addSource(const std::string& sourceName);
+		bool save(const PropWriteStream& payloadStream);
+
+		const std::string& getFileName() const {
+			return fileName;
+		}
+		const std::string& getLastErrorString() const {
+			return errorString;
+		}
+
+	private:
+		struct Source {
+			std::string fileName;
+			uint64_t size;
+			uint32_t checksum;
+		};
+
+		static bool readSource(const std::string& sourceName, Source& source);
+
+		boost::iostreams::mapped_file_source file;
+		std::vector<Source> sources;
+		PropStream payload;
+
+		std::string fileName;
+		std::string errorString;
+};
+
+#endif